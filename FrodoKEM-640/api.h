@@ -7,6 +7,8 @@
 #ifndef _API_Frodo640_H_
 #define _API_Frodo640_H_
 
+#include <stddef.h>
+
 
 #define CRYPTO_SECRETKEYBYTES  19888     // sizeof(s) + CRYPTO_PUBLICKEYBYTES + 2*PARAMS_N*PARAMS_NBAR + BYTES_PKHASH
 #define CRYPTO_PUBLICKEYBYTES   9616     // sizeof(seed_A) + (PARAMS_LOGQ*PARAMS_N*PARAMS_NBAR)/8
@@ -21,6 +23,17 @@ int crypto_kem_keypair(unsigned char *pk, unsigned char *sk);
 int crypto_kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk);
 int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk);
 
+// The same with the large temporaries in a caller-owned arena of crypto_kem_scratch_bytes() bytes
+size_t crypto_kem_scratch_bytes(void);
+int crypto_kem_keypair_with_scratch(unsigned char *pk, unsigned char *sk, void *scratch);
+int crypto_kem_enc_with_scratch(unsigned char *ct, unsigned char *ss, const unsigned char *pk, void *scratch);
+int crypto_kem_dec_with_scratch(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, void *scratch);
+
+// n instances stored back to back, four at a time with their SHAKE128 calls through shake128x4
+int crypto_kem_keypair_batch(unsigned char *pk, unsigned char *sk, size_t n);
+int crypto_kem_enc_batch(unsigned char *ct, unsigned char *ss, const unsigned char *pk, size_t n);
+int crypto_kem_dec_batch(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, size_t n);
+
 
 #endif
 
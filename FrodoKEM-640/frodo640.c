@@ -23,6 +23,11 @@
 
 // Selecting SHAKE XOF function for the KEM and noise sampling
 #define shake     shake128
+#define shake_inc_init      shake128_inc_init
+#define shake_inc_absorb    shake128_inc_absorb
+#define shake_inc_finalize  shake128_inc_finalize
+#define shake_inc_squeeze   shake128_inc_squeeze
+#define shakex4             shake128x4
 
 // CDF table
 uint16_t CDF_TABLE[13] = {4643, 13363, 20579, 25843, 29227, 31145, 32103, 32525, 32689, 32745, 32762, 32766, 32767};
@@ -5,117 +5,272 @@
 *********************************************************************************************/
 
 #if defined(USE_AES128_FOR_A)
-    #include "aes/aes.h"
+    #include "aes.h"
 #elif defined (USE_SHAKE128_FOR_A)
-    #include "sha3/fips202.h"
+    #include "fips202x4.h"
 #endif    
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#endif
+#if defined(FRODO_THREADS) && FRODO_THREADS > 1
+    #include <pthread.h>
+    #include "threads/pool.h"
+#endif
 
 
-int frodo_mul_add_as_plus_e(uint16_t *out, const uint16_t *s, const uint16_t *e, const uint8_t *seed_A) 
-{ // Generate-and-multiply: generate matrix A (N x N) row-wise, multiply by s on the right.
-  // Inputs: s, e (N x N_BAR)
-  // Output: out = A*s + e (N x N_BAR)
-    int i, j, k;
-    int16_t A[PARAMS_N * PARAMS_N] = {0};       
-       
-#if defined(USE_AES128_FOR_A)    // Matrix A generation using AES128, done per 128-bit block                                          
-    size_t A_len = PARAMS_N * PARAMS_N * sizeof(int16_t);    
-    for (i = 0; i < PARAMS_N; i++) {                        
+// Matrix A is never stored whole: it is generated PARAMS_PARALLEL rows at a time
+// into a small buffer that is multiplied right away, so only a few KB are live.
+
+typedef struct {
+#if defined(USE_AES128_FOR_A)
+    aes_ctx aes_key_schedule;                           // AES-NI if the CPU has it, else bitsliced
+    uint16_t a_in[PARAMS_PARALLEL * PARAMS_N];          // Plaintext blocks (i, j, 0, ..., 0)
+#elif defined(USE_SHAKE128_FOR_A)
+    uint8_t seed_A_separated[PARAMS_PARALLEL][2 + BYTES_SEED_A];    // One (i, seed_A) input per row in the block
+#endif
+} frodo_a_state;
+
+
+static void frodo_a_init(frodo_a_state *st, const uint8_t *seed_A)
+{ // Expand seed_A once for all the rows of A
+#if defined(USE_AES128_FOR_A)
+    int i, j;
+
+    memset(st->a_in, 0, sizeof(st->a_in));
+    for (i = 0; i < PARAMS_PARALLEL; i++) {
         for (j = 0; j < PARAMS_N; j += PARAMS_STRIPE_STEP) {
-            A[i*PARAMS_N + j] = i;                              // Loading values in the little-endian order
-            A[i*PARAMS_N + j + 1] = j;                                  
+            st->a_in[i*PARAMS_N + j + 1] = j;                   // Loading values in the little-endian order
         }
     }
-    
-#if !defined(USE_OPENSSL)
-    uint8_t aes_key_schedule[16*11];
-    AES128_load_schedule(seed_A, aes_key_schedule);  
-    AES128_ECB_enc_sch((uint8_t*)A, A_len, aes_key_schedule, (uint8_t*)A);
-#else
-    EVP_CIPHER_CTX *aes_key_schedule;    
-    int len;
-    if (!(aes_key_schedule = EVP_CIPHER_CTX_new())) handleErrors();    
-    if (1 != EVP_EncryptInit_ex(aes_key_schedule, EVP_aes_128_ecb(), NULL, seed_A, NULL)) handleErrors();    
-    if (1 != EVP_EncryptUpdate(aes_key_schedule, (uint8_t*)A, &len, (uint8_t*)A, A_len)) handleErrors();
-#endif
-#elif defined(USE_SHAKE128_FOR_A)  // Matrix A generation using SHAKE128, done per 16*N-bit row   
-    uint8_t seed_A_separated[2 + BYTES_SEED_A];
-    uint16_t* seed_A_origin = (uint16_t*)&seed_A_separated;
-    memcpy(&seed_A_separated[2], seed_A, BYTES_SEED_A);
-    for (i = 0; i < PARAMS_N; i++) {
-        seed_A_origin[0] = (uint16_t) i;
-        shake128((unsigned char*)(A + i*PARAMS_N), (unsigned long long)(2*PARAMS_N), seed_A_separated, 2 + BYTES_SEED_A);
+    aes128_keyexp(&st->aes_key_schedule, seed_A);
+#elif defined(USE_SHAKE128_FOR_A)
+    int i;
+
+    for (i = 0; i < PARAMS_PARALLEL; i++) {
+        memcpy(&st->seed_A_separated[i][2], seed_A, BYTES_SEED_A);
     }
-#endif    
-    memcpy(out, e, PARAMS_NBAR * PARAMS_N * sizeof(uint16_t));  
+#endif
+}
 
-    for (i = 0; i < PARAMS_N; i++) {                            // Matrix multiplication-addition A*s + e
-        for (k = 0; k < PARAMS_NBAR; k++) {
-            uint16_t sum = 0;
-            for (j = 0; j < PARAMS_N; j++) {                                
-                sum += A[i*PARAMS_N + j] * s[k*PARAMS_N + j];  
-            }
-            out[i*PARAMS_NBAR + k] += sum;                      // Adding e. No need to reduce modulo 2^15, extra bits are taken care of during packing later on.
+
+static void frodo_a_rows(uint16_t *a_rows, frodo_a_state *st, int row)
+{ // Generate rows row, ..., row + PARAMS_PARALLEL - 1 of A into a_rows (PARAMS_PARALLEL x N)
+    int i;
+
+#if defined(USE_AES128_FOR_A)
+    int j;
+    for (i = 0; i < PARAMS_PARALLEL; i++) {
+        for (j = 0; j < PARAMS_N; j += PARAMS_STRIPE_STEP) {
+            st->a_in[i*PARAMS_N + j] = row + i;
         }
     }
-    
+    aes_ecb((uint8_t*)a_rows, (uint8_t*)st->a_in, sizeof(st->a_in) / 16, &st->aes_key_schedule);   // Eight blocks in flight with AES-NI
+#elif defined(USE_SHAKE128_FOR_A)
+    for (i = 0; i < PARAMS_PARALLEL; i++) {
+        st->seed_A_separated[i][0] = (uint8_t)(row + i);                // Row index in little-endian order
+        st->seed_A_separated[i][1] = (uint8_t)((row + i) >> 8);
+    }
+    for (i = 0; i < PARAMS_PARALLEL; i += 4) {                          // Four Keccak states per permutation with AVX2
+        shake128x4((unsigned char*)(a_rows + i*PARAMS_N), (unsigned char*)(a_rows + (i + 1)*PARAMS_N),
+                   (unsigned char*)(a_rows + (i + 2)*PARAMS_N), (unsigned char*)(a_rows + (i + 3)*PARAMS_N), (unsigned long long)(2*PARAMS_N),
+                   st->seed_A_separated[i], st->seed_A_separated[i + 1], st->seed_A_separated[i + 2], st->seed_A_separated[i + 3], 2 + BYTES_SEED_A);
+    }
+#endif
+}
+
+
+static void frodo_a_free(frodo_a_state *st)
+{
 #if defined(USE_AES128_FOR_A)
-    AES128_free_schedule(aes_key_schedule);
+    clear_bytes((uint8_t*)&st->aes_key_schedule, sizeof(st->aes_key_schedule));
+#else
+    UNREFERENCED_PARAMETER(st);
 #endif
-    return 1;
 }
 
 
-int frodo_mul_add_sa_plus_e(uint16_t *out, const uint16_t *s, const uint16_t *e, const uint8_t *seed_A) 
-{ // Generate-and-multiply: generate matrix A (N x N) column-wise, multiply by s' on the left.
-  // Inputs: s', e' (N_BAR x N)
-  // Output: out = s'*A + e' (N_BAR x N)
-    int i, j, k;
-    int16_t A[PARAMS_N * PARAMS_N] = {0};        
-    
-#if defined(USE_AES128_FOR_A)    // Matrix A generation using AES128, done per 128-bit block                                       
-    size_t A_len = PARAMS_N * PARAMS_N * sizeof(int16_t);      
-    for (i = 0; i < PARAMS_N; i++) {                        
-        for (j = 0; j < PARAMS_N; j += PARAMS_STRIPE_STEP) {
-            A[i*PARAMS_N + j] = i;                              // Loading values in the little-endian order
-            A[i*PARAMS_N + j + 1] = j;                                  
+// Multiplication kernels. The arithmetic wraps mod 2^16, so with AVX2 sixteen
+// 16-bit lanes are multiplied and accumulated at once and reduced at the end.
+
+static void frodo_dot_nbar(uint16_t *out, const uint16_t *a, const uint16_t *m)
+{ // out[k] = sum_j a[j]*m[k*N + j] for k < N_BAR: a row times the N_BAR rows of m
+    int j, k;
+
+#if defined(__AVX2__) && PARAMS_NBAR == 8 && PARAMS_N % 16 == 0
+    __m256i acc[8], x, h01, h23, h45, h67;
+    __m128i sum;
+
+    for (k = 0; k < 8; k++) {
+        acc[k] = _mm256_setzero_si256();
+    }
+    for (j = 0; j < PARAMS_N; j += 16) {
+        x = _mm256_loadu_si256((const __m256i*)(a + j));
+        for (k = 0; k < 8; k++) {
+            acc[k] = _mm256_add_epi16(acc[k], _mm256_mullo_epi16(x, _mm256_loadu_si256((const __m256i*)(m + k*PARAMS_N + j))));
         }
     }
-    
-#if !defined(USE_OPENSSL)
-    uint8_t aes_key_schedule[16*11];
-    AES128_load_schedule(seed_A, aes_key_schedule);  
-    AES128_ECB_enc_sch((uint8_t*)A, A_len, aes_key_schedule, (uint8_t*)A);
+    h01 = _mm256_hadd_epi16(acc[0], acc[1]);                    // Each 128-bit lane ends up holding
+    h23 = _mm256_hadd_epi16(acc[2], acc[3]);                    // its partial sums for k = 0, ..., 7
+    h45 = _mm256_hadd_epi16(acc[4], acc[5]);
+    h67 = _mm256_hadd_epi16(acc[6], acc[7]);
+    x = _mm256_hadd_epi16(_mm256_hadd_epi16(h01, h23), _mm256_hadd_epi16(h45, h67));
+    sum = _mm_add_epi16(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+    _mm_storeu_si128((__m128i*)out, sum);
 #else
-    EVP_CIPHER_CTX *aes_key_schedule;    
-    int len;
-    if (!(aes_key_schedule = EVP_CIPHER_CTX_new())) handleErrors();    
-    if (1 != EVP_EncryptInit_ex(aes_key_schedule, EVP_aes_128_ecb(), NULL, seed_A, NULL)) handleErrors();    
-    if (1 != EVP_EncryptUpdate(aes_key_schedule, (uint8_t*)A, &len, (uint8_t*)A, A_len)) handleErrors();
-#endif
-#elif defined (USE_SHAKE128_FOR_A)  // Matrix A generation using SHAKE128, done per 16*N-bit row
-    uint8_t seed_A_separated[2 + BYTES_SEED_A];
-    uint16_t* seed_A_origin = (uint16_t*)&seed_A_separated;
-    memcpy(&seed_A_separated[2], seed_A, BYTES_SEED_A);
-    for (i = 0; i < PARAMS_N; i++) {
-        seed_A_origin[0] = (uint16_t) i;
-        shake128((unsigned char*)(A + i*PARAMS_N), (unsigned long long)(2*PARAMS_N), seed_A_separated, 2 + BYTES_SEED_A);
+    for (k = 0; k < PARAMS_NBAR; k++) {
+        uint16_t sum = 0;
+        for (j = 0; j < PARAMS_N; j++) {
+            sum += (uint32_t)a[j] * m[k*PARAMS_N + j];
+        }
+        out[k] = sum;
     }
 #endif
-    memcpy(out, e, PARAMS_NBAR * PARAMS_N * sizeof(uint16_t));
+}
+
+
+static void frodo_axpy_rows(uint16_t *out, const uint16_t *s, const uint16_t *a_rows, int row)
+{ // out[k][i] += sum_r s[k][row + r]*a_rows[r][i] for k < N_BAR, r < PARAMS_PARALLEL
+    int i, k, r;
+
+#if defined(__AVX2__) && PARAMS_N % 16 == 0
+    __m256i sp[PARAMS_NBAR][PARAMS_PARALLEL], a[PARAMS_PARALLEL], o;
 
-    for (i = 0; i < PARAMS_N; i++) {                            // Matrix multiplication-addition A*s + e
+    for (k = 0; k < PARAMS_NBAR; k++) {
+        for (r = 0; r < PARAMS_PARALLEL; r++) {
+            sp[k][r] = _mm256_set1_epi16(s[k*PARAMS_N + row + r]);
+        }
+    }
+    for (i = 0; i < PARAMS_N; i += 16) {                        // Each block of A is loaded once for all k
+        for (r = 0; r < PARAMS_PARALLEL; r++) {
+            a[r] = _mm256_loadu_si256((const __m256i*)(a_rows + r*PARAMS_N + i));
+        }
         for (k = 0; k < PARAMS_NBAR; k++) {
-            uint16_t sum = 0;
-            for (j = 0; j < PARAMS_N; j++) {                                
-                sum += A[j*PARAMS_N + i] * s[k*PARAMS_N + j];  
+            o = _mm256_loadu_si256((const __m256i*)(out + k*PARAMS_N + i));
+            for (r = 0; r < PARAMS_PARALLEL; r++) {
+                o = _mm256_add_epi16(o, _mm256_mullo_epi16(a[r], sp[k][r]));
             }
-            out[k*PARAMS_N + i] += sum;                         // Adding e. No need to reduce modulo 2^15, extra bits are taken care of during packing later on.
+            _mm256_storeu_si256((__m256i*)(out + k*PARAMS_N + i), o);
         }
     }
-    
-#if defined(USE_AES128_FOR_A)
-    AES128_free_schedule(aes_key_schedule);
+#else
+    for (k = 0; k < PARAMS_NBAR; k++) {
+        uint32_t sp[PARAMS_PARALLEL];
+        for (r = 0; r < PARAMS_PARALLEL; r++) {
+            sp[r] = s[k*PARAMS_N + row + r];
+        }
+        for (i = 0; i < PARAMS_N; i++) {
+            uint32_t sum = 0;
+            for (r = 0; r < PARAMS_PARALLEL; r++) {
+                sum += a_rows[r*PARAMS_N + i] * sp[r];
+            }
+            out[k*PARAMS_N + i] += sum;
+        }
+    }
+#endif
+}
+
+
+static void frodo_as_rows(uint16_t *out, const uint16_t *s, const uint8_t *seed_A, int first, int last)
+{ // Rows first, ..., last - 1 of A*s added to out. Each caller keeps its own generator state.
+    int i, k, r;
+    uint16_t a_rows[PARAMS_PARALLEL * PARAMS_N], sum[PARAMS_NBAR];
+    frodo_a_state st;
+
+    frodo_a_init(&st, seed_A);
+    for (i = first; i < last; i += PARAMS_PARALLEL) {
+        frodo_a_rows(a_rows, &st, i);
+        for (r = 0; r < PARAMS_PARALLEL; r++) {
+            frodo_dot_nbar(sum, a_rows + r*PARAMS_N, s);
+            for (k = 0; k < PARAMS_NBAR; k++) {
+                out[(i + r)*PARAMS_NBAR + k] += sum[k];
+            }
+        }
+    }
+    frodo_a_free(&st);
+}
+
+
+static void frodo_sa_rows(uint16_t *out, const uint16_t *s, const uint8_t *seed_A, int first, int last)
+{ // s'*A restricted to rows first, ..., last - 1 of A, added to out
+    int j;
+    uint16_t a_rows[PARAMS_PARALLEL * PARAMS_N];
+    frodo_a_state st;
+
+    frodo_a_init(&st, seed_A);
+    for (j = first; j < last; j += PARAMS_PARALLEL) {
+        frodo_a_rows(a_rows, &st, j);
+        frodo_axpy_rows(out, s, a_rows, j);
+    }
+    frodo_a_free(&st);
+}
+
+
+#if defined(FRODO_THREADS) && FRODO_THREADS > 1
+// Threaded mode: the row blocks of A are split evenly across the pool, and every
+// worker generates and multiplies its own blocks.
+
+// First row of slice w out of n
+#define FRODO_SLICE(w, n) ((int)(((w) * (PARAMS_N / PARAMS_PARALLEL)) / (n)) * PARAMS_PARALLEL)
+
+typedef struct {
+    uint16_t *out;
+    const uint16_t *s;
+    const uint8_t *seed_A;
+    pthread_mutex_t lock;
+} frodo_mul_job;
+
+
+static void frodo_as_slice(void *arg, int w, int n)
+{ // Output rows are disjoint between slices
+    frodo_mul_job *job = (frodo_mul_job *)arg;
+
+    frodo_as_rows(job->out, job->s, job->seed_A, FRODO_SLICE(w, n), FRODO_SLICE(w + 1, n));
+}
+
+
+static void frodo_sa_slice(void *arg, int w, int n)
+{ // Every slice contributes to all of out: sum privately, then add under the lock
+    frodo_mul_job *job = (frodo_mul_job *)arg;
+    uint16_t partial[PARAMS_NBAR * PARAMS_N] = {0};
+    int i;
+
+    frodo_sa_rows(partial, job->s, job->seed_A, FRODO_SLICE(w, n), FRODO_SLICE(w + 1, n));
+    pthread_mutex_lock(&job->lock);
+    for (i = 0; i < PARAMS_NBAR * PARAMS_N; i++) {
+        job->out[i] += partial[i];
+    }
+    pthread_mutex_unlock(&job->lock);
+}
+#endif
+
+
+int frodo_mul_add_as_plus_e(uint16_t *out, const uint16_t *s, const uint16_t *e, const uint8_t *seed_A) 
+{ // Generate-and-multiply: generate matrix A (N x N) row-wise, multiply by s on the right.
+  // Inputs: s, e (N x N_BAR)
+  // Output: out = A*s + e (N x N_BAR)
+    memcpy(out, e, PARAMS_NBAR * PARAMS_N * sizeof(uint16_t));  // Adding e. No need to reduce modulo 2^15, extra bits are taken care of during packing later on.
+
+#if defined(FRODO_THREADS) && FRODO_THREADS > 1
+    frodo_mul_job job = { out, s, seed_A, PTHREAD_MUTEX_INITIALIZER };
+    frodo_pool_run(frodo_as_slice, &job);
+#else
+    frodo_as_rows(out, s, seed_A, 0, PARAMS_N);
+#endif
+    return 1;
+}
+
+
+int frodo_mul_add_sa_plus_e(uint16_t *out, const uint16_t *s, const uint16_t *e, const uint8_t *seed_A) 
+{ // Generate-and-multiply: generate matrix A (N x N) row-wise, multiply by s' on the left.
+  // Inputs: s', e' (N_BAR x N)
+  // Output: out = s'*A + e' (N_BAR x N)
+    memcpy(out, e, PARAMS_NBAR * PARAMS_N * sizeof(uint16_t));  // Adding e. No need to reduce modulo 2^15, extra bits are taken care of during packing later on.
+
+#if defined(FRODO_THREADS) && FRODO_THREADS > 1
+    frodo_mul_job job = { out, s, seed_A, PTHREAD_MUTEX_INITIALIZER };
+    frodo_pool_run(frodo_sa_slice, &job);
+#else
+    frodo_sa_rows(out, s, seed_A, 0, PARAMS_N);
 #endif
     return 1;
 }
@@ -125,33 +280,33 @@ void frodo_mul_bs(uint16_t *out, const uint16_t *b, const uint16_t *s)
 { // Multiply by s on the right
   // Inputs: b (N_BAR x N), s (N x N_BAR)
   // Output: out = b*s (N_BAR x N_BAR)
-    int i, j, k;
+    int i, j;
 
     for (i = 0; i < PARAMS_NBAR; i++) {
+        frodo_dot_nbar(&out[i*PARAMS_NBAR], &b[i*PARAMS_N], s);
         for (j = 0; j < PARAMS_NBAR; j++) {
-            out[i*PARAMS_NBAR + j] = 0;
-            for (k = 0; k < PARAMS_N; k++) {
-                out[i*PARAMS_NBAR + j] += b[i*PARAMS_N + k] * s[j*PARAMS_N + k];
-            }
-            out[i*PARAMS_NBAR + j] = (uint32_t)(out[i*PARAMS_NBAR + j]) & ((1<<PARAMS_LOGQ)-1);
+            out[i*PARAMS_NBAR + j] &= (1<<PARAMS_LOGQ)-1;
         }
     }
 }
 
 
-void frodo_mul_add_sb_plus_e(uint16_t *out, const uint16_t *b, const uint16_t *s, const uint16_t *e) 
+void frodo_mul_add_sb_plus_e(uint16_t *out, const uint16_t *b, const uint16_t *s, const uint16_t *e, uint16_t *bt) 
 { // Multiply by s on the left
   // Inputs: b (N x N_BAR), s (N_BAR x N), e (N_BAR x N_BAR)
   // Output: out = s*b + e (N_BAR x N_BAR)
+  // Workspace: bt (N_BAR x N), b transposed
     int i, j, k;
 
+    for (j = 0; j < PARAMS_N; j++) {                            // Transpose b so each column is a row
+        for (i = 0; i < PARAMS_NBAR; i++) {
+            bt[i*PARAMS_N + j] = b[j*PARAMS_NBAR + i];
+        }
+    }
     for (k = 0; k < PARAMS_NBAR; k++) {
+        frodo_dot_nbar(&out[k*PARAMS_NBAR], &s[k*PARAMS_N], bt);
         for (i = 0; i < PARAMS_NBAR; i++) {
-            out[k*PARAMS_NBAR + i] = e[k*PARAMS_NBAR + i];
-            for (j = 0; j < PARAMS_N; j++) {
-                out[k*PARAMS_NBAR + i] += s[k*PARAMS_N + j] * b[j*PARAMS_NBAR + i];
-            }
-            out[k*PARAMS_NBAR + i] = (uint32_t)(out[k*PARAMS_NBAR + i]) & ((1<<PARAMS_LOGQ)-1);
+            out[k*PARAMS_NBAR + i] = (out[k*PARAMS_NBAR + i] + e[k*PARAMS_NBAR + i]) & ((1<<PARAMS_LOGQ)-1);
         }
     }
 }
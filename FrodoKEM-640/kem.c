@@ -4,38 +4,60 @@
 * Abstract: Key Encapsulation Mechanism (KEM) based on Frodo
 *********************************************************************************************/
 
+#include <stdlib.h>
 #include <string.h>
-#include "sha3/fips202.h"
-#include "random/random.h"
+#include "fips202.h"
+#include "fips202x4.h"
+#include "randombytes.h"
 
 
-int crypto_kem_keypair(unsigned char* pk, unsigned char* sk)
-{ // FrodoKEM's key generation
-  // Outputs: public key pk (               BYTES_SEED_A + (PARAMS_LOGQ*PARAMS_N*PARAMS_NBAR)/8 bytes)
-  //          secret key sk (CRYPTO_BYTES + BYTES_SEED_A + (PARAMS_LOGQ*PARAMS_N*PARAMS_NBAR)/8 + 2*PARAMS_N*PARAMS_NBAR + BYTES_PKHASH bytes)
-    uint8_t *pk_seedA = &pk[0];
+// Large temporaries of each operation: on the stack of crypto_kem_*, or in the caller's
+// arena for crypto_kem_*_with_scratch
+typedef struct {
+    uint16_t B[PARAMS_N*PARAMS_NBAR];
+    uint16_t S[2*PARAMS_N*PARAMS_NBAR];                     // contains secret data
+} frodo_keypair_scratch;
+
+typedef struct {
+    uint16_t B[PARAMS_N*PARAMS_NBAR];
+    uint16_t Bp[PARAMS_N*PARAMS_NBAR];
+    uint16_t Sp[(2*PARAMS_N+PARAMS_NBAR)*PARAMS_NBAR];      // contains secret data
+    uint16_t Bt[PARAMS_NBAR*PARAMS_N];                      // workspace of frodo_mul_add_sb_plus_e
+} frodo_enc_scratch;
+
+typedef struct {
+    uint16_t B[PARAMS_N*PARAMS_NBAR];
+    uint16_t Bp[PARAMS_N*PARAMS_NBAR];
+    uint16_t BBp[PARAMS_N*PARAMS_NBAR];
+    uint16_t Sp[(2*PARAMS_N+PARAMS_NBAR)*PARAMS_NBAR];      // contains secret data
+    uint16_t Bt[PARAMS_NBAR*PARAMS_N];                      // workspace of frodo_mul_add_sb_plus_e
+} frodo_dec_scratch;
+
+typedef union {
+    frodo_keypair_scratch keypair;
+    frodo_enc_scratch enc;
+    frodo_dec_scratch dec;
+} frodo_scratch;
+
+
+size_t crypto_kem_scratch_bytes(void)
+{ // Size of the arena of crypto_kem_*_with_scratch, which can be reused by all three operations
+    return sizeof(frodo_scratch);
+}
+
+
+static void frodo_keypair_matrix(unsigned char* pk, unsigned char* sk, const uint8_t *randomness_s, frodo_keypair_scratch *w)
+{ // Key generation from seed_A, already in pk, and the SHAKE output of seedSE, already in w->S:
+  // samples S and E, computes B = A*S + E, and fills pk and sk except for H(pk)
     uint8_t *pk_b = &pk[BYTES_SEED_A];
     uint8_t *sk_s = &sk[0];
     uint8_t *sk_pk = &sk[CRYPTO_BYTES];
     uint8_t *sk_S = &sk[CRYPTO_BYTES + CRYPTO_PUBLICKEYBYTES];
-    uint8_t *sk_pkh = &sk[CRYPTO_BYTES + CRYPTO_PUBLICKEYBYTES + 2*PARAMS_N*PARAMS_NBAR];
-    uint16_t B[PARAMS_N*PARAMS_NBAR] = {0};
-    uint16_t S[2*PARAMS_N*PARAMS_NBAR] = {0};               // contains secret data
+    uint16_t *B = w->B;
+    uint16_t *S = w->S;                                     // contains secret data
     uint16_t *E = (uint16_t *)&S[PARAMS_N*PARAMS_NBAR];     // contains secret data
-    uint8_t randomness[2*CRYPTO_BYTES + BYTES_SEED_A];      // contains secret data via randomness_s and randomness_seedSE
-    uint8_t *randomness_s = &randomness[0];                 // contains secret data
-    uint8_t *randomness_seedSE = &randomness[CRYPTO_BYTES]; // contains secret data
-    uint8_t *randomness_z = &randomness[2*CRYPTO_BYTES];
-    uint8_t shake_input_seedSE[1 + CRYPTO_BYTES];           // contains secret data
-
-    // Generate the secret value s, the seed for S and E, and the seed for the seed for A. Add seed_A to the public key
-    randombytes(randomness, CRYPTO_BYTES + CRYPTO_BYTES + BYTES_SEED_A);
-    shake(pk_seedA, BYTES_SEED_A, randomness_z, BYTES_SEED_A);
 
     // Generate S and E, and compute B = A*S + E. Generate A on-the-fly
-    shake_input_seedSE[0] = 0x5F;
-    memcpy(&shake_input_seedSE[1], randomness_seedSE, CRYPTO_BYTES);
-    shake((uint8_t*)S, 2*PARAMS_N*PARAMS_NBAR*sizeof(uint16_t), shake_input_seedSE, 1 + CRYPTO_BYTES);
     frodo_sample_n(S, PARAMS_N*PARAMS_NBAR);
     frodo_sample_n(E, PARAMS_N*PARAMS_NBAR);
     frodo_mul_add_as_plus_e(B, S, E, pk);
@@ -48,51 +70,60 @@ int crypto_kem_keypair(unsigned char* pk, unsigned char* sk)
     memcpy(sk_pk, pk, CRYPTO_PUBLICKEYBYTES);
     memcpy(sk_S, S, 2*PARAMS_N*PARAMS_NBAR);
 
+    // Cleanup:
+    clear_bytes((uint8_t *)S, PARAMS_N*PARAMS_NBAR*sizeof(uint16_t));
+    clear_bytes((uint8_t *)E, PARAMS_N*PARAMS_NBAR*sizeof(uint16_t));
+}
+
+
+static int frodo_keypair(unsigned char* pk, unsigned char* sk, frodo_keypair_scratch *w)
+{ // FrodoKEM's key generation
+  // Outputs: public key pk (               BYTES_SEED_A + (PARAMS_LOGQ*PARAMS_N*PARAMS_NBAR)/8 bytes)
+  //          secret key sk (CRYPTO_BYTES + BYTES_SEED_A + (PARAMS_LOGQ*PARAMS_N*PARAMS_NBAR)/8 + 2*PARAMS_N*PARAMS_NBAR + BYTES_PKHASH bytes)
+    uint8_t *pk_seedA = &pk[0];
+    uint8_t *sk_pkh = &sk[CRYPTO_BYTES + CRYPTO_PUBLICKEYBYTES + 2*PARAMS_N*PARAMS_NBAR];
+    uint8_t randomness[2*CRYPTO_BYTES + BYTES_SEED_A];      // contains secret data via randomness_s and randomness_seedSE
+    uint8_t *randomness_s = &randomness[0];                 // contains secret data
+    uint8_t *randomness_seedSE = &randomness[CRYPTO_BYTES]; // contains secret data
+    uint8_t *randomness_z = &randomness[2*CRYPTO_BYTES];
+    uint8_t shake_input_seedSE[1 + CRYPTO_BYTES];           // contains secret data
+
+    // Generate the secret value s, the seed for S and E, and the seed for the seed for A. Add seed_A to the public key
+    randombytes(randomness, CRYPTO_BYTES + CRYPTO_BYTES + BYTES_SEED_A);
+    shake(pk_seedA, BYTES_SEED_A, randomness_z, BYTES_SEED_A);
+
+    // Expand the seed for S and E
+    shake_input_seedSE[0] = 0x5F;
+    memcpy(&shake_input_seedSE[1], randomness_seedSE, CRYPTO_BYTES);
+    shake((uint8_t*)w->S, 2*PARAMS_N*PARAMS_NBAR*sizeof(uint16_t), shake_input_seedSE, 1 + CRYPTO_BYTES);
+    frodo_keypair_matrix(pk, sk, randomness_s, w);
+
     // Add H(pk) to the secret key
     shake(sk_pkh, BYTES_PKHASH, pk, CRYPTO_PUBLICKEYBYTES);
 
     // Cleanup:
-    clear_bytes((uint8_t *)S, PARAMS_N*PARAMS_NBAR*sizeof(uint16_t));
-    clear_bytes((uint8_t *)E, PARAMS_N*PARAMS_NBAR*sizeof(uint16_t));
     clear_bytes(randomness, 2*CRYPTO_BYTES);
     clear_bytes(shake_input_seedSE, 1 + CRYPTO_BYTES);
     return 0;
 }
 
 
-int crypto_kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk)
-{ // FrodoKEM's key encapsulation
+static void frodo_enc_matrix(unsigned char *ct, const uint8_t *mu, const unsigned char *pk, frodo_enc_scratch *w)
+{ // Encryption of mu to pk, with the SHAKE output of seedSE already in w->Sp: samples Sp, Ep and Epp,
+  // computes Bp = Sp*A + Ep and C = Sp*B + Epp + enc(mu), and packs them into ct
     const uint8_t *pk_seedA = &pk[0];
     const uint8_t *pk_b = &pk[BYTES_SEED_A];
     uint8_t *ct_c1 = &ct[0];
     uint8_t *ct_c2 = &ct[(PARAMS_LOGQ*PARAMS_N*PARAMS_NBAR)/8];
-    uint16_t B[PARAMS_N*PARAMS_NBAR] = {0};
+    uint16_t *B = w->B;
     uint16_t V[PARAMS_NBAR*PARAMS_NBAR]= {0};                 // contains secret data
     uint16_t C[PARAMS_NBAR*PARAMS_NBAR] = {0};
-    uint16_t Bp[PARAMS_N*PARAMS_NBAR] = {0};
-    uint16_t Sp[(2*PARAMS_N+PARAMS_NBAR)*PARAMS_NBAR] = {0};  // contains secret data
+    uint16_t *Bp = w->Bp;
+    uint16_t *Sp = w->Sp;                                     // contains secret data
     uint16_t *Ep = (uint16_t *)&Sp[PARAMS_N*PARAMS_NBAR];     // contains secret data
     uint16_t *Epp = (uint16_t *)&Sp[2*PARAMS_N*PARAMS_NBAR];  // contains secret data
-    uint8_t G2in[BYTES_PKHASH + BYTES_MU];                    // contains secret data via mu
-    uint8_t *pkh = &G2in[0];
-    uint8_t *mu = &G2in[BYTES_PKHASH];                        // contains secret data
-    uint8_t G2out[2*CRYPTO_BYTES];                            // contains secret data
-    uint8_t *seedSE = &G2out[0];                              // contains secret data
-    uint8_t *k = &G2out[CRYPTO_BYTES];                        // contains secret data
-    uint8_t Fin[CRYPTO_CIPHERTEXTBYTES + CRYPTO_BYTES];       // contains secret data via Fin_k
-    uint8_t *Fin_ct = &Fin[0];
-    uint8_t *Fin_k = &Fin[CRYPTO_CIPHERTEXTBYTES];            // contains secret data
-    uint8_t shake_input_seedSE[1 + CRYPTO_BYTES];             // contains secret data
-
-    // pkh <- G_1(pk), generate random mu, compute (seedSE || k) = G_2(pkh || mu)
-    shake(pkh, BYTES_PKHASH, pk, CRYPTO_PUBLICKEYBYTES);
-    randombytes(mu, BYTES_MU);
-    shake(G2out, CRYPTO_BYTES + CRYPTO_BYTES, G2in, BYTES_PKHASH + BYTES_MU);
 
     // Generate Sp and Ep, and compute Bp = Sp*A + Ep. Generate A on-the-fly
-    shake_input_seedSE[0] = 0x96;
-    memcpy(&shake_input_seedSE[1], seedSE, CRYPTO_BYTES);
-    shake((uint8_t*)Sp, (2*PARAMS_N+PARAMS_NBAR)*PARAMS_NBAR*sizeof(uint16_t), shake_input_seedSE, 1 + CRYPTO_BYTES);
     frodo_sample_n(Sp, PARAMS_N*PARAMS_NBAR);
     frodo_sample_n(Ep, PARAMS_N*PARAMS_NBAR);
     frodo_mul_add_sa_plus_e(Bp, Sp, Ep, pk_seedA);
@@ -101,76 +132,94 @@ int crypto_kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk
     // Generate Epp, and compute V = Sp*B + Epp
     frodo_sample_n(Epp, PARAMS_NBAR*PARAMS_NBAR);
     frodo_unpack(B, PARAMS_N*PARAMS_NBAR, pk_b, CRYPTO_PUBLICKEYBYTES - BYTES_SEED_A, PARAMS_LOGQ);
-    frodo_mul_add_sb_plus_e(V, B, Sp, Epp);
+    frodo_mul_add_sb_plus_e(V, B, Sp, Epp, w->Bt);
 
     // Encode mu, and compute C = V + enc(mu) (mod q)
-    frodo_key_encode(C, (uint16_t*)mu);
+    frodo_key_encode(C, (const uint16_t*)mu);
     frodo_add(C, V, C);
     frodo_pack(ct_c2, (PARAMS_LOGQ*PARAMS_NBAR*PARAMS_NBAR)/8, C, PARAMS_NBAR*PARAMS_NBAR, PARAMS_LOGQ);
 
-    // Compute ss = F(ct||KK)
-    memcpy(Fin_ct, ct, CRYPTO_CIPHERTEXTBYTES);
-    memcpy(Fin_k, k, CRYPTO_BYTES);
-    shake(ss, CRYPTO_BYTES, Fin, CRYPTO_CIPHERTEXTBYTES + CRYPTO_BYTES);
-
     // Cleanup:
     clear_bytes((uint8_t *)V, PARAMS_NBAR*PARAMS_NBAR*sizeof(uint16_t));
     clear_bytes((uint8_t *)Sp, PARAMS_N*PARAMS_NBAR*sizeof(uint16_t));
     clear_bytes((uint8_t *)Ep, PARAMS_N*PARAMS_NBAR*sizeof(uint16_t));
     clear_bytes((uint8_t *)Epp, PARAMS_NBAR*PARAMS_NBAR*sizeof(uint16_t));
+}
+
+
+static int frodo_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk, frodo_enc_scratch *w)
+{ // FrodoKEM's key encapsulation
+    uint8_t G2in[BYTES_PKHASH + BYTES_MU];                    // contains secret data via mu
+    uint8_t *pkh = &G2in[0];
+    uint8_t *mu = &G2in[BYTES_PKHASH];                        // contains secret data
+    uint8_t G2out[2*CRYPTO_BYTES];                            // contains secret data
+    uint8_t *seedSE = &G2out[0];                              // contains secret data
+    uint8_t *k = &G2out[CRYPTO_BYTES];                        // contains secret data
+    keccak_incctx Fctx;                                       // contains secret data after absorbing k
+    uint8_t shake_input_seedSE[1 + CRYPTO_BYTES];             // contains secret data
+
+    // pkh <- G_1(pk), generate random mu, compute (seedSE || k) = G_2(pkh || mu)
+    shake(pkh, BYTES_PKHASH, pk, CRYPTO_PUBLICKEYBYTES);
+    randombytes(mu, BYTES_MU);
+    shake(G2out, CRYPTO_BYTES + CRYPTO_BYTES, G2in, BYTES_PKHASH + BYTES_MU);
+
+    // Expand seedSE, and compute the ciphertext
+    shake_input_seedSE[0] = 0x96;
+    memcpy(&shake_input_seedSE[1], seedSE, CRYPTO_BYTES);
+    shake((uint8_t*)w->Sp, (2*PARAMS_N+PARAMS_NBAR)*PARAMS_NBAR*sizeof(uint16_t), shake_input_seedSE, 1 + CRYPTO_BYTES);
+    frodo_enc_matrix(ct, mu, pk, w);
+
+    // Compute ss = F(ct||KK), absorbing ct in place rather than copying it next to k
+    shake_inc_init(&Fctx);
+    shake_inc_absorb(&Fctx, ct, CRYPTO_CIPHERTEXTBYTES);
+    shake_inc_absorb(&Fctx, k, CRYPTO_BYTES);
+    shake_inc_finalize(&Fctx);
+    shake_inc_squeeze(ss, CRYPTO_BYTES, &Fctx);
+
+    // Cleanup:
     clear_bytes(mu, BYTES_MU);
     clear_bytes(G2out, 2*CRYPTO_BYTES);
-    clear_bytes(Fin_k, CRYPTO_BYTES);
+    clear_bytes((uint8_t *)&Fctx, sizeof(Fctx));
     clear_bytes(shake_input_seedSE, 1 + CRYPTO_BYTES);
     return 0;
 }
 
 
-int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk)
-{ // FrodoKEM's key decapsulation
-    uint16_t B[PARAMS_N*PARAMS_NBAR] = {0};
-    uint16_t Bp[PARAMS_N*PARAMS_NBAR] = {0};
+static void frodo_dec_decode(uint8_t *muprime, uint16_t *C, const unsigned char *ct, const unsigned char *sk, frodo_dec_scratch *w)
+{ // First part of the decapsulation: unpacks Bp (into w->Bp) and C from ct, and decodes mu' from W = C - Bp*S (mod q)
+    uint16_t *Bp = w->Bp;
     uint16_t W[PARAMS_NBAR*PARAMS_NBAR] = {0};                // contains secret data
-    uint16_t C[PARAMS_NBAR*PARAMS_NBAR] = {0};
-    uint16_t CC[PARAMS_NBAR*PARAMS_NBAR] = {0};
-    uint16_t BBp[PARAMS_N*PARAMS_NBAR] = {0};
-    uint16_t Sp[(2*PARAMS_N+PARAMS_NBAR)*PARAMS_NBAR] = {0};  // contains secret data
-    uint16_t *Ep = (uint16_t *)&Sp[PARAMS_N*PARAMS_NBAR];     // contains secret data
-    uint16_t *Epp = (uint16_t *)&Sp[2*PARAMS_N*PARAMS_NBAR];  // contains secret data
     const uint8_t *ct_c1 = &ct[0];
     const uint8_t *ct_c2 = &ct[(PARAMS_LOGQ*PARAMS_N*PARAMS_NBAR)/8];
-    const uint8_t *sk_s = &sk[0];
-    const uint8_t *sk_pk = &sk[CRYPTO_BYTES];
-    const uint16_t *sk_S = (uint16_t *) &sk[CRYPTO_BYTES + CRYPTO_PUBLICKEYBYTES];
-    const uint8_t *sk_pkh = &sk[CRYPTO_BYTES + CRYPTO_PUBLICKEYBYTES + 2*PARAMS_N*PARAMS_NBAR];
-    const uint8_t *pk_seedA = &sk_pk[0];
-    const uint8_t *pk_b = &sk_pk[BYTES_SEED_A];
-    uint8_t G2in[BYTES_PKHASH + BYTES_MU];                   // contains secret data via muprime
-    uint8_t *pkh = &G2in[0];
-    uint8_t *muprime = &G2in[BYTES_PKHASH];                  // contains secret data
-    uint8_t G2out[2*CRYPTO_BYTES];                           // contains secret data
-    uint8_t *seedSEprime = &G2out[0];                        // contains secret data
-    uint8_t *kprime = &G2out[CRYPTO_BYTES];                  // contains secret data
-    uint8_t Fin[CRYPTO_CIPHERTEXTBYTES + CRYPTO_BYTES];      // contains secret data via Fin_k
-    uint8_t *Fin_ct = &Fin[0];
-    uint8_t *Fin_k = &Fin[CRYPTO_CIPHERTEXTBYTES];           // contains secret data
-    uint8_t shake_input_seedSEprime[1 + CRYPTO_BYTES];       // contains secret data
+    const uint16_t *sk_S = (const uint16_t *) &sk[CRYPTO_BYTES + CRYPTO_PUBLICKEYBYTES];
 
-    // Compute W = C - Bp*S (mod q), and decode the randomness mu
     frodo_unpack(Bp, PARAMS_N*PARAMS_NBAR, ct_c1, (PARAMS_LOGQ*PARAMS_N*PARAMS_NBAR)/8, PARAMS_LOGQ);
     frodo_unpack(C, PARAMS_NBAR*PARAMS_NBAR, ct_c2, (PARAMS_LOGQ*PARAMS_NBAR*PARAMS_NBAR)/8, PARAMS_LOGQ);
     frodo_mul_bs(W, Bp, sk_S);
     frodo_sub(W, C, W);
     frodo_key_decode((uint16_t*)muprime, W);
 
-    // Generate (seedSE' || k') = G_2(pkh || mu')
-    memcpy(pkh, sk_pkh, BYTES_PKHASH);
-    shake(G2out, CRYPTO_BYTES + CRYPTO_BYTES, G2in, BYTES_PKHASH + BYTES_MU);
+    clear_bytes((uint8_t *)W, PARAMS_NBAR*PARAMS_NBAR*sizeof(uint16_t));
+}
+
+
+static int frodo_dec_check(const uint8_t *muprime, const uint16_t *C, const unsigned char *sk, frodo_dec_scratch *w)
+{ // Second part, with the SHAKE output of seedSE' already in w->Sp: re-encrypts mu' to the public key in sk,
+  // and returns 1 when the result is the (Bp, C) of the first part
+    uint16_t *B = w->B;
+    uint16_t *Bp = w->Bp;
+    uint16_t W[PARAMS_NBAR*PARAMS_NBAR] = {0};                // contains secret data
+    uint16_t CC[PARAMS_NBAR*PARAMS_NBAR] = {0};
+    uint16_t *BBp = w->BBp;
+    uint16_t *Sp = w->Sp;                                     // contains secret data
+    uint16_t *Ep = (uint16_t *)&Sp[PARAMS_N*PARAMS_NBAR];     // contains secret data
+    uint16_t *Epp = (uint16_t *)&Sp[2*PARAMS_N*PARAMS_NBAR];  // contains secret data
+    const uint8_t *sk_pk = &sk[CRYPTO_BYTES];
+    const uint8_t *pk_seedA = &sk_pk[0];
+    const uint8_t *pk_b = &sk_pk[BYTES_SEED_A];
+    int ok;
 
     // Generate Sp and Ep, and compute BBp = Sp*A + Ep. Generate A on-the-fly
-    shake_input_seedSEprime[0] = 0x96;
-    memcpy(&shake_input_seedSEprime[1], seedSEprime, CRYPTO_BYTES);
-    shake((uint8_t*)Sp, (2*PARAMS_N+PARAMS_NBAR)*PARAMS_NBAR*sizeof(uint16_t), shake_input_seedSEprime, 1 + CRYPTO_BYTES);
     frodo_sample_n(Sp, PARAMS_N*PARAMS_NBAR);
     frodo_sample_n(Ep, PARAMS_N*PARAMS_NBAR);
     frodo_mul_add_sa_plus_e(BBp, Sp, Ep, pk_seedA);
@@ -178,36 +227,283 @@ int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned ch
     // Generate Epp, and compute W = Sp*B + Epp
     frodo_sample_n(Epp, PARAMS_NBAR*PARAMS_NBAR);
     frodo_unpack(B, PARAMS_N*PARAMS_NBAR, pk_b, CRYPTO_PUBLICKEYBYTES - BYTES_SEED_A, PARAMS_LOGQ);
-    frodo_mul_add_sb_plus_e(W, B, Sp, Epp);
+    frodo_mul_add_sb_plus_e(W, B, Sp, Epp, w->Bt);
 
     // Encode mu, and compute CC = W + enc(mu') (mod q)
-    frodo_key_encode(CC, (uint16_t*)muprime);
+    frodo_key_encode(CC, (const uint16_t*)muprime);
     frodo_add(CC, W, CC);
 
-    // Prepare input to F
-    memcpy(Fin_ct, ct, CRYPTO_CIPHERTEXTBYTES);
-
     // Reducing BBp modulo q
     for (int i = 0; i < PARAMS_N*PARAMS_NBAR; i++) BBp[i] = BBp[i] & ((1 << PARAMS_LOGQ)-1);
 
     // Is (Bp == BBp & C == CC) = true
-    if (memcmp(Bp, BBp, 2*PARAMS_N*PARAMS_NBAR) == 0 && memcmp(C, CC, 2*PARAMS_NBAR*PARAMS_NBAR) == 0) {
-        // Load k' to do ss = F(ct || k')
-        memcpy(Fin_k, kprime, CRYPTO_BYTES);
-    } else {
-        // Load s to do ss = F(ct || s)
-        memcpy(Fin_k, sk_s, CRYPTO_BYTES);
-    }
-    shake(ss, CRYPTO_BYTES, Fin, CRYPTO_CIPHERTEXTBYTES + CRYPTO_BYTES);
+    ok = memcmp(Bp, BBp, 2*PARAMS_N*PARAMS_NBAR) == 0 && memcmp(C, CC, 2*PARAMS_NBAR*PARAMS_NBAR) == 0;
 
     // Cleanup:
     clear_bytes((uint8_t *)W, PARAMS_NBAR*PARAMS_NBAR*sizeof(uint16_t));
     clear_bytes((uint8_t *)Sp, PARAMS_N*PARAMS_NBAR*sizeof(uint16_t));
     clear_bytes((uint8_t *)Ep, PARAMS_N*PARAMS_NBAR*sizeof(uint16_t));
     clear_bytes((uint8_t *)Epp, PARAMS_NBAR*PARAMS_NBAR*sizeof(uint16_t));
+    return ok;
+}
+
+
+static int frodo_dec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, frodo_dec_scratch *w)
+{ // FrodoKEM's key decapsulation
+    uint16_t C[PARAMS_NBAR*PARAMS_NBAR] = {0};
+    const uint8_t *sk_s = &sk[0];
+    const uint8_t *sk_pkh = &sk[CRYPTO_BYTES + CRYPTO_PUBLICKEYBYTES + 2*PARAMS_N*PARAMS_NBAR];
+    uint8_t G2in[BYTES_PKHASH + BYTES_MU];                   // contains secret data via muprime
+    uint8_t *pkh = &G2in[0];
+    uint8_t *muprime = &G2in[BYTES_PKHASH];                  // contains secret data
+    uint8_t G2out[2*CRYPTO_BYTES];                           // contains secret data
+    uint8_t *seedSEprime = &G2out[0];                        // contains secret data
+    uint8_t *kprime = &G2out[CRYPTO_BYTES];                  // contains secret data
+    keccak_incctx Fctx;                                      // contains secret data after absorbing k'/s
+    uint8_t shake_input_seedSEprime[1 + CRYPTO_BYTES];       // contains secret data
+    int ok;
+
+    // Compute W = C - Bp*S (mod q), and decode the randomness mu
+    frodo_dec_decode(muprime, C, ct, sk, w);
+
+    // Generate (seedSE' || k') = G_2(pkh || mu')
+    memcpy(pkh, sk_pkh, BYTES_PKHASH);
+    shake(G2out, CRYPTO_BYTES + CRYPTO_BYTES, G2in, BYTES_PKHASH + BYTES_MU);
+
+    // Expand seedSE', and re-encrypt mu'
+    shake_input_seedSEprime[0] = 0x96;
+    memcpy(&shake_input_seedSEprime[1], seedSEprime, CRYPTO_BYTES);
+    shake((uint8_t*)w->Sp, (2*PARAMS_N+PARAMS_NBAR)*PARAMS_NBAR*sizeof(uint16_t), shake_input_seedSEprime, 1 + CRYPTO_BYTES);
+    ok = frodo_dec_check(muprime, C, sk, w);
+
+    // ss = F(ct || k') if the ciphertext matches, F(ct || s) otherwise; ct is absorbed in place
+    shake_inc_init(&Fctx);
+    shake_inc_absorb(&Fctx, ct, CRYPTO_CIPHERTEXTBYTES);
+    shake_inc_absorb(&Fctx, ok ? kprime : sk_s, CRYPTO_BYTES);
+    shake_inc_finalize(&Fctx);
+    shake_inc_squeeze(ss, CRYPTO_BYTES, &Fctx);
+
+    // Cleanup:
     clear_bytes(muprime, BYTES_MU);
     clear_bytes(G2out, 2*CRYPTO_BYTES);
-    clear_bytes(Fin_k, CRYPTO_BYTES);
+    clear_bytes((uint8_t *)&Fctx, sizeof(Fctx));
     clear_bytes(shake_input_seedSEprime, 1 + CRYPTO_BYTES);
     return 0;
 }
+
+
+int crypto_kem_keypair(unsigned char* pk, unsigned char* sk)
+{
+    frodo_keypair_scratch w;
+
+    return frodo_keypair(pk, sk, &w);
+}
+
+
+int crypto_kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk)
+{
+    frodo_enc_scratch w;
+
+    return frodo_enc(ct, ss, pk, &w);
+}
+
+
+int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk)
+{
+    frodo_dec_scratch w;
+
+    return frodo_dec(ss, ct, sk, &w);
+}
+
+
+int crypto_kem_keypair_with_scratch(unsigned char* pk, unsigned char* sk, void *scratch)
+{ // crypto_kem_keypair with its large temporaries in scratch (crypto_kem_scratch_bytes() bytes, aligned as by malloc)
+    return frodo_keypair(pk, sk, &((frodo_scratch *)scratch)->keypair);
+}
+
+
+int crypto_kem_enc_with_scratch(unsigned char *ct, unsigned char *ss, const unsigned char *pk, void *scratch)
+{
+    return frodo_enc(ct, ss, pk, &((frodo_scratch *)scratch)->enc);
+}
+
+
+int crypto_kem_dec_with_scratch(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, void *scratch)
+{
+    return frodo_dec(ss, ct, sk, &((frodo_scratch *)scratch)->dec);
+}
+
+
+// Four instances at once: their SHAKE calls (seed expansion, noise, hashes) run through the four-way
+// Keccak of ../common/fips202x4.c, the matrix arithmetic one instance after the other
+typedef struct {
+    frodo_scratch w[4];
+    uint8_t Fin[4][CRYPTO_CIPHERTEXTBYTES + CRYPTO_BYTES];   // ct || k of F, contains secret data
+} frodo_batch_scratch;
+
+
+static void frodo_keypair_x4(unsigned char* pk, unsigned char* sk, frodo_batch_scratch *b)
+{ // frodo_keypair of four instances stored back to back
+    uint8_t randomness[4][2*CRYPTO_BYTES + BYTES_SEED_A];   // contains secret data
+    uint8_t shake_input_seedSE[4][1 + CRYPTO_BYTES];        // contains secret data
+    unsigned char *pkj[4], *skj[4];
+    int j;
+
+    for (j = 0; j < 4; j++) {
+        pkj[j] = pk + j*CRYPTO_PUBLICKEYBYTES;
+        skj[j] = sk + j*CRYPTO_SECRETKEYBYTES;
+        randombytes(randomness[j], CRYPTO_BYTES + CRYPTO_BYTES + BYTES_SEED_A);
+        shake_input_seedSE[j][0] = 0x5F;
+        memcpy(&shake_input_seedSE[j][1], &randomness[j][CRYPTO_BYTES], CRYPTO_BYTES);
+    }
+    shakex4(pkj[0], pkj[1], pkj[2], pkj[3], BYTES_SEED_A,
+            &randomness[0][2*CRYPTO_BYTES], &randomness[1][2*CRYPTO_BYTES], &randomness[2][2*CRYPTO_BYTES], &randomness[3][2*CRYPTO_BYTES], BYTES_SEED_A);
+    shakex4((uint8_t*)b->w[0].keypair.S, (uint8_t*)b->w[1].keypair.S, (uint8_t*)b->w[2].keypair.S, (uint8_t*)b->w[3].keypair.S,
+            2*PARAMS_N*PARAMS_NBAR*sizeof(uint16_t), shake_input_seedSE[0], shake_input_seedSE[1], shake_input_seedSE[2], shake_input_seedSE[3], 1 + CRYPTO_BYTES);
+
+    for (j = 0; j < 4; j++)
+        frodo_keypair_matrix(pkj[j], skj[j], randomness[j], &b->w[j].keypair);
+
+    // Add H(pk) to the secret keys
+    for (j = 0; j < 4; j++)
+        skj[j] += CRYPTO_BYTES + CRYPTO_PUBLICKEYBYTES + 2*PARAMS_N*PARAMS_NBAR;
+    shakex4(skj[0], skj[1], skj[2], skj[3], BYTES_PKHASH, pkj[0], pkj[1], pkj[2], pkj[3], CRYPTO_PUBLICKEYBYTES);
+
+    clear_bytes((uint8_t *)randomness, sizeof(randomness));
+    clear_bytes((uint8_t *)shake_input_seedSE, sizeof(shake_input_seedSE));
+}
+
+
+static void frodo_enc_x4(unsigned char *ct, unsigned char *ss, const unsigned char *pk, frodo_batch_scratch *b)
+{ // frodo_enc of four instances stored back to back
+    uint8_t G2in[4][BYTES_PKHASH + BYTES_MU];               // pkh || mu, contains secret data via mu
+    uint8_t G2out[4][2*CRYPTO_BYTES];                       // seedSE || k, contains secret data
+    uint8_t shake_input_seedSE[4][1 + CRYPTO_BYTES];        // contains secret data
+    const unsigned char *pkj[4];
+    unsigned char *ctj[4];
+    int j;
+
+    for (j = 0; j < 4; j++) {
+        pkj[j] = pk + j*CRYPTO_PUBLICKEYBYTES;
+        ctj[j] = ct + j*CRYPTO_CIPHERTEXTBYTES;
+    }
+
+    // pkh <- G_1(pk), generate random mu, compute (seedSE || k) = G_2(pkh || mu)
+    shakex4(G2in[0], G2in[1], G2in[2], G2in[3], BYTES_PKHASH, pkj[0], pkj[1], pkj[2], pkj[3], CRYPTO_PUBLICKEYBYTES);
+    for (j = 0; j < 4; j++)
+        randombytes(&G2in[j][BYTES_PKHASH], BYTES_MU);
+    shakex4(G2out[0], G2out[1], G2out[2], G2out[3], 2*CRYPTO_BYTES, G2in[0], G2in[1], G2in[2], G2in[3], BYTES_PKHASH + BYTES_MU);
+
+    // Expand seedSE, and compute the ciphertexts
+    for (j = 0; j < 4; j++) {
+        shake_input_seedSE[j][0] = 0x96;
+        memcpy(&shake_input_seedSE[j][1], G2out[j], CRYPTO_BYTES);
+    }
+    shakex4((uint8_t*)b->w[0].enc.Sp, (uint8_t*)b->w[1].enc.Sp, (uint8_t*)b->w[2].enc.Sp, (uint8_t*)b->w[3].enc.Sp,
+            (2*PARAMS_N+PARAMS_NBAR)*PARAMS_NBAR*sizeof(uint16_t), shake_input_seedSE[0], shake_input_seedSE[1], shake_input_seedSE[2], shake_input_seedSE[3], 1 + CRYPTO_BYTES);
+    for (j = 0; j < 4; j++) {
+        frodo_enc_matrix(ctj[j], &G2in[j][BYTES_PKHASH], pkj[j], &b->w[j].enc);
+        memcpy(b->Fin[j], ctj[j], CRYPTO_CIPHERTEXTBYTES);
+        memcpy(&b->Fin[j][CRYPTO_CIPHERTEXTBYTES], &G2out[j][CRYPTO_BYTES], CRYPTO_BYTES);
+    }
+
+    // Compute ss = F(ct||KK)
+    shakex4(ss, ss + CRYPTO_BYTES, ss + 2*CRYPTO_BYTES, ss + 3*CRYPTO_BYTES, CRYPTO_BYTES,
+            b->Fin[0], b->Fin[1], b->Fin[2], b->Fin[3], CRYPTO_CIPHERTEXTBYTES + CRYPTO_BYTES);
+
+    // Cleanup:
+    for (j = 0; j < 4; j++)
+        clear_bytes(&b->Fin[j][CRYPTO_CIPHERTEXTBYTES], CRYPTO_BYTES);
+    clear_bytes((uint8_t *)G2in, sizeof(G2in));
+    clear_bytes((uint8_t *)G2out, sizeof(G2out));
+    clear_bytes((uint8_t *)shake_input_seedSE, sizeof(shake_input_seedSE));
+}
+
+
+static void frodo_dec_x4(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, frodo_batch_scratch *b)
+{ // frodo_dec of four instances stored back to back
+    uint16_t C[4][PARAMS_NBAR*PARAMS_NBAR];
+    uint8_t G2in[4][BYTES_PKHASH + BYTES_MU];               // pkh || mu', contains secret data via mu'
+    uint8_t G2out[4][2*CRYPTO_BYTES];                       // seedSE' || k', contains secret data
+    uint8_t shake_input_seedSEprime[4][1 + CRYPTO_BYTES];   // contains secret data
+    const unsigned char *ctj[4], *skj[4];
+    int j, ok;
+
+    // Decode mu' of each instance, and compute (seedSE' || k') = G_2(pkh || mu')
+    for (j = 0; j < 4; j++) {
+        ctj[j] = ct + j*CRYPTO_CIPHERTEXTBYTES;
+        skj[j] = sk + j*CRYPTO_SECRETKEYBYTES;
+        frodo_dec_decode(&G2in[j][BYTES_PKHASH], C[j], ctj[j], skj[j], &b->w[j].dec);
+        memcpy(G2in[j], &skj[j][CRYPTO_BYTES + CRYPTO_PUBLICKEYBYTES + 2*PARAMS_N*PARAMS_NBAR], BYTES_PKHASH);
+    }
+    shakex4(G2out[0], G2out[1], G2out[2], G2out[3], 2*CRYPTO_BYTES, G2in[0], G2in[1], G2in[2], G2in[3], BYTES_PKHASH + BYTES_MU);
+
+    // Expand seedSE', and re-encrypt mu'
+    for (j = 0; j < 4; j++) {
+        shake_input_seedSEprime[j][0] = 0x96;
+        memcpy(&shake_input_seedSEprime[j][1], G2out[j], CRYPTO_BYTES);
+    }
+    shakex4((uint8_t*)b->w[0].dec.Sp, (uint8_t*)b->w[1].dec.Sp, (uint8_t*)b->w[2].dec.Sp, (uint8_t*)b->w[3].dec.Sp,
+            (2*PARAMS_N+PARAMS_NBAR)*PARAMS_NBAR*sizeof(uint16_t), shake_input_seedSEprime[0], shake_input_seedSEprime[1], shake_input_seedSEprime[2], shake_input_seedSEprime[3], 1 + CRYPTO_BYTES);
+    for (j = 0; j < 4; j++) {
+        ok = frodo_dec_check(&G2in[j][BYTES_PKHASH], C[j], skj[j], &b->w[j].dec);
+        memcpy(b->Fin[j], ctj[j], CRYPTO_CIPHERTEXTBYTES);
+        memcpy(&b->Fin[j][CRYPTO_CIPHERTEXTBYTES], ok ? &G2out[j][CRYPTO_BYTES] : skj[j], CRYPTO_BYTES);
+    }
+
+    // ss = F(ct || k') or F(ct || s)
+    shakex4(ss, ss + CRYPTO_BYTES, ss + 2*CRYPTO_BYTES, ss + 3*CRYPTO_BYTES, CRYPTO_BYTES,
+            b->Fin[0], b->Fin[1], b->Fin[2], b->Fin[3], CRYPTO_CIPHERTEXTBYTES + CRYPTO_BYTES);
+
+    // Cleanup:
+    for (j = 0; j < 4; j++)
+        clear_bytes(&b->Fin[j][CRYPTO_CIPHERTEXTBYTES], CRYPTO_BYTES);
+    clear_bytes((uint8_t *)G2in, sizeof(G2in));
+    clear_bytes((uint8_t *)G2out, sizeof(G2out));
+    clear_bytes((uint8_t *)shake_input_seedSEprime, sizeof(shake_input_seedSEprime));
+}
+
+
+// The batch entry points give the results of n calls of crypto_kem_* with the randomness drawn in the same
+// order. Their workspace for four instances is on the heap; without it, every instance is a single call.
+
+int crypto_kem_keypair_batch(unsigned char* pk, unsigned char* sk, size_t n)
+{
+    frodo_batch_scratch *b = n >= 4 ? malloc(sizeof(frodo_batch_scratch)) : NULL;
+    size_t i = 0;
+
+    for (; b != NULL && i + 4 <= n; i += 4)
+        frodo_keypair_x4(pk + i*CRYPTO_PUBLICKEYBYTES, sk + i*CRYPTO_SECRETKEYBYTES, b);
+    free(b);
+    for (; i < n; i++)
+        crypto_kem_keypair(pk + i*CRYPTO_PUBLICKEYBYTES, sk + i*CRYPTO_SECRETKEYBYTES);
+    return 0;
+}
+
+
+int crypto_kem_enc_batch(unsigned char *ct, unsigned char *ss, const unsigned char *pk, size_t n)
+{
+    frodo_batch_scratch *b = n >= 4 ? malloc(sizeof(frodo_batch_scratch)) : NULL;
+    size_t i = 0;
+
+    for (; b != NULL && i + 4 <= n; i += 4)
+        frodo_enc_x4(ct + i*CRYPTO_CIPHERTEXTBYTES, ss + i*CRYPTO_BYTES, pk + i*CRYPTO_PUBLICKEYBYTES, b);
+    free(b);
+    for (; i < n; i++)
+        crypto_kem_enc(ct + i*CRYPTO_CIPHERTEXTBYTES, ss + i*CRYPTO_BYTES, pk + i*CRYPTO_PUBLICKEYBYTES);
+    return 0;
+}
+
+
+int crypto_kem_dec_batch(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, size_t n)
+{
+    frodo_batch_scratch *b = n >= 4 ? malloc(sizeof(frodo_batch_scratch)) : NULL;
+    size_t i = 0;
+
+    for (; b != NULL && i + 4 <= n; i += 4)
+        frodo_dec_x4(ss + i*CRYPTO_BYTES, ct + i*CRYPTO_CIPHERTEXTBYTES, sk + i*CRYPTO_SECRETKEYBYTES, b);
+    free(b);
+    for (; i < n; i++)
+        crypto_kem_dec(ss + i*CRYPTO_BYTES, ct + i*CRYPTO_CIPHERTEXTBYTES, sk + i*CRYPTO_SECRETKEYBYTES);
+    return 0;
+}
@@ -0,0 +1,52 @@
+/********************************************************************************************
+* FrodoKEM: Learning with Errors Key Encapsulation
+*
+* Abstract: registry descriptor for FrodoKEM-640 (../common/qsiot_kem.h)
+*********************************************************************************************/
+
+#include "api.h"
+#include "qsiot_kem.h"
+
+#if defined(_AES128_FOR_A_)
+    #define QSIOT_FRODO_DESCRIPTOR  qsiot_kem_frodo640aes
+    #define QSIOT_FRODO_NAME        CRYPTO_ALGNAME "-AES"
+#elif defined(_SHAKE128_FOR_A_)
+    #define QSIOT_FRODO_DESCRIPTOR  qsiot_kem_frodo640shake
+    #define QSIOT_FRODO_NAME        CRYPTO_ALGNAME "-SHAKE"
+#endif
+
+
+// A from AES128 is the faster generator when the CPU has AES instructions, SHAKE128 otherwise
+static int frodo_preferred(void)
+{
+    int aesni = 0;
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    aesni = __builtin_cpu_supports("aes");
+#endif
+#if defined(_AES128_FOR_A_)
+    return aesni;
+#else
+    return !aesni;
+#endif
+}
+
+
+const qsiot_kem QSIOT_FRODO_DESCRIPTOR = {
+    .name = QSIOT_FRODO_NAME,
+    .family = CRYPTO_ALGNAME,
+    .publickeybytes = CRYPTO_PUBLICKEYBYTES,
+    .secretkeybytes = CRYPTO_SECRETKEYBYTES,
+    .ciphertextbytes = CRYPTO_CIPHERTEXTBYTES,
+    .bytes = CRYPTO_BYTES,
+    .keypair = crypto_kem_keypair,
+    .enc = crypto_kem_enc,
+    .dec = crypto_kem_dec,
+    .preferred = frodo_preferred,
+    .keypair_batch = crypto_kem_keypair_batch,
+    .enc_batch = crypto_kem_enc_batch,
+    .dec_batch = crypto_kem_dec_batch,
+    .scratch_bytes = crypto_kem_scratch_bytes,
+    .keypair_with_scratch = crypto_kem_keypair_with_scratch,
+    .enc_with_scratch = crypto_kem_enc_with_scratch,
+    .dec_with_scratch = crypto_kem_dec_with_scratch,
+};
@@ -0,0 +1,110 @@
+/********************************************************************************************
+* Persistent worker pool for splitting FrodoKEM's matrix products across cores
+*********************************************************************************************/ 
+
+#include "pool.h"
+
+#if defined(FRODO_THREADS) && FRODO_THREADS > 1
+
+#include <pthread.h>
+#include <stdint.h>
+
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t pool_run_lock = PTHREAD_MUTEX_INITIALIZER;   // One job at a time
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_start = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t pool_done = PTHREAD_COND_INITIALIZER;
+static void (*pool_fn)(void *arg, int w, int n);
+static void *pool_arg;
+static unsigned long pool_generation = 0;
+static int pool_pending = 0;
+static int pool_workers = 0;                                        // Workers actually started
+
+
+static void *pool_worker(void *p)
+{
+    int w = (int)(intptr_t)p;
+    unsigned long seen = 0;
+    void (*fn)(void *arg, int w, int n);
+    void *arg;
+
+    for (;;) {
+        pthread_mutex_lock(&pool_lock);
+        while (pool_generation == seen) {
+            pthread_cond_wait(&pool_start, &pool_lock);
+        }
+        seen = pool_generation;
+        fn = pool_fn;
+        arg = pool_arg;
+        pthread_mutex_unlock(&pool_lock);
+
+        fn(arg, w, FRODO_THREADS);
+
+        pthread_mutex_lock(&pool_lock);
+        if (--pool_pending == 0) {
+            pthread_cond_signal(&pool_done);
+        }
+        pthread_mutex_unlock(&pool_lock);
+    }
+    return NULL;
+}
+
+
+static void pool_start_workers(void)
+{
+    pthread_attr_t attr;
+    pthread_t t;
+    int w;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    for (w = 1; w < FRODO_THREADS; w++) {
+        if (pthread_create(&t, &attr, pool_worker, (void *)(intptr_t)w) != 0) {
+            break;
+        }
+        pool_workers++;
+    }
+    pthread_attr_destroy(&attr);
+}
+
+
+void frodo_pool_run(void (*fn)(void *arg, int w, int n), void *arg)
+{
+    int w;
+
+    pthread_once(&pool_once, pool_start_workers);
+    pthread_mutex_lock(&pool_run_lock);
+
+    if (pool_workers == FRODO_THREADS - 1) {
+        pthread_mutex_lock(&pool_lock);
+        pool_fn = fn;
+        pool_arg = arg;
+        pool_pending = FRODO_THREADS - 1;
+        pool_generation++;
+        pthread_cond_broadcast(&pool_start);
+        pthread_mutex_unlock(&pool_lock);
+
+        fn(arg, 0, FRODO_THREADS);
+
+        pthread_mutex_lock(&pool_lock);
+        while (pool_pending > 0) {
+            pthread_cond_wait(&pool_done, &pool_lock);
+        }
+        pthread_mutex_unlock(&pool_lock);
+    } else {
+        for (w = 0; w < FRODO_THREADS; w++) {                       // Not every worker could be started
+            fn(arg, w, FRODO_THREADS);
+        }
+    }
+
+    pthread_mutex_unlock(&pool_run_lock);
+}
+
+#else
+
+void frodo_pool_run(void (*fn)(void *arg, int w, int n), void *arg)
+{
+    fn(arg, 0, 1);
+}
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef __POOL_H__
+#define __POOL_H__
+
+
+// Persistent worker pool used when the library is built with THREADS=n (FRODO_THREADS = n > 1).
+// frodo_pool_run calls fn(arg, w, n) once for every w = 0, ..., n-1, all in parallel:
+// w = 0 on the calling thread and the others on workers started on first use.
+// Calls from several threads are serialized. If workers cannot be started, every
+// slice runs on the calling thread.
+void frodo_pool_run(void (*fn)(void *arg, int w, int n), void *arg);
+
+
+#endif
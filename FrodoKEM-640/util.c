@@ -6,13 +6,109 @@
 
 #include <string.h>
 #include "frodo_macrify.h"
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#endif
 
 #define min(x, y) (((x) < (y)) ? (x) : (y))
 
 
+// 15-bit packing (lsb = PARAMS_LOGQ for FrodoKEM-640), used for B, B' and C.
+// Eight values make exactly 15 bytes: the bit string v0 || v1 || ... || v7, most significant
+// bit first, is split into two 60-bit halves that are written as big-endian bytes.
+
+static void frodo_pack_15(unsigned char *out, const uint16_t *in, size_t nblocks)
+{ // Pack nblocks groups of 8 values into 15 bytes each
+    size_t i, k;
+
+#if defined(__AVX2__)
+    const __m256i mask15 = _mm256_set1_epi32(0x7FFF);
+    const __m256i mask32 = _mm256_set1_epi64x(0xFFFFFFFF);
+    // Bytes of (v0..v3) << 4 and of (v4..v7), reversed into big-endian order; the top nibble of
+    // the second half goes into the low nibble of byte 7
+    const __m256i rev = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 14, 13, 12, 11, 10, 9, 8, -1,
+                                         7, 6, 5, 4, 3, 2, 1, 0, 14, 13, 12, 11, 10, 9, 8, -1);
+    const __m256i nib = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, 15, -1, -1, -1, -1, -1, -1, -1, -1,
+                                         -1, -1, -1, -1, -1, -1, -1, 15, -1, -1, -1, -1, -1, -1, -1, -1);
+    __m256i x, hi, lo;
+
+    // Two groups per iteration; each 16-byte store overwrites one byte beyond its group, so the last
+    // group is left for the scalar loop
+    for (; nblocks > 2; nblocks -= 2, in += 16, out += 30) {
+        x = _mm256_loadu_si256((const __m256i*)in);
+        x = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(x, mask15), 15), _mm256_and_si256(_mm256_srli_epi32(x, 16), mask15));   // v0 || v1 in 30 bits
+        x = _mm256_or_si256(_mm256_slli_epi64(_mm256_and_si256(x, mask32), 30), _mm256_srli_epi64(x, 32));                               // v0 || ... || v3 in 60 bits
+        hi = _mm256_blend_epi32(_mm256_slli_epi64(x, 4), x, 0xCC);
+        lo = _mm256_shuffle_epi8(hi, nib);
+        x = _mm256_or_si256(_mm256_shuffle_epi8(hi, rev), lo);
+        _mm_storeu_si128((__m128i*)out, _mm256_castsi256_si128(x));
+        _mm_storeu_si128((__m128i*)(out + 15), _mm256_extracti128_si256(x, 1));
+    }
+#endif
+    for (i = 0; i < nblocks; i++, in += 8, out += 15) {
+        uint64_t hi = 0, lo = 0;
+        for (k = 0; k < 4; k++) {
+            hi = (hi << 15) | (in[k] & 0x7FFF);
+            lo = (lo << 15) | (in[k + 4] & 0x7FFF);
+        }
+        for (k = 0; k < 7; k++) {
+            out[k] = (unsigned char)(hi >> (52 - 8*k));
+            out[k + 8] = (unsigned char)(lo >> (48 - 8*k));
+        }
+        out[7] = (unsigned char)((hi << 4) | (lo >> 56));
+    }
+}
+
+
+static void frodo_unpack_15(uint16_t *out, const unsigned char *in, size_t nblocks)
+{ // Unpack nblocks groups of 15 bytes into 8 values each
+    size_t i, k;
+
+#if defined(__AVX2__)
+    const __m256i mask15 = _mm256_set1_epi32(0x7FFF);
+    const __m256i mask30 = _mm256_set1_epi64x(0x3FFFFFFF);
+    const __m256i mask60 = _mm256_set1_epi64x(0x0FFFFFFFFFFFFFFFULL);
+    // Bytes 0..7 and 7..14 of a group as two big-endian 64-bit words
+    const __m256i rev = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 14, 13, 12, 11, 10, 9, 8, 7,
+                                         7, 6, 5, 4, 3, 2, 1, 0, 14, 13, 12, 11, 10, 9, 8, 7);
+    __m256i x;
+
+    // Two groups per iteration; each 16-byte load reads one byte beyond its group, so the last
+    // group is left for the scalar loop
+    for (; nblocks > 2; nblocks -= 2, in += 30, out += 16) {
+        x = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)in)), _mm_loadu_si128((const __m128i*)(in + 15)), 1);
+        x = _mm256_shuffle_epi8(x, rev);
+        x = _mm256_blend_epi32(_mm256_srli_epi64(x, 4), _mm256_and_si256(x, mask60), 0xCC);                                          // v0 || ... || v3 in 60 bits
+        x = _mm256_or_si256(_mm256_srli_epi64(x, 30), _mm256_slli_epi64(_mm256_and_si256(x, mask30), 32));                         // v0 || v1 in 30 bits
+        x = _mm256_or_si256(_mm256_srli_epi32(x, 15), _mm256_slli_epi32(_mm256_and_si256(x, mask15), 16));
+        _mm256_storeu_si256((__m256i*)out, x);
+    }
+#endif
+    for (i = 0; i < nblocks; i++, in += 15, out += 8) {
+        uint64_t hi = 0, lo = 0;
+        for (k = 0; k < 8; k++) {
+            hi = (hi << 8) | in[k];
+            lo = (lo << 8) | in[k + 7];
+        }
+        hi >>= 4;
+        lo &= 0x0FFFFFFFFFFFFFFFULL;
+        for (k = 0; k < 4; k++) {
+            out[3 - k] = (uint16_t)(hi & 0x7FFF);
+            out[7 - k] = (uint16_t)(lo & 0x7FFF);
+            hi >>= 15;
+            lo >>= 15;
+        }
+    }
+}
+
+
 void frodo_pack(unsigned char *out, const size_t outlen, const uint16_t *in, const size_t inlen, const unsigned char lsb) 
 { // Pack the input uint16 vector into a char output vector, copying lsb bits from each input element. 
   // If inlen * lsb / 8 > outlen, only outlen * 8 bits are copied.
+    if (lsb == 15 && inlen % 8 == 0 && outlen == inlen / 8 * 15) {
+        frodo_pack_15(out, in, inlen / 8);
+        return;
+    }
     memset(out, 0, outlen);
 
     size_t i = 0;            // whole bytes already filled in
@@ -62,6 +158,10 @@ void frodo_pack(unsigned char *out, const size_t outlen, const uint16_t *in, con
 void frodo_unpack(uint16_t *out, const size_t outlen, const unsigned char *in, const size_t inlen, const unsigned char lsb) 
 { // Unpack the input char vector into a uint16_t output vector, copying lsb bits
   // for each output element from input. outlen must be at least ceil(inlen * 8 / lsb).
+    if (lsb == 15 && outlen % 8 == 0 && inlen == outlen / 8 * 15) {
+        frodo_unpack_15(out, in, outlen / 8);
+        return;
+    }
     memset(out, 0, outlen * sizeof(uint16_t));
 
     size_t i = 0;            // whole uint16_t already filled in
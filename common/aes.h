@@ -0,0 +1,28 @@
+#ifndef AES_H
+#define AES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Expanded key. rk holds the AES-NI round keys, sk_exp the bitsliced ones; */
+/* only the set matching the backend picked at key expansion is filled.     */
+typedef struct {
+    unsigned char rk[15*16];
+    uint64_t sk_exp[120];
+    int nrounds;
+    int aesni;
+} aes_ctx;
+
+void aes128_keyexp(aes_ctx *ctx, const unsigned char *key);
+void aes256_keyexp(aes_ctx *ctx, const unsigned char *key);
+
+/* Encrypt nblocks 16-byte blocks */
+void aes_ecb(unsigned char *out, const unsigned char *in, size_t nblocks, const aes_ctx *ctx);
+
+/* outlen bytes of CTR keystream; iv is the initial 128-bit big-endian counter block */
+void aes_ctr(unsigned char *out, size_t outlen, const unsigned char *iv, const aes_ctx *ctx);
+
+/* Wipes the round keys (qsiot_wipe) */
+void aes_ctx_clear(aes_ctx *ctx);
+
+#endif
@@ -0,0 +1,109 @@
+// Based on supercop-20190110/crypto_sort/int32/portable3, with an AVX2
+// path that performs the same comparator network eight lanes at a time.
+
+#include <stdint.h>
+#include "crypto_sort.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#define int32_MINMAX(a,b) \
+do { \
+  int32_t ab = (a) ^ (b); \
+  int64_t c = (int64_t)(b) - (int64_t)(a); \
+  ab &= (int32_t)(c >> 63); \
+  a ^= ab; \
+  b ^= ab; \
+} while(0)
+
+#ifdef __AVX2__
+/* Comparators (i,i+p) for i&p == 0 inside the block x[0..7], p < 8 */
+static inline void minmax_inblock(int32_t *x, __m256i idx, __m256i hi)
+{
+  __m256i v = _mm256_loadu_si256((__m256i *) x);
+  __m256i w = _mm256_permutevar8x32_epi32(v, idx);
+  __m256i mn = _mm256_min_epi32(v, w);
+  __m256i mx = _mm256_max_epi32(v, w);
+  _mm256_storeu_si256((__m256i *) x, _mm256_blendv_epi8(mn, mx, hi));
+}
+
+/* Comparators (i+p,i+q) for i&p == 0, i in block x[0..7], p < 8 <= q */
+static inline void minmax_crossblock(int32_t *x, long long q, __m256i idx, __m256i hi)
+{
+  __m256i v = _mm256_loadu_si256((__m256i *) x);
+  __m256i w = _mm256_loadu_si256((__m256i *) (x + q));
+  __m256i wp = _mm256_permutevar8x32_epi32(w, idx);
+  __m256i mn = _mm256_min_epi32(v, wp);
+  __m256i mx = _mm256_permutevar8x32_epi32(_mm256_max_epi32(v, wp), idx);
+  _mm256_storeu_si256((__m256i *) x, _mm256_blendv_epi8(v, mn, hi));
+  _mm256_storeu_si256((__m256i *) (x + q), _mm256_blendv_epi8(mx, w, hi));
+}
+
+/* Comparators (a[j],b[j]) for j = 0..7 */
+static inline void minmax_vec(int32_t *a, int32_t *b)
+{
+  __m256i x = _mm256_loadu_si256((__m256i *) a);
+  __m256i y = _mm256_loadu_si256((__m256i *) b);
+  _mm256_storeu_si256((__m256i *) a, _mm256_min_epi32(x, y));
+  _mm256_storeu_si256((__m256i *) b, _mm256_max_epi32(x, y));
+}
+#endif
+
+void crypto_sort_int32(int32_t *x, long long n)
+{
+  long long top,p,q,i;
+#ifdef __AVX2__
+  const __m256i lane = _mm256_setr_epi32(0,1,2,3,4,5,6,7);
+  __m256i idx, hi;
+#endif
+
+  if (n < 2) return;
+  top = 1;
+  while (top < n - top) top += top;
+
+  for (p = top;p > 0;p >>= 1) {
+    i = 0;
+#ifdef __AVX2__
+    /* Handle whole blocks of 8 indices; the scalar loops finish the tail */
+    idx = _mm256_xor_si256(lane, _mm256_set1_epi32((int32_t) (p & 7)));
+    hi = _mm256_cmpgt_epi32(_mm256_and_si256(lane, _mm256_set1_epi32((int32_t) (p & 7))), _mm256_setzero_si256());
+    for (;i + 8 <= n - p;i += 8) {
+      if (p >= 8) {
+        if (!(i & p)) minmax_vec(x + i,x + i + p);
+      }
+      else
+        minmax_inblock(x + i,idx,hi);
+    }
+#endif
+    for (;i < n - p;++i)
+      if (!(i & p))
+        int32_MINMAX(x[i],x[i+p]);
+
+    for (q = top;q > p;q >>= 1) {
+      i = 0;
+#ifdef __AVX2__
+      if (q >= 8) {
+        for (;i + 8 <= n - q;i += 8) {
+          if (p >= 8) {
+            if (!(i & p)) minmax_vec(x + i + p,x + i + q);
+          }
+          else
+            minmax_crossblock(x + i,q,idx,hi);
+        }
+      }
+#endif
+      for (;i < n - q;++i)
+        if (!(i & p))
+          int32_MINMAX(x[i+p],x[i+q]);
+    }
+  }
+}
+
+void crypto_sort_uint32(uint32_t *x, long long n)
+{
+  long long j;
+
+  for (j = 0;j < n;++j) x[j] ^= 0x80000000;
+  crypto_sort_int32((int32_t *) x,n);
+  for (j = 0;j < n;++j) x[j] ^= 0x80000000;
+}
@@ -0,0 +1,13 @@
+#ifndef CRYPTO_SORT_H
+#define CRYPTO_SORT_H
+
+#include <stdint.h>
+
+/* Constant-time sorting networks shared by the NTRU samplers. */
+/* The AVX2 network is used when compiled with -mavx2, otherwise */
+/* the portable one.                                             */
+
+void crypto_sort_int32(int32_t *x, long long n);
+void crypto_sort_uint32(uint32_t *x, long long n);
+
+#endif
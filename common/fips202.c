@@ -0,0 +1,832 @@
+/* SHA-3 and SHAKE (FIPS 202) shared by the KEMs.
+ *
+ * Based on the public domain implementation in
+ * crypto_hash/keccakc512/simple/ from http://bench.cr.yp.to/supercop.html
+ * by Ronny Van Keer
+ * and the public domain "TweetFips202" implementation
+ * from https://twitter.com/tweetfips202
+ * by Gilles Van Assche, Daniel J. Bernstein, and Peter Schwabe.
+ * The lane complementing permutation follows KeccakP-1600-opt64 from the
+ * Keccak Code Package (public domain). */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fips202.h"
+
+#define NROUNDS 24
+#define ROL(a, offset) ((a << offset) ^ (a >> (64-offset)))
+
+/*************************************************
+* Name:        load64
+*
+* Description: Load 8 bytes into uint64_t in little-endian order
+*
+* Arguments:   - const unsigned char *x: pointer to input byte array
+*
+* Returns the loaded 64-bit unsigned integer
+**************************************************/
+static uint64_t load64(const unsigned char *x)
+{
+  unsigned long long r = 0, i;
+
+  for (i = 0; i < 8; ++i) {
+    r |= (unsigned long long)x[i] << 8 * i;
+  }
+  return r;
+}
+
+/*************************************************
+* Name:        store64
+*
+* Description: Store a 64-bit integer to a byte array in little-endian order
+*
+* Arguments:   - uint8_t *x: pointer to the output byte array
+*              - uint64_t u: input 64-bit unsigned integer
+**************************************************/
+static void store64(uint8_t *x, uint64_t u)
+{
+  unsigned int i;
+
+  for(i=0; i<8; ++i) {
+    x[i] = u;
+    u >>= 8;
+  }
+}
+
+/* Keccak round constants */
+static const uint64_t KeccakF_RoundConstants[NROUNDS] =
+{
+    (uint64_t)0x0000000000000001ULL,
+    (uint64_t)0x0000000000008082ULL,
+    (uint64_t)0x800000000000808aULL,
+    (uint64_t)0x8000000080008000ULL,
+    (uint64_t)0x000000000000808bULL,
+    (uint64_t)0x0000000080000001ULL,
+    (uint64_t)0x8000000080008081ULL,
+    (uint64_t)0x8000000000008009ULL,
+    (uint64_t)0x000000000000008aULL,
+    (uint64_t)0x0000000000000088ULL,
+    (uint64_t)0x0000000080008009ULL,
+    (uint64_t)0x000000008000000aULL,
+    (uint64_t)0x000000008000808bULL,
+    (uint64_t)0x800000000000008bULL,
+    (uint64_t)0x8000000000008089ULL,
+    (uint64_t)0x8000000000008003ULL,
+    (uint64_t)0x8000000000008002ULL,
+    (uint64_t)0x8000000000000080ULL,
+    (uint64_t)0x000000000000800aULL,
+    (uint64_t)0x800000008000000aULL,
+    (uint64_t)0x8000000080008081ULL,
+    (uint64_t)0x8000000000008080ULL,
+    (uint64_t)0x0000000080000001ULL,
+    (uint64_t)0x8000000080008008ULL
+};
+
+/* With the lane complementing transform the lanes at positions 1, 2, 8, 12,
+ * 17 and 20 are kept complemented during the permutation, which turns all
+ * but five of the 25 NOTs of chi in a round into plain AND/OR (see "Keccak
+ * implementation overview", sec. 2.2). It only pays off where there is no
+ * and-not instruction: x86 with BMI1 (andn) and ARM (bic) run the plain
+ * chi in one instruction per lane. */
+#if !defined(__BMI__) && !defined(__arm__) && !defined(__aarch64__)
+#define KECCAK_LANE_COMPLEMENTING
+#endif
+
+#ifdef KECCAK_LANE_COMPLEMENTING
+#define LC(x) (~(x))
+#else
+#define LC(x) (x)
+#endif
+
+/* One round from the state in A into E */
+#ifdef KECCAK_LANE_COMPLEMENTING
+#define KECCAK_ROUND(A, E, i) \
+        BCa = A##ba^A##ga^A##ka^A##ma^A##sa; \
+        BCe = A##be^A##ge^A##ke^A##me^A##se; \
+        BCi = A##bi^A##gi^A##ki^A##mi^A##si; \
+        BCo = A##bo^A##go^A##ko^A##mo^A##so; \
+        BCu = A##bu^A##gu^A##ku^A##mu^A##su; \
+        Da = BCu^ROL(BCe, 1); \
+        De = BCa^ROL(BCi, 1); \
+        Di = BCe^ROL(BCo, 1); \
+        Do = BCi^ROL(BCu, 1); \
+        Du = BCo^ROL(BCa, 1); \
+        A##ba ^= Da; \
+        BCa = A##ba; \
+        A##ge ^= De; \
+        BCe = ROL(A##ge, 44); \
+        A##ki ^= Di; \
+        BCi = ROL(A##ki, 43); \
+        A##mo ^= Do; \
+        BCo = ROL(A##mo, 21); \
+        A##su ^= Du; \
+        BCu = ROL(A##su, 14); \
+        E##ba = BCa ^ (BCe | BCi); \
+        E##ba ^= KeccakF_RoundConstants[i]; \
+        E##be = BCe ^ ((~BCi) | BCo); \
+        E##bi = BCi ^ (BCo & BCu); \
+        E##bo = BCo ^ (BCu | BCa); \
+        E##bu = BCu ^ (BCa & BCe); \
+        A##bo ^= Do; \
+        BCa = ROL(A##bo, 28); \
+        A##gu ^= Du; \
+        BCe = ROL(A##gu, 20); \
+        A##ka ^= Da; \
+        BCi = ROL(A##ka, 3); \
+        A##me ^= De; \
+        BCo = ROL(A##me, 45); \
+        A##si ^= Di; \
+        BCu = ROL(A##si, 61); \
+        E##ga = BCa ^ (BCe | BCi); \
+        E##ge = BCe ^ (BCi & BCo); \
+        E##gi = BCi ^ (BCo | (~BCu)); \
+        E##go = BCo ^ (BCu | BCa); \
+        E##gu = BCu ^ (BCa & BCe); \
+        A##be ^= De; \
+        BCa = ROL(A##be, 1); \
+        A##gi ^= Di; \
+        BCe = ROL(A##gi, 6); \
+        A##ko ^= Do; \
+        BCi = ROL(A##ko, 25); \
+        A##mu ^= Du; \
+        BCo = ROL(A##mu, 8); \
+        A##sa ^= Da; \
+        BCu = ROL(A##sa, 18); \
+        E##ka = BCa ^ (BCe | BCi); \
+        E##ke = BCe ^ (BCi & BCo); \
+        E##ki = BCi ^ ((~BCo) & BCu); \
+        E##ko = (~BCo) ^ (BCu | BCa); \
+        E##ku = BCu ^ (BCa & BCe); \
+        A##bu ^= Du; \
+        BCa = ROL(A##bu, 27); \
+        A##ga ^= Da; \
+        BCe = ROL(A##ga, 36); \
+        A##ke ^= De; \
+        BCi = ROL(A##ke, 10); \
+        A##mi ^= Di; \
+        BCo = ROL(A##mi, 15); \
+        A##so ^= Do; \
+        BCu = ROL(A##so, 56); \
+        E##ma = BCa ^ (BCe & BCi); \
+        E##me = BCe ^ (BCi | BCo); \
+        E##mi = BCi ^ ((~BCo) | BCu); \
+        E##mo = (~BCo) ^ (BCu & BCa); \
+        E##mu = BCu ^ (BCa | BCe); \
+        A##bi ^= Di; \
+        BCa = ROL(A##bi, 62); \
+        A##go ^= Do; \
+        BCe = ROL(A##go, 55); \
+        A##ku ^= Du; \
+        BCi = ROL(A##ku, 39); \
+        A##ma ^= Da; \
+        BCo = ROL(A##ma, 41); \
+        A##se ^= De; \
+        BCu = ROL(A##se, 2); \
+        E##sa = BCa ^ ((~BCe) & BCi); \
+        E##se = (~BCe) ^ (BCi | BCo); \
+        E##si = BCi ^ (BCo & BCu); \
+        E##so = BCo ^ (BCu | BCa); \
+        E##su = BCu ^ (BCa & BCe);
+#else
+#define KECCAK_ROUND(A, E, i) \
+        BCa = A##ba^A##ga^A##ka^A##ma^A##sa; \
+        BCe = A##be^A##ge^A##ke^A##me^A##se; \
+        BCi = A##bi^A##gi^A##ki^A##mi^A##si; \
+        BCo = A##bo^A##go^A##ko^A##mo^A##so; \
+        BCu = A##bu^A##gu^A##ku^A##mu^A##su; \
+        Da = BCu^ROL(BCe, 1); \
+        De = BCa^ROL(BCi, 1); \
+        Di = BCe^ROL(BCo, 1); \
+        Do = BCi^ROL(BCu, 1); \
+        Du = BCo^ROL(BCa, 1); \
+        A##ba ^= Da; \
+        BCa = A##ba; \
+        A##ge ^= De; \
+        BCe = ROL(A##ge, 44); \
+        A##ki ^= Di; \
+        BCi = ROL(A##ki, 43); \
+        A##mo ^= Do; \
+        BCo = ROL(A##mo, 21); \
+        A##su ^= Du; \
+        BCu = ROL(A##su, 14); \
+        E##ba = BCa ^ ((~BCe) & BCi); \
+        E##ba ^= KeccakF_RoundConstants[i]; \
+        E##be = BCe ^ ((~BCi) & BCo); \
+        E##bi = BCi ^ ((~BCo) & BCu); \
+        E##bo = BCo ^ ((~BCu) & BCa); \
+        E##bu = BCu ^ ((~BCa) & BCe); \
+        A##bo ^= Do; \
+        BCa = ROL(A##bo, 28); \
+        A##gu ^= Du; \
+        BCe = ROL(A##gu, 20); \
+        A##ka ^= Da; \
+        BCi = ROL(A##ka, 3); \
+        A##me ^= De; \
+        BCo = ROL(A##me, 45); \
+        A##si ^= Di; \
+        BCu = ROL(A##si, 61); \
+        E##ga = BCa ^ ((~BCe) & BCi); \
+        E##ge = BCe ^ ((~BCi) & BCo); \
+        E##gi = BCi ^ ((~BCo) & BCu); \
+        E##go = BCo ^ ((~BCu) & BCa); \
+        E##gu = BCu ^ ((~BCa) & BCe); \
+        A##be ^= De; \
+        BCa = ROL(A##be, 1); \
+        A##gi ^= Di; \
+        BCe = ROL(A##gi, 6); \
+        A##ko ^= Do; \
+        BCi = ROL(A##ko, 25); \
+        A##mu ^= Du; \
+        BCo = ROL(A##mu, 8); \
+        A##sa ^= Da; \
+        BCu = ROL(A##sa, 18); \
+        E##ka = BCa ^ ((~BCe) & BCi); \
+        E##ke = BCe ^ ((~BCi) & BCo); \
+        E##ki = BCi ^ ((~BCo) & BCu); \
+        E##ko = BCo ^ ((~BCu) & BCa); \
+        E##ku = BCu ^ ((~BCa) & BCe); \
+        A##bu ^= Du; \
+        BCa = ROL(A##bu, 27); \
+        A##ga ^= Da; \
+        BCe = ROL(A##ga, 36); \
+        A##ke ^= De; \
+        BCi = ROL(A##ke, 10); \
+        A##mi ^= Di; \
+        BCo = ROL(A##mi, 15); \
+        A##so ^= Do; \
+        BCu = ROL(A##so, 56); \
+        E##ma = BCa ^ ((~BCe) & BCi); \
+        E##me = BCe ^ ((~BCi) & BCo); \
+        E##mi = BCi ^ ((~BCo) & BCu); \
+        E##mo = BCo ^ ((~BCu) & BCa); \
+        E##mu = BCu ^ ((~BCa) & BCe); \
+        A##bi ^= Di; \
+        BCa = ROL(A##bi, 62); \
+        A##go ^= Do; \
+        BCe = ROL(A##go, 55); \
+        A##ku ^= Du; \
+        BCi = ROL(A##ku, 39); \
+        A##ma ^= Da; \
+        BCo = ROL(A##ma, 41); \
+        A##se ^= De; \
+        BCu = ROL(A##se, 2); \
+        E##sa = BCa ^ ((~BCe) & BCi); \
+        E##se = BCe ^ ((~BCi) & BCo); \
+        E##si = BCi ^ ((~BCo) & BCu); \
+        E##so = BCo ^ ((~BCu) & BCa); \
+        E##su = BCu ^ ((~BCa) & BCe);
+#endif
+
+/*************************************************
+* Name:        KeccakF1600_StatePermute
+*
+* Description: The Keccak F1600 Permutation
+*
+* Arguments:   - uint64_t * state: pointer to in/output Keccak state
+**************************************************/
+void KeccakF1600_StatePermute(uint64_t * state)
+{
+  uint64_t Aba, Abe, Abi, Abo, Abu;
+  uint64_t Aga, Age, Agi, Ago, Agu;
+  uint64_t Aka, Ake, Aki, Ako, Aku;
+  uint64_t Ama, Ame, Ami, Amo, Amu;
+  uint64_t Asa, Ase, Asi, Aso, Asu;
+  uint64_t Eba, Ebe, Ebi, Ebo, Ebu;
+  uint64_t Ega, Ege, Egi, Ego, Egu;
+  uint64_t Eka, Eke, Eki, Eko, Eku;
+  uint64_t Ema, Eme, Emi, Emo, Emu;
+  uint64_t Esa, Ese, Esi, Eso, Esu;
+  uint64_t BCa, BCe, BCi, BCo, BCu;
+  uint64_t Da, De, Di, Do, Du;
+  int round;
+
+  Aba = state[ 0];
+  Abe = LC(state[ 1]);
+  Abi = LC(state[ 2]);
+  Abo = state[ 3];
+  Abu = state[ 4];
+  Aga = state[ 5];
+  Age = state[ 6];
+  Agi = state[ 7];
+  Ago = LC(state[ 8]);
+  Agu = state[ 9];
+  Aka = state[10];
+  Ake = state[11];
+  Aki = LC(state[12]);
+  Ako = state[13];
+  Aku = state[14];
+  Ama = state[15];
+  Ame = state[16];
+  Ami = LC(state[17]);
+  Amo = state[18];
+  Amu = state[19];
+  Asa = LC(state[20]);
+  Ase = state[21];
+  Asi = state[22];
+  Aso = state[23];
+  Asu = state[24];
+
+  for (round = 0; round < NROUNDS; round += 2)
+  {
+    KECCAK_ROUND(A, E, round)
+    KECCAK_ROUND(E, A, round + 1)
+  }
+
+  state[ 0] = Aba;
+  state[ 1] = LC(Abe);
+  state[ 2] = LC(Abi);
+  state[ 3] = Abo;
+  state[ 4] = Abu;
+  state[ 5] = Aga;
+  state[ 6] = Age;
+  state[ 7] = Agi;
+  state[ 8] = LC(Ago);
+  state[ 9] = Agu;
+  state[10] = Aka;
+  state[11] = Ake;
+  state[12] = LC(Aki);
+  state[13] = Ako;
+  state[14] = Aku;
+  state[15] = Ama;
+  state[16] = Ame;
+  state[17] = LC(Ami);
+  state[18] = Amo;
+  state[19] = Amu;
+  state[20] = LC(Asa);
+  state[21] = Ase;
+  state[22] = Asi;
+  state[23] = Aso;
+  state[24] = Asu;
+}
+
+/*************************************************
+* Name:        keccak_absorb
+*
+* Description: Absorb step of Keccak;
+*              non-incremental, starts by zeroeing the state.
+*
+* Arguments:   - uint64_t *s:             pointer to (uninitialized) output Keccak state
+*              - unsigned int r:          rate in bytes (e.g., 168 for SHAKE128)
+*              - const unsigned char *m:  pointer to input to be absorbed into s
+*              - unsigned long long mlen: length of input in bytes
+*              - unsigned char p:         domain-separation byte for different Keccak-derived functions
+**************************************************/
+static void keccak_absorb(uint64_t *s,
+                          unsigned int r,
+                          const unsigned char *m, unsigned long long int mlen,
+                          unsigned char p)
+{
+  unsigned long long i;
+  unsigned char t[200];
+
+  // Zero state
+  for (i = 0; i < 25; ++i)
+    s[i] = 0;
+
+  while (mlen >= r)
+  {
+    for (i = 0; i < r / 8; ++i)
+      s[i] ^= load64(m + 8 * i);
+
+    KeccakF1600_StatePermute(s);
+    mlen -= r;
+    m += r;
+  }
+
+  for (i = 0; i < r; ++i)
+    t[i] = 0;
+  for (i = 0; i < mlen; ++i)
+    t[i] = m[i];
+  t[i] = p;
+  t[r - 1] |= 128;
+  for (i = 0; i < r / 8; ++i)
+    s[i] ^= load64(t + 8 * i);
+}
+
+
+/*************************************************
+* Name:        keccak_squeezeblocks
+*
+* Description: Squeeze step of Keccak. Squeezes full blocks of r bytes each.
+*              Modifies the state. Can be called multiple times to keep squeezing,
+*              i.e., is incremental.
+*
+* Arguments:   - unsigned char *h:               pointer to output blocks
+*              - unsigned long long int nblocks: number of blocks to be squeezed (written to h)
+*              - uint64_t *s:                    pointer to in/output Keccak state
+*              - unsigned int r:                 rate in bytes (e.g., 168 for SHAKE128)
+**************************************************/
+static void keccak_squeezeblocks(unsigned char *h, unsigned long long int nblocks,
+                                 uint64_t *s,
+                                 unsigned int r)
+{
+  unsigned int i;
+  while(nblocks > 0)
+  {
+    KeccakF1600_StatePermute(s);
+    for(i=0;i<(r>>3);i++)
+    {
+      store64(h+8*i, s[i]);
+    }
+    h += r;
+    nblocks--;
+  }
+}
+
+
+/*************************************************
+* Name:        keccak_inc_absorb
+*
+* Description: Incremental absorb step of Keccak. Can be called any number of
+*              times with inputs of any length; a block is permuted as soon as
+*              it is full.
+*
+* Arguments:   - keccak_incctx *ctx:      pointer to in/output incremental state
+*              - unsigned int r:          rate in bytes (e.g., 168 for SHAKE128)
+*              - const unsigned char *m:  pointer to input to be absorbed
+*              - unsigned long long mlen: length of input in bytes
+**************************************************/
+static void keccak_inc_absorb(keccak_incctx *ctx, unsigned int r,
+                              const unsigned char *m, unsigned long long mlen)
+{
+  unsigned int pos = ctx->pos;
+
+  /* Bytes up to a word boundary, then whole words, then the tail */
+  while(mlen > 0 && (pos & 7))
+  {
+    ctx->s[pos >> 3] ^= (uint64_t)*m++ << 8 * (pos & 7);
+    mlen--;
+    if(++pos == r)
+    {
+      KeccakF1600_StatePermute(ctx->s);
+      pos = 0;
+    }
+  }
+  while(mlen >= 8)
+  {
+    ctx->s[pos >> 3] ^= load64(m);
+    m += 8;
+    mlen -= 8;
+    pos += 8;
+    if(pos == r)
+    {
+      KeccakF1600_StatePermute(ctx->s);
+      pos = 0;
+    }
+  }
+  while(mlen > 0)
+  {
+    ctx->s[pos >> 3] ^= (uint64_t)*m++ << 8 * (pos & 7);
+    mlen--;
+    pos++;
+  }
+  ctx->pos = pos;
+}
+
+/*************************************************
+* Name:        keccak_inc_finalize
+*
+* Description: Pads the absorbed input; the next squeeze starts a new block.
+*
+* Arguments:   - keccak_incctx *ctx: pointer to in/output incremental state
+*              - unsigned int r:     rate in bytes (e.g., 168 for SHAKE128)
+*              - unsigned char p:    domain-separation byte for different Keccak-derived functions
+**************************************************/
+static void keccak_inc_finalize(keccak_incctx *ctx, unsigned int r, unsigned char p)
+{
+  ctx->s[ctx->pos >> 3] ^= (uint64_t)p << 8 * (ctx->pos & 7);
+  ctx->s[(r - 1) >> 3] ^= (uint64_t)128 << 8 * ((r - 1) & 7);
+  ctx->pos = r;
+}
+
+/*************************************************
+* Name:        keccak_inc_squeeze
+*
+* Description: Incremental squeeze step of Keccak; can be called repeatedly
+*              for outputs of any length.
+*
+* Arguments:   - unsigned char *h:          pointer to output
+*              - unsigned long long outlen: number of bytes to be squeezed
+*              - keccak_incctx *ctx:        pointer to in/output incremental state
+*              - unsigned int r:            rate in bytes (e.g., 168 for SHAKE128)
+**************************************************/
+static void keccak_inc_squeeze(unsigned char *h, unsigned long long outlen,
+                               keccak_incctx *ctx, unsigned int r)
+{
+  unsigned int pos = ctx->pos;
+
+  while(outlen > 0)
+  {
+    if(pos == r)
+    {
+      KeccakF1600_StatePermute(ctx->s);
+      pos = 0;
+    }
+    if((pos & 7) == 0 && outlen >= 8)
+    {
+      store64(h, ctx->s[pos >> 3]);
+      h += 8;
+      outlen -= 8;
+      pos += 8;
+    }
+    else
+    {
+      *h++ = (unsigned char)(ctx->s[pos >> 3] >> 8 * (pos & 7));
+      outlen--;
+      pos++;
+    }
+  }
+  ctx->pos = pos;
+}
+
+/*************************************************
+* Name:        keccak_inc_init
+*
+* Description: Starts an incremental hash from the zero state
+*
+* Arguments:   - keccak_incctx *ctx: pointer to output incremental state
+**************************************************/
+static void keccak_inc_init(keccak_incctx *ctx)
+{
+  unsigned int i;
+
+  for(i=0;i<25;i++)
+    ctx->s[i] = 0;
+  ctx->pos = 0;
+}
+
+/*************************************************
+* Name:        shake128_absorb
+*
+* Description: Absorb step of the SHAKE128 XOF.
+*              non-incremental, starts by zeroeing the state.
+*
+* Arguments:   - uint64_t *s:                     pointer to (uninitialized) output Keccak state
+*              - const unsigned char *input:      pointer to input to be absorbed into s
+*              - unsigned long long inputByteLen: length of input in bytes
+**************************************************/
+void shake128_absorb(uint64_t *s, const unsigned char *input, unsigned int inputByteLen)
+{
+  keccak_absorb(s, SHAKE128_RATE, input, inputByteLen, 0x1F);
+}
+
+/*************************************************
+* Name:        shake128_squeezeblocks
+*
+* Description: Squeeze step of SHAKE128 XOF. Squeezes full blocks of SHAKE128_RATE bytes each.
+*              Modifies the state. Can be called multiple times to keep squeezing,
+*              i.e., is incremental.
+*
+* Arguments:   - unsigned char *output:      pointer to output blocks
+*              - unsigned long long nblocks: number of blocks to be squeezed (written to output)
+*              - uint64_t *s:                pointer to in/output Keccak state
+**************************************************/
+void shake128_squeezeblocks(unsigned char *output, unsigned long long nblocks, uint64_t *s)
+{
+  keccak_squeezeblocks(output, nblocks, s, SHAKE128_RATE);
+}
+
+/*************************************************
+* Name:        shake128
+*
+* Description: SHAKE128 XOF with non-incremental API
+*
+* Arguments:   - unsigned char *output:      pointer to output
+*              - unsigned long long outlen:  requested output length in bytes
+               - const unsigned char *input: pointer to input
+               - unsigned long long inlen:   length of input in bytes
+**************************************************/
+void shake128(unsigned char *output, unsigned long long outlen,
+              const unsigned char *input,  unsigned long long inlen)
+{
+  uint64_t s[25];
+  unsigned char t[SHAKE128_RATE];
+  unsigned long long nblocks = outlen/SHAKE128_RATE;
+  size_t i;
+
+  /* Absorb input */
+  keccak_absorb(s, SHAKE128_RATE, input, inlen, 0x1F);
+
+  /* Squeeze output */
+  keccak_squeezeblocks(output, nblocks, s, SHAKE128_RATE);
+
+  output+=nblocks*SHAKE128_RATE;
+  outlen-=nblocks*SHAKE128_RATE;
+
+  if(outlen)
+  {
+    keccak_squeezeblocks(t, 1, s, SHAKE128_RATE);
+    for(i=0;i<outlen;i++)
+      output[i] = t[i];
+  }
+}
+
+/*************************************************
+* Name:        shake256_absorb
+*
+* Description: Absorb step of the SHAKE256 XOF.
+*              non-incremental, starts by zeroeing the state.
+*
+* Arguments:   - uint64_t *s:                     pointer to (uninitialized) output Keccak state
+*              - const unsigned char *input:      pointer to input to be absorbed into s
+*              - unsigned long long inputByteLen: length of input in bytes
+**************************************************/
+void shake256_absorb(uint64_t *s, const unsigned char *input, unsigned int inputByteLen)
+{
+  keccak_absorb(s, SHAKE256_RATE, input, inputByteLen, 0x1F);
+}
+
+/*************************************************
+* Name:        shake256_squeezeblocks
+*
+* Description: Squeeze step of SHAKE256 XOF. Squeezes full blocks of SHAKE256_RATE bytes each.
+*              Modifies the state. Can be called multiple times to keep squeezing,
+*              i.e., is incremental.
+*
+* Arguments:   - unsigned char *output:      pointer to output blocks
+*              - unsigned long long nblocks: number of blocks to be squeezed (written to output)
+*              - uint64_t *s:                pointer to in/output Keccak state
+**************************************************/
+void shake256_squeezeblocks(unsigned char *output, unsigned long long nblocks, uint64_t *s)
+{
+  keccak_squeezeblocks(output, nblocks, s, SHAKE256_RATE);
+}
+
+/*************************************************
+* Name:        shake256
+*
+* Description: SHAKE256 XOF with non-incremental API
+*
+* Arguments:   - unsigned char *output:      pointer to output
+*              - unsigned long long outlen:  requested output length in bytes
+               - const unsigned char *input: pointer to input
+               - unsigned long long inlen:   length of input in bytes
+**************************************************/
+void shake256(unsigned char *output, unsigned long long outlen,
+              const unsigned char *input,  unsigned long long inlen)
+{
+  uint64_t s[25];
+  unsigned char t[SHAKE256_RATE];
+  unsigned long long nblocks = outlen/SHAKE256_RATE;
+  size_t i;
+
+  /* Absorb input */
+  keccak_absorb(s, SHAKE256_RATE, input, inlen, 0x1F);
+
+  /* Squeeze output */
+  keccak_squeezeblocks(output, nblocks, s, SHAKE256_RATE);
+
+  output+=nblocks*SHAKE256_RATE;
+  outlen-=nblocks*SHAKE256_RATE;
+
+  if(outlen)
+  {
+    keccak_squeezeblocks(t, 1, s, SHAKE256_RATE);
+    for(i=0;i<outlen;i++)
+      output[i] = t[i];
+  }
+}
+
+/*************************************************
+* Name:        sha3_256
+*
+* Description: SHA3-256 with non-incremental API
+*
+* Arguments:   - unsigned char *output:      pointer to output (32 bytes)
+*              - const unsigned char *input: pointer to input
+*              - unsigned long long inlen:   length of input in bytes
+**************************************************/
+void sha3_256(unsigned char *output, const unsigned char *input,  unsigned long long inlen)
+{
+  uint64_t s[25];
+  unsigned char t[SHA3_256_RATE];
+  size_t i;
+
+  /* Absorb input */
+  keccak_absorb(s, SHA3_256_RATE, input, inlen, 0x06);
+
+  /* Squeeze output */
+  keccak_squeezeblocks(t, 1, s, SHA3_256_RATE);
+
+  for(i=0;i<32;i++)
+      output[i] = t[i];
+}
+
+/*************************************************
+* Name:        sha3_512
+*
+* Description: SHA3-512 with non-incremental API
+*
+* Arguments:   - unsigned char *output:      pointer to output (64 bytes)
+*              - const unsigned char *input: pointer to input
+*              - unsigned long long inlen:   length of input in bytes
+**************************************************/
+void sha3_512(unsigned char *output, const unsigned char *input,  unsigned long long inlen)
+{
+  uint64_t s[25];
+  unsigned char t[SHA3_512_RATE];
+  size_t i;
+
+  /* Absorb input */
+  keccak_absorb(s, SHA3_512_RATE, input, inlen, 0x06);
+
+  /* Squeeze output */
+  keccak_squeezeblocks(t, 1, s, SHA3_512_RATE);
+
+  for(i=0;i<64;i++)
+      output[i] = t[i];
+}
+
+/*************************************************
+* Name:        shake128_inc_init / _inc_absorb / _inc_finalize / _inc_squeeze
+*
+* Description: SHAKE128 with incremental API: absorb any number of inputs,
+*              finalize once, then squeeze any number of outputs.
+**************************************************/
+void shake128_inc_init(keccak_incctx *ctx)
+{
+  keccak_inc_init(ctx);
+}
+
+void shake128_inc_absorb(keccak_incctx *ctx, const unsigned char *input, unsigned long long inlen)
+{
+  keccak_inc_absorb(ctx, SHAKE128_RATE, input, inlen);
+}
+
+void shake128_inc_finalize(keccak_incctx *ctx)
+{
+  keccak_inc_finalize(ctx, SHAKE128_RATE, 0x1F);
+}
+
+void shake128_inc_squeeze(unsigned char *output, unsigned long long outlen, keccak_incctx *ctx)
+{
+  keccak_inc_squeeze(output, outlen, ctx, SHAKE128_RATE);
+}
+
+/*************************************************
+* Name:        shake256_inc_init / _inc_absorb / _inc_finalize / _inc_squeeze
+*
+* Description: SHAKE256 with incremental API: absorb any number of inputs,
+*              finalize once, then squeeze any number of outputs.
+**************************************************/
+void shake256_inc_init(keccak_incctx *ctx)
+{
+  keccak_inc_init(ctx);
+}
+
+void shake256_inc_absorb(keccak_incctx *ctx, const unsigned char *input, unsigned long long inlen)
+{
+  keccak_inc_absorb(ctx, SHAKE256_RATE, input, inlen);
+}
+
+void shake256_inc_finalize(keccak_incctx *ctx)
+{
+  keccak_inc_finalize(ctx, SHAKE256_RATE, 0x1F);
+}
+
+void shake256_inc_squeeze(unsigned char *output, unsigned long long outlen, keccak_incctx *ctx)
+{
+  keccak_inc_squeeze(output, outlen, ctx, SHAKE256_RATE);
+}
+
+/*************************************************
+* Name:        sha3_256_inc_init / _inc_absorb / _inc_finalize
+*
+* Description: SHA3-256 with incremental API; finalize writes the 32-byte digest.
+**************************************************/
+void sha3_256_inc_init(keccak_incctx *ctx)
+{
+  keccak_inc_init(ctx);
+}
+
+void sha3_256_inc_absorb(keccak_incctx *ctx, const unsigned char *input, unsigned long long inlen)
+{
+  keccak_inc_absorb(ctx, SHA3_256_RATE, input, inlen);
+}
+
+void sha3_256_inc_finalize(unsigned char *output, keccak_incctx *ctx)
+{
+  keccak_inc_finalize(ctx, SHA3_256_RATE, 0x06);
+  keccak_inc_squeeze(output, 32, ctx, SHA3_256_RATE);
+}
+
+/*************************************************
+* Name:        sha3_512_inc_init / _inc_absorb / _inc_finalize
+*
+* Description: SHA3-512 with incremental API; finalize writes the 64-byte digest.
+**************************************************/
+void sha3_512_inc_init(keccak_incctx *ctx)
+{
+  keccak_inc_init(ctx);
+}
+
+void sha3_512_inc_absorb(keccak_incctx *ctx, const unsigned char *input, unsigned long long inlen)
+{
+  keccak_inc_absorb(ctx, SHA3_512_RATE, input, inlen);
+}
+
+void sha3_512_inc_finalize(unsigned char *output, keccak_incctx *ctx)
+{
+  keccak_inc_finalize(ctx, SHA3_512_RATE, 0x06);
+  keccak_inc_squeeze(output, 64, ctx, SHA3_512_RATE);
+}
@@ -0,0 +1,51 @@
+#ifndef FIPS202_H
+#define FIPS202_H
+
+#include <stdint.h>
+
+#define SHAKE128_RATE 168
+#define SHAKE256_RATE 136
+#define SHA3_256_RATE 136
+#define SHA3_512_RATE  72
+
+/* State of an incremental hash: pos counts the bytes absorbed into (or,
+ * after finalize, squeezed from) the current block */
+typedef struct {
+  uint64_t s[25];
+  unsigned int pos;
+} keccak_incctx;
+
+void KeccakF1600_StatePermute(uint64_t *state);
+
+/* shake*_absorb start from a zero state; squeezeblocks can be called repeatedly */
+void shake128_absorb(uint64_t *s, const unsigned char *input, unsigned int inputByteLen);
+void shake128_squeezeblocks(unsigned char *output, unsigned long long nblocks, uint64_t *s);
+void shake128(unsigned char *output, unsigned long long outlen, const unsigned char *input,  unsigned long long inlen);
+
+void shake256_absorb(uint64_t *s, const unsigned char *input, unsigned int inputByteLen);
+void shake256_squeezeblocks(unsigned char *output, unsigned long long nblocks, uint64_t *s);
+void shake256(unsigned char *output, unsigned long long outlen, const unsigned char *input,  unsigned long long inlen);
+
+void sha3_256(unsigned char *output, const unsigned char *input,  unsigned long long inlen);
+void sha3_512(unsigned char *output, const unsigned char *input,  unsigned long long inlen);
+
+/* Incremental API: init, absorb any number of times, finalize, then squeeze */
+void shake128_inc_init(keccak_incctx *ctx);
+void shake128_inc_absorb(keccak_incctx *ctx, const unsigned char *input, unsigned long long inlen);
+void shake128_inc_finalize(keccak_incctx *ctx);
+void shake128_inc_squeeze(unsigned char *output, unsigned long long outlen, keccak_incctx *ctx);
+
+void shake256_inc_init(keccak_incctx *ctx);
+void shake256_inc_absorb(keccak_incctx *ctx, const unsigned char *input, unsigned long long inlen);
+void shake256_inc_finalize(keccak_incctx *ctx);
+void shake256_inc_squeeze(unsigned char *output, unsigned long long outlen, keccak_incctx *ctx);
+
+void sha3_256_inc_init(keccak_incctx *ctx);
+void sha3_256_inc_absorb(keccak_incctx *ctx, const unsigned char *input, unsigned long long inlen);
+void sha3_256_inc_finalize(unsigned char *output, keccak_incctx *ctx);
+
+void sha3_512_inc_init(keccak_incctx *ctx);
+void sha3_512_inc_absorb(keccak_incctx *ctx, const unsigned char *input, unsigned long long inlen);
+void sha3_512_inc_finalize(unsigned char *output, keccak_incctx *ctx);
+
+#endif
@@ -0,0 +1,518 @@
+/* Four-way SHAKE128/SHAKE256 and SHA3-256 shared by the KEMs.
+ *
+ * Four independent Keccak states are kept interleaved, word i of instance k
+ * at s[4*i + k], so that one AVX2 register holds the same word of all four
+ * and the permutation of fips202.c runs on the four at once. The AVX2 code
+ * is used when the CPU supports it (checked at run time); otherwise each
+ * instance goes through the scalar KeccakF1600_StatePermute.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "fips202x4.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define KECCAK_HAVE_AVX2
+#include <immintrin.h>
+#endif
+
+/********************************************************************************************
+* AVX2 backend
+*********************************************************************************************/
+
+#ifdef KECCAK_HAVE_AVX2
+
+#define AVX2 __attribute__((target("avx2")))
+
+#define NROUNDS 24
+#define XOR(a, b) _mm256_xor_si256(a, b)
+#define ANDNOT(a, b) _mm256_andnot_si256(a, b)          /* (~a) & b */
+#define ROL64(a, offset) ((offset) == 8 ? _mm256_shuffle_epi8(a, rho8) : (offset) == 56 ? _mm256_shuffle_epi8(a, rho56) : \
+                          _mm256_or_si256(_mm256_slli_epi64(a, offset), _mm256_srli_epi64(a, 64-(offset))))
+
+static const uint64_t KeccakF_RoundConstants[NROUNDS] = 
+{
+    (uint64_t)0x0000000000000001ULL,
+    (uint64_t)0x0000000000008082ULL,
+    (uint64_t)0x800000000000808aULL,
+    (uint64_t)0x8000000080008000ULL,
+    (uint64_t)0x000000000000808bULL,
+    (uint64_t)0x0000000080000001ULL,
+    (uint64_t)0x8000000080008081ULL,
+    (uint64_t)0x8000000000008009ULL,
+    (uint64_t)0x000000000000008aULL,
+    (uint64_t)0x0000000000000088ULL,
+    (uint64_t)0x0000000080008009ULL,
+    (uint64_t)0x000000008000000aULL,
+    (uint64_t)0x000000008000808bULL,
+    (uint64_t)0x800000000000008bULL,
+    (uint64_t)0x8000000000008089ULL,
+    (uint64_t)0x8000000000008003ULL,
+    (uint64_t)0x8000000000008002ULL,
+    (uint64_t)0x8000000000000080ULL,
+    (uint64_t)0x000000000000800aULL,
+    (uint64_t)0x800000008000000aULL,
+    (uint64_t)0x8000000080008081ULL,
+    (uint64_t)0x8000000000008080ULL,
+    (uint64_t)0x0000000080000001ULL,
+    (uint64_t)0x8000000080008008ULL
+};
+
+
+AVX2 static void KeccakF1600_StatePermute4x(uint64_t *state)
+{
+  int round;
+        /* Rotations by 8 and 56 are byte shuffles */
+        const __m256i rho8 = _mm256_set_epi8(14, 13, 12, 11, 10, 9, 8, 15, 6, 5, 4, 3, 2, 1, 0, 7,
+                                             14, 13, 12, 11, 10, 9, 8, 15, 6, 5, 4, 3, 2, 1, 0, 7);
+        const __m256i rho56 = _mm256_set_epi8(8, 15, 14, 13, 12, 11, 10, 9, 0, 7, 6, 5, 4, 3, 2, 1,
+                                              8, 15, 14, 13, 12, 11, 10, 9, 0, 7, 6, 5, 4, 3, 2, 1);
+
+        __m256i Aba, Abe, Abi, Abo, Abu;
+        __m256i Aga, Age, Agi, Ago, Agu;
+        __m256i Aka, Ake, Aki, Ako, Aku;
+        __m256i Ama, Ame, Ami, Amo, Amu;
+        __m256i Asa, Ase, Asi, Aso, Asu;
+        __m256i BCa, BCe, BCi, BCo, BCu;
+        __m256i Da, De, Di, Do, Du;
+        __m256i Eba, Ebe, Ebi, Ebo, Ebu;
+        __m256i Ega, Ege, Egi, Ego, Egu;
+        __m256i Eka, Eke, Eki, Eko, Eku;
+        __m256i Ema, Eme, Emi, Emo, Emu;
+        __m256i Esa, Ese, Esi, Eso, Esu;
+
+        Aba = _mm256_loadu_si256((const __m256i *)(state + 4*0));
+        Abe = _mm256_loadu_si256((const __m256i *)(state + 4*1));
+        Abi = _mm256_loadu_si256((const __m256i *)(state + 4*2));
+        Abo = _mm256_loadu_si256((const __m256i *)(state + 4*3));
+        Abu = _mm256_loadu_si256((const __m256i *)(state + 4*4));
+        Aga = _mm256_loadu_si256((const __m256i *)(state + 4*5));
+        Age = _mm256_loadu_si256((const __m256i *)(state + 4*6));
+        Agi = _mm256_loadu_si256((const __m256i *)(state + 4*7));
+        Ago = _mm256_loadu_si256((const __m256i *)(state + 4*8));
+        Agu = _mm256_loadu_si256((const __m256i *)(state + 4*9));
+        Aka = _mm256_loadu_si256((const __m256i *)(state + 4*10));
+        Ake = _mm256_loadu_si256((const __m256i *)(state + 4*11));
+        Aki = _mm256_loadu_si256((const __m256i *)(state + 4*12));
+        Ako = _mm256_loadu_si256((const __m256i *)(state + 4*13));
+        Aku = _mm256_loadu_si256((const __m256i *)(state + 4*14));
+        Ama = _mm256_loadu_si256((const __m256i *)(state + 4*15));
+        Ame = _mm256_loadu_si256((const __m256i *)(state + 4*16));
+        Ami = _mm256_loadu_si256((const __m256i *)(state + 4*17));
+        Amo = _mm256_loadu_si256((const __m256i *)(state + 4*18));
+        Amu = _mm256_loadu_si256((const __m256i *)(state + 4*19));
+        Asa = _mm256_loadu_si256((const __m256i *)(state + 4*20));
+        Ase = _mm256_loadu_si256((const __m256i *)(state + 4*21));
+        Asi = _mm256_loadu_si256((const __m256i *)(state + 4*22));
+        Aso = _mm256_loadu_si256((const __m256i *)(state + 4*23));
+        Asu = _mm256_loadu_si256((const __m256i *)(state + 4*24));
+
+        for( round = 0; round < NROUNDS; round += 2 )
+        {
+            //    prepareTheta
+            BCa = XOR(Aba, XOR(Aga, XOR(Aka, XOR(Ama, Asa))));
+            BCe = XOR(Abe, XOR(Age, XOR(Ake, XOR(Ame, Ase))));
+            BCi = XOR(Abi, XOR(Agi, XOR(Aki, XOR(Ami, Asi))));
+            BCo = XOR(Abo, XOR(Ago, XOR(Ako, XOR(Amo, Aso))));
+            BCu = XOR(Abu, XOR(Agu, XOR(Aku, XOR(Amu, Asu))));
+
+            //thetaRhoPiChiIotaPrepareTheta(round  , A, E)
+            Da = XOR(BCu, ROL64(BCe, 1));
+            De = XOR(BCa, ROL64(BCi, 1));
+            Di = XOR(BCe, ROL64(BCo, 1));
+            Do = XOR(BCi, ROL64(BCu, 1));
+            Du = XOR(BCo, ROL64(BCa, 1));
+
+            Aba = XOR(Aba, Da);
+            BCa = Aba;
+            Age = XOR(Age, De);
+            BCe = ROL64(Age, 44);
+            Aki = XOR(Aki, Di);
+            BCi = ROL64(Aki, 43);
+            Amo = XOR(Amo, Do);
+            BCo = ROL64(Amo, 21);
+            Asu = XOR(Asu, Du);
+            BCu = ROL64(Asu, 14);
+            Eba = XOR(BCa, ANDNOT(BCe, BCi));
+            Eba = XOR(Eba, _mm256_set1_epi64x((long long)KeccakF_RoundConstants[round]));
+            Ebe = XOR(BCe, ANDNOT(BCi, BCo));
+            Ebi = XOR(BCi, ANDNOT(BCo, BCu));
+            Ebo = XOR(BCo, ANDNOT(BCu, BCa));
+            Ebu = XOR(BCu, ANDNOT(BCa, BCe));
+
+            Abo = XOR(Abo, Do);
+            BCa = ROL64(Abo, 28);
+            Agu = XOR(Agu, Du);
+            BCe = ROL64(Agu, 20);
+            Aka = XOR(Aka, Da);
+            BCi = ROL64(Aka, 3);
+            Ame = XOR(Ame, De);
+            BCo = ROL64(Ame, 45);
+            Asi = XOR(Asi, Di);
+            BCu = ROL64(Asi, 61);
+            Ega = XOR(BCa, ANDNOT(BCe, BCi));
+            Ege = XOR(BCe, ANDNOT(BCi, BCo));
+            Egi = XOR(BCi, ANDNOT(BCo, BCu));
+            Ego = XOR(BCo, ANDNOT(BCu, BCa));
+            Egu = XOR(BCu, ANDNOT(BCa, BCe));
+
+            Abe = XOR(Abe, De);
+            BCa = ROL64(Abe, 1);
+            Agi = XOR(Agi, Di);
+            BCe = ROL64(Agi, 6);
+            Ako = XOR(Ako, Do);
+            BCi = ROL64(Ako, 25);
+            Amu = XOR(Amu, Du);
+            BCo = ROL64(Amu, 8);
+            Asa = XOR(Asa, Da);
+            BCu = ROL64(Asa, 18);
+            Eka = XOR(BCa, ANDNOT(BCe, BCi));
+            Eke = XOR(BCe, ANDNOT(BCi, BCo));
+            Eki = XOR(BCi, ANDNOT(BCo, BCu));
+            Eko = XOR(BCo, ANDNOT(BCu, BCa));
+            Eku = XOR(BCu, ANDNOT(BCa, BCe));
+
+            Abu = XOR(Abu, Du);
+            BCa = ROL64(Abu, 27);
+            Aga = XOR(Aga, Da);
+            BCe = ROL64(Aga, 36);
+            Ake = XOR(Ake, De);
+            BCi = ROL64(Ake, 10);
+            Ami = XOR(Ami, Di);
+            BCo = ROL64(Ami, 15);
+            Aso = XOR(Aso, Do);
+            BCu = ROL64(Aso, 56);
+            Ema = XOR(BCa, ANDNOT(BCe, BCi));
+            Eme = XOR(BCe, ANDNOT(BCi, BCo));
+            Emi = XOR(BCi, ANDNOT(BCo, BCu));
+            Emo = XOR(BCo, ANDNOT(BCu, BCa));
+            Emu = XOR(BCu, ANDNOT(BCa, BCe));
+
+            Abi = XOR(Abi, Di);
+            BCa = ROL64(Abi, 62);
+            Ago = XOR(Ago, Do);
+            BCe = ROL64(Ago, 55);
+            Aku = XOR(Aku, Du);
+            BCi = ROL64(Aku, 39);
+            Ama = XOR(Ama, Da);
+            BCo = ROL64(Ama, 41);
+            Ase = XOR(Ase, De);
+            BCu = ROL64(Ase, 2);
+            Esa = XOR(BCa, ANDNOT(BCe, BCi));
+            Ese = XOR(BCe, ANDNOT(BCi, BCo));
+            Esi = XOR(BCi, ANDNOT(BCo, BCu));
+            Eso = XOR(BCo, ANDNOT(BCu, BCa));
+            Esu = XOR(BCu, ANDNOT(BCa, BCe));
+
+            //    prepareTheta
+            BCa = XOR(Eba, XOR(Ega, XOR(Eka, XOR(Ema, Esa))));
+            BCe = XOR(Ebe, XOR(Ege, XOR(Eke, XOR(Eme, Ese))));
+            BCi = XOR(Ebi, XOR(Egi, XOR(Eki, XOR(Emi, Esi))));
+            BCo = XOR(Ebo, XOR(Ego, XOR(Eko, XOR(Emo, Eso))));
+            BCu = XOR(Ebu, XOR(Egu, XOR(Eku, XOR(Emu, Esu))));
+
+            //thetaRhoPiChiIotaPrepareTheta(round+1, E, A)
+            Da = XOR(BCu, ROL64(BCe, 1));
+            De = XOR(BCa, ROL64(BCi, 1));
+            Di = XOR(BCe, ROL64(BCo, 1));
+            Do = XOR(BCi, ROL64(BCu, 1));
+            Du = XOR(BCo, ROL64(BCa, 1));
+
+            Eba = XOR(Eba, Da);
+            BCa = Eba;
+            Ege = XOR(Ege, De);
+            BCe = ROL64(Ege, 44);
+            Eki = XOR(Eki, Di);
+            BCi = ROL64(Eki, 43);
+            Emo = XOR(Emo, Do);
+            BCo = ROL64(Emo, 21);
+            Esu = XOR(Esu, Du);
+            BCu = ROL64(Esu, 14);
+            Aba = XOR(BCa, ANDNOT(BCe, BCi));
+            Aba = XOR(Aba, _mm256_set1_epi64x((long long)KeccakF_RoundConstants[round+1]));
+            Abe = XOR(BCe, ANDNOT(BCi, BCo));
+            Abi = XOR(BCi, ANDNOT(BCo, BCu));
+            Abo = XOR(BCo, ANDNOT(BCu, BCa));
+            Abu = XOR(BCu, ANDNOT(BCa, BCe));
+
+            Ebo = XOR(Ebo, Do);
+            BCa = ROL64(Ebo, 28);
+            Egu = XOR(Egu, Du);
+            BCe = ROL64(Egu, 20);
+            Eka = XOR(Eka, Da);
+            BCi = ROL64(Eka, 3);
+            Eme = XOR(Eme, De);
+            BCo = ROL64(Eme, 45);
+            Esi = XOR(Esi, Di);
+            BCu = ROL64(Esi, 61);
+            Aga = XOR(BCa, ANDNOT(BCe, BCi));
+            Age = XOR(BCe, ANDNOT(BCi, BCo));
+            Agi = XOR(BCi, ANDNOT(BCo, BCu));
+            Ago = XOR(BCo, ANDNOT(BCu, BCa));
+            Agu = XOR(BCu, ANDNOT(BCa, BCe));
+
+            Ebe = XOR(Ebe, De);
+            BCa = ROL64(Ebe, 1);
+            Egi = XOR(Egi, Di);
+            BCe = ROL64(Egi, 6);
+            Eko = XOR(Eko, Do);
+            BCi = ROL64(Eko, 25);
+            Emu = XOR(Emu, Du);
+            BCo = ROL64(Emu, 8);
+            Esa = XOR(Esa, Da);
+            BCu = ROL64(Esa, 18);
+            Aka = XOR(BCa, ANDNOT(BCe, BCi));
+            Ake = XOR(BCe, ANDNOT(BCi, BCo));
+            Aki = XOR(BCi, ANDNOT(BCo, BCu));
+            Ako = XOR(BCo, ANDNOT(BCu, BCa));
+            Aku = XOR(BCu, ANDNOT(BCa, BCe));
+
+            Ebu = XOR(Ebu, Du);
+            BCa = ROL64(Ebu, 27);
+            Ega = XOR(Ega, Da);
+            BCe = ROL64(Ega, 36);
+            Eke = XOR(Eke, De);
+            BCi = ROL64(Eke, 10);
+            Emi = XOR(Emi, Di);
+            BCo = ROL64(Emi, 15);
+            Eso = XOR(Eso, Do);
+            BCu = ROL64(Eso, 56);
+            Ama = XOR(BCa, ANDNOT(BCe, BCi));
+            Ame = XOR(BCe, ANDNOT(BCi, BCo));
+            Ami = XOR(BCi, ANDNOT(BCo, BCu));
+            Amo = XOR(BCo, ANDNOT(BCu, BCa));
+            Amu = XOR(BCu, ANDNOT(BCa, BCe));
+
+            Ebi = XOR(Ebi, Di);
+            BCa = ROL64(Ebi, 62);
+            Ego = XOR(Ego, Do);
+            BCe = ROL64(Ego, 55);
+            Eku = XOR(Eku, Du);
+            BCi = ROL64(Eku, 39);
+            Ema = XOR(Ema, Da);
+            BCo = ROL64(Ema, 41);
+            Ese = XOR(Ese, De);
+            BCu = ROL64(Ese, 2);
+            Asa = XOR(BCa, ANDNOT(BCe, BCi));
+            Ase = XOR(BCe, ANDNOT(BCi, BCo));
+            Asi = XOR(BCi, ANDNOT(BCo, BCu));
+            Aso = XOR(BCo, ANDNOT(BCu, BCa));
+            Asu = XOR(BCu, ANDNOT(BCa, BCe));
+        }
+
+        _mm256_storeu_si256((__m256i *)(state + 4*0), Aba);
+        _mm256_storeu_si256((__m256i *)(state + 4*1), Abe);
+        _mm256_storeu_si256((__m256i *)(state + 4*2), Abi);
+        _mm256_storeu_si256((__m256i *)(state + 4*3), Abo);
+        _mm256_storeu_si256((__m256i *)(state + 4*4), Abu);
+        _mm256_storeu_si256((__m256i *)(state + 4*5), Aga);
+        _mm256_storeu_si256((__m256i *)(state + 4*6), Age);
+        _mm256_storeu_si256((__m256i *)(state + 4*7), Agi);
+        _mm256_storeu_si256((__m256i *)(state + 4*8), Ago);
+        _mm256_storeu_si256((__m256i *)(state + 4*9), Agu);
+        _mm256_storeu_si256((__m256i *)(state + 4*10), Aka);
+        _mm256_storeu_si256((__m256i *)(state + 4*11), Ake);
+        _mm256_storeu_si256((__m256i *)(state + 4*12), Aki);
+        _mm256_storeu_si256((__m256i *)(state + 4*13), Ako);
+        _mm256_storeu_si256((__m256i *)(state + 4*14), Aku);
+        _mm256_storeu_si256((__m256i *)(state + 4*15), Ama);
+        _mm256_storeu_si256((__m256i *)(state + 4*16), Ame);
+        _mm256_storeu_si256((__m256i *)(state + 4*17), Ami);
+        _mm256_storeu_si256((__m256i *)(state + 4*18), Amo);
+        _mm256_storeu_si256((__m256i *)(state + 4*19), Amu);
+        _mm256_storeu_si256((__m256i *)(state + 4*20), Asa);
+        _mm256_storeu_si256((__m256i *)(state + 4*21), Ase);
+        _mm256_storeu_si256((__m256i *)(state + 4*22), Asi);
+        _mm256_storeu_si256((__m256i *)(state + 4*23), Aso);
+        _mm256_storeu_si256((__m256i *)(state + 4*24), Asu);
+}
+
+static int avx2_available(void)
+{
+    return __builtin_cpu_supports("avx2");
+}
+
+#else
+
+static int avx2_available(void)
+{
+    return 0;
+}
+
+#endif
+
+/********************************************************************************************
+* Absorb and squeeze
+*********************************************************************************************/
+
+/* Keccak words are little-endian; on little-endian hosts they are copied as they are */
+static uint64_t load64(const unsigned char *x)
+{
+  uint64_t r = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  memcpy(&r, x, 8);
+#else
+  unsigned int i;
+
+  for (i = 0; i < 8; ++i)
+    r |= (uint64_t)x[i] << 8 * i;
+#endif
+  return r;
+}
+
+static void store64(unsigned char *x, uint64_t u)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  memcpy(x, &u, 8);
+#else
+  unsigned int i;
+
+  for (i = 0; i < 8; ++i) {
+    x[i] = (unsigned char)u;
+    u >>= 8;
+  }
+#endif
+}
+
+static void keccakx4_permute(keccakx4_state *st)
+{
+  uint64_t t[25];
+  unsigned int i, k;
+
+#ifdef KECCAK_HAVE_AVX2
+  if (st->avx2) {
+    KeccakF1600_StatePermute4x(st->s);
+    return;
+  }
+#endif
+  for (k = 0; k < 4; ++k) {
+    for (i = 0; i < 25; ++i)
+      t[i] = st->s[4 * i + k];
+    KeccakF1600_StatePermute(t);
+    for (i = 0; i < 25; ++i)
+      st->s[4 * i + k] = t[i];
+  }
+}
+
+static void keccakx4_absorb(keccakx4_state *st, unsigned int r,
+                            const unsigned char *in0, const unsigned char *in1, const unsigned char *in2, const unsigned char *in3,
+                            unsigned long long inlen, unsigned char p)
+{ /* Absorb four messages of the same length, starting from the zero state */
+  const unsigned char *in[4] = {in0, in1, in2, in3};
+  unsigned char t[200];
+  unsigned long long i;
+  unsigned int k;
+
+  memset(st->s, 0, sizeof(st->s));
+  st->avx2 = avx2_available();
+  while (inlen >= r)
+  {
+    for (k = 0; k < 4; ++k) {
+      for (i = 0; i < r / 8; ++i)
+        st->s[4 * i + k] ^= load64(in[k] + 8 * i);
+      in[k] += r;
+    }
+    keccakx4_permute(st);
+    inlen -= r;
+  }
+
+  for (k = 0; k < 4; ++k) {
+    memset(t, 0, r);
+    memcpy(t, in[k], inlen);
+    t[inlen] = p;
+    t[r - 1] |= 128;
+    for (i = 0; i < r / 8; ++i)
+      st->s[4 * i + k] ^= load64(t + 8 * i);
+  }
+}
+
+static void keccakx4_squeezeblocks(unsigned char *out0, unsigned char *out1, unsigned char *out2, unsigned char *out3,
+                                   unsigned long long nblocks, keccakx4_state *st, unsigned int r)
+{
+  unsigned int i;
+
+  while (nblocks > 0)
+  {
+    keccakx4_permute(st);
+    for (i = 0; i < r / 8; ++i) {
+      store64(out0 + 8 * i, st->s[4 * i + 0]);
+      store64(out1 + 8 * i, st->s[4 * i + 1]);
+      store64(out2 + 8 * i, st->s[4 * i + 2]);
+      store64(out3 + 8 * i, st->s[4 * i + 3]);
+    }
+    out0 += r;
+    out1 += r;
+    out2 += r;
+    out3 += r;
+    nblocks--;
+  }
+}
+
+static void keccakx4(unsigned char *out0, unsigned char *out1, unsigned char *out2, unsigned char *out3, unsigned long long outlen, unsigned int r,
+                     const unsigned char *in0, const unsigned char *in1, const unsigned char *in2, const unsigned char *in3, unsigned long long inlen,
+                     unsigned char p)
+{
+  keccakx4_state st;
+  unsigned char t[4][SHAKE128_RATE];
+  unsigned long long nblocks = outlen / r;
+
+  keccakx4_absorb(&st, r, in0, in1, in2, in3, inlen, p);
+  keccakx4_squeezeblocks(out0, out1, out2, out3, nblocks, &st, r);
+
+  outlen -= nblocks * r;
+  if (outlen)
+  {
+    keccakx4_squeezeblocks(t[0], t[1], t[2], t[3], 1, &st, r);
+    memcpy(out0 + nblocks * r, t[0], outlen);
+    memcpy(out1 + nblocks * r, t[1], outlen);
+    memcpy(out2 + nblocks * r, t[2], outlen);
+    memcpy(out3 + nblocks * r, t[3], outlen);
+  }
+}
+
+/********************************************************************************************
+* API
+*********************************************************************************************/
+
+void shake128x4_absorb(keccakx4_state *s, const unsigned char *in0, const unsigned char *in1, const unsigned char *in2, const unsigned char *in3,
+                       unsigned long long inlen)
+{
+  keccakx4_absorb(s, SHAKE128_RATE, in0, in1, in2, in3, inlen, 0x1F);
+}
+
+void shake128x4_squeezeblocks(unsigned char *out0, unsigned char *out1, unsigned char *out2, unsigned char *out3,
+                              unsigned long long nblocks, keccakx4_state *s)
+{
+  keccakx4_squeezeblocks(out0, out1, out2, out3, nblocks, s, SHAKE128_RATE);
+}
+
+void shake256x4_absorb(keccakx4_state *s, const unsigned char *in0, const unsigned char *in1, const unsigned char *in2, const unsigned char *in3,
+                       unsigned long long inlen)
+{
+  keccakx4_absorb(s, SHAKE256_RATE, in0, in1, in2, in3, inlen, 0x1F);
+}
+
+void shake256x4_squeezeblocks(unsigned char *out0, unsigned char *out1, unsigned char *out2, unsigned char *out3,
+                              unsigned long long nblocks, keccakx4_state *s)
+{
+  keccakx4_squeezeblocks(out0, out1, out2, out3, nblocks, s, SHAKE256_RATE);
+}
+
+void shake128x4(unsigned char *out0, unsigned char *out1, unsigned char *out2, unsigned char *out3, unsigned long long outlen,
+                const unsigned char *in0, const unsigned char *in1, const unsigned char *in2, const unsigned char *in3, unsigned long long inlen)
+{
+  keccakx4(out0, out1, out2, out3, outlen, SHAKE128_RATE, in0, in1, in2, in3, inlen, 0x1F);
+}
+
+void shake256x4(unsigned char *out0, unsigned char *out1, unsigned char *out2, unsigned char *out3, unsigned long long outlen,
+                const unsigned char *in0, const unsigned char *in1, const unsigned char *in2, const unsigned char *in3, unsigned long long inlen)
+{
+  keccakx4(out0, out1, out2, out3, outlen, SHAKE256_RATE, in0, in1, in2, in3, inlen, 0x1F);
+}
+
+void sha3_256x4(unsigned char *out0, unsigned char *out1, unsigned char *out2, unsigned char *out3,
+                const unsigned char *in0, const unsigned char *in1, const unsigned char *in2, const unsigned char *in3, unsigned long long inlen)
+{
+  keccakx4(out0, out1, out2, out3, 32, SHA3_256_RATE, in0, in1, in2, in3, inlen, 0x06);
+}
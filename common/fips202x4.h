@@ -0,0 +1,32 @@
+#ifndef FIPS202X4_H
+#define FIPS202X4_H
+
+#include <stdint.h>
+#include "fips202.h"
+
+/* Four independent Keccak states, interleaved: word i of instance k is s[4*i + k] */
+typedef struct {
+  uint64_t s[4*25];
+  int avx2;
+} keccakx4_state;
+
+/* Four SHAKE instances with inputs of equal length; the state starts from zero */
+void shake128x4_absorb(keccakx4_state *s, const unsigned char *in0, const unsigned char *in1, const unsigned char *in2, const unsigned char *in3,
+                       unsigned long long inlen);
+void shake128x4_squeezeblocks(unsigned char *out0, unsigned char *out1, unsigned char *out2, unsigned char *out3,
+                              unsigned long long nblocks, keccakx4_state *s);
+void shake256x4_absorb(keccakx4_state *s, const unsigned char *in0, const unsigned char *in1, const unsigned char *in2, const unsigned char *in3,
+                       unsigned long long inlen);
+void shake256x4_squeezeblocks(unsigned char *out0, unsigned char *out1, unsigned char *out2, unsigned char *out3,
+                              unsigned long long nblocks, keccakx4_state *s);
+
+void shake128x4(unsigned char *out0, unsigned char *out1, unsigned char *out2, unsigned char *out3, unsigned long long outlen,
+                const unsigned char *in0, const unsigned char *in1, const unsigned char *in2, const unsigned char *in3, unsigned long long inlen);
+void shake256x4(unsigned char *out0, unsigned char *out1, unsigned char *out2, unsigned char *out3, unsigned long long outlen,
+                const unsigned char *in0, const unsigned char *in1, const unsigned char *in2, const unsigned char *in3, unsigned long long inlen);
+
+/* Four SHA3-256 digests (32 bytes each) of inputs of equal length */
+void sha3_256x4(unsigned char *out0, unsigned char *out1, unsigned char *out2, unsigned char *out3,
+                const unsigned char *in0, const unsigned char *in1, const unsigned char *in2, const unsigned char *in3, unsigned long long inlen);
+
+#endif
@@ -0,0 +1,114 @@
+/* Registry of the KEMs linked into the program (see qsiot_kem.h).
+ *
+ * Each scheme is compiled in with -DQSIOT_HAVE_<SCHEME> and its namespaced
+ * library, e.g. -DQSIOT_HAVE_KYBER512 -lqsiot_kyber512 or
+ * -DQSIOT_HAVE_SNTRUP761 -lsntrup761; the top-level Makefile does it for all
+ * of them with ALL=1.
+ */
+
+#include <strings.h>
+
+#include "qsiot_kem.h"
+
+static const qsiot_kem *const registry[] = {
+#ifdef QSIOT_HAVE_KYBER512
+    &qsiot_kem_kyber512,
+#endif
+#ifdef QSIOT_HAVE_LIGHTSABER
+    &qsiot_kem_lightsaber,
+#endif
+#ifdef QSIOT_HAVE_NTRUHPS2048509
+    &qsiot_kem_ntruhps2048509,
+#endif
+#ifdef QSIOT_HAVE_FRODO640AES
+    &qsiot_kem_frodo640aes,
+#endif
+#ifdef QSIOT_HAVE_FRODO640SHAKE
+    &qsiot_kem_frodo640shake,
+#endif
+#ifdef QSIOT_HAVE_SNTRUP653
+    &qsiot_kem_sntrup653,
+#endif
+#ifdef QSIOT_HAVE_SNTRUP761
+    &qsiot_kem_sntrup761,
+#endif
+#ifdef QSIOT_HAVE_SNTRUP857
+    &qsiot_kem_sntrup857,
+#endif
+#ifdef QSIOT_HAVE_NTRULPR653
+    &qsiot_kem_ntrulpr653,
+#endif
+#ifdef QSIOT_HAVE_NTRULPR761
+    &qsiot_kem_ntrulpr761,
+#endif
+#ifdef QSIOT_HAVE_NTRULPR857
+    &qsiot_kem_ntrulpr857,
+#endif
+    NULL
+};
+
+size_t qsiot_kem_count(void)
+{
+    return sizeof(registry)/sizeof(registry[0]) - 1;
+}
+
+const qsiot_kem *qsiot_kem_get(size_t i)
+{
+    return i < qsiot_kem_count() ? registry[i] : NULL;
+}
+
+const qsiot_kem *qsiot_kem_by_name(const char *name)
+{
+    const qsiot_kem *first = NULL;
+    size_t i;
+
+    for (i = 0; registry[i] != NULL; i++)
+        if (strcasecmp(registry[i]->name, name) == 0)
+            return registry[i];
+
+    for (i = 0; registry[i] != NULL; i++) {
+        if (registry[i]->family == NULL || strcasecmp(registry[i]->family, name) != 0)
+            continue;
+        if (registry[i]->preferred != NULL && registry[i]->preferred())
+            return registry[i];
+        if (first == NULL)
+            first = registry[i];
+    }
+    return first;
+}
+
+int qsiot_kem_keypair_batch(const qsiot_kem *kem, unsigned char *pk, unsigned char *sk, size_t n)
+{
+    size_t i;
+
+    if (kem->keypair_batch != NULL)
+        return kem->keypair_batch(pk, sk, n);
+    for (i = 0; i < n; i++)
+        if (kem->keypair(pk + i*kem->publickeybytes, sk + i*kem->secretkeybytes) != 0)
+            return -1;
+    return 0;
+}
+
+int qsiot_kem_enc_batch(const qsiot_kem *kem, unsigned char *ct, unsigned char *ss, const unsigned char *pk, size_t n)
+{
+    size_t i;
+
+    if (kem->enc_batch != NULL)
+        return kem->enc_batch(ct, ss, pk, n);
+    for (i = 0; i < n; i++)
+        if (kem->enc(ct + i*kem->ciphertextbytes, ss + i*kem->bytes, pk + i*kem->publickeybytes) != 0)
+            return -1;
+    return 0;
+}
+
+int qsiot_kem_dec_batch(const qsiot_kem *kem, unsigned char *ss, const unsigned char *ct, const unsigned char *sk, size_t n)
+{
+    size_t i;
+
+    if (kem->dec_batch != NULL)
+        return kem->dec_batch(ss, ct, sk, n);
+    for (i = 0; i < n; i++)
+        if (kem->dec(ss + i*kem->bytes, ct + i*kem->ciphertextbytes, sk + i*kem->secretkeybytes) != 0)
+            return -1;
+    return 0;
+}
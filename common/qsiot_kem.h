@@ -0,0 +1,71 @@
+#ifndef QSIOT_KEM_H
+#define QSIOT_KEM_H
+
+#include <stddef.h>
+
+/* Descriptor of one KEM: sizes and entry points behind a common signature, so
+ * a program can pick the scheme at run time. Every scheme directory defines
+ * one in qsiot.c; its namespaced library (libqsiot_<scheme>.a, or the
+ * lib<variant>.a of ntrulpr653) exports nothing else. */
+typedef struct qsiot_kem {
+    const char *name;           /* e.g. "Kyber512", "sntrup761", "FrodoKEM-640-AES" */
+    const char *family;         /* variants of one scheme share it, e.g. "FrodoKEM-640" */
+    size_t publickeybytes;
+    size_t secretkeybytes;
+    size_t ciphertextbytes;
+    size_t bytes;               /* shared secret */
+
+    int (*keypair)(unsigned char *pk, unsigned char *sk);
+    int (*enc)(unsigned char *ct, unsigned char *ss, const unsigned char *pk);
+    int (*dec)(unsigned char *ss, const unsigned char *ct, const unsigned char *sk);
+
+    /* Optional entry points, NULL when the scheme has none; the qsiot_kem_*
+     * helpers below fall back to the single-call functions. */
+
+    /* Nonzero when this is the fastest variant of its family on this CPU */
+    int (*preferred)(void);
+
+    /* n independent instances, stored back to back (pk[i*publickeybytes], ...) */
+    int (*keypair_batch)(unsigned char *pk, unsigned char *sk, size_t n);
+    int (*enc_batch)(unsigned char *ct, unsigned char *ss, const unsigned char *pk, size_t n);
+    int (*dec_batch)(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, size_t n);
+
+    /* Public key expanded once (preparedbytes) for many encapsulations */
+    size_t preparedbytes;
+    int (*prepare_pk)(unsigned char *prepared, const unsigned char *pk);
+    int (*enc_prepared)(unsigned char *ct, unsigned char *ss, const unsigned char *prepared);
+
+    /* Caller-owned workspace of scratch_bytes() bytes instead of stack temporaries */
+    size_t (*scratch_bytes)(void);
+    int (*keypair_with_scratch)(unsigned char *pk, unsigned char *sk, void *scratch);
+    int (*enc_with_scratch)(unsigned char *ct, unsigned char *ss, const unsigned char *pk, void *scratch);
+    int (*dec_with_scratch)(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, void *scratch);
+} qsiot_kem;
+
+/* Descriptors of the schemes of this tree */
+extern const qsiot_kem qsiot_kem_kyber512;
+extern const qsiot_kem qsiot_kem_lightsaber;
+extern const qsiot_kem qsiot_kem_ntruhps2048509;
+extern const qsiot_kem qsiot_kem_frodo640aes;
+extern const qsiot_kem qsiot_kem_frodo640shake;
+extern const qsiot_kem qsiot_kem_sntrup653;
+extern const qsiot_kem qsiot_kem_sntrup761;
+extern const qsiot_kem qsiot_kem_sntrup857;
+extern const qsiot_kem qsiot_kem_ntrulpr653;
+extern const qsiot_kem qsiot_kem_ntrulpr761;
+extern const qsiot_kem qsiot_kem_ntrulpr857;
+
+/* Registry (qsiot_kem.c): the schemes compiled in with -DQSIOT_HAVE_<SCHEME> */
+size_t qsiot_kem_count(void);
+const qsiot_kem *qsiot_kem_get(size_t i);
+
+/* By name, ignoring case; a family name gives its preferred variant on this
+ * CPU (or the first one registered). NULL when not compiled in. */
+const qsiot_kem *qsiot_kem_by_name(const char *name);
+
+/* Batch entry points, looping over the single-call functions when the scheme has none */
+int qsiot_kem_keypair_batch(const qsiot_kem *kem, unsigned char *pk, unsigned char *sk, size_t n);
+int qsiot_kem_enc_batch(const qsiot_kem *kem, unsigned char *ct, unsigned char *ss, const unsigned char *pk, size_t n);
+int qsiot_kem_dec_batch(const qsiot_kem *kem, unsigned char *ss, const unsigned char *ct, const unsigned char *sk, size_t n);
+
+#endif
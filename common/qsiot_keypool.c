@@ -0,0 +1,298 @@
+/* Precomputed keypair pool (see qsiot_keypool.h).
+ *
+ * The slots form a bounded ring in the manner of Vyukov's MPMC queue: slot
+ * i of lap k has sequence number k*cap + i while it is free and one more
+ * once it holds a keypair. The background thread is the only producer and
+ * writes the keypair straight into the free slot; a taker claims a full
+ * slot by advancing head with a compare-and-swap, copies the keypair out,
+ * clears it and hands the slot back for the next lap. No lock is taken on
+ * either side; the thread sleeps on a semaphore while the pool is above
+ * its low watermark, and the taker that brings it down to it posts.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#include "qsiot_keypool.h"
+#include "qsiot_wipe.h"
+
+typedef struct {
+    atomic_size_t seq;
+    unsigned char *pk, *sk;
+} keypool_slot;
+
+struct qsiot_keypool {
+    const qsiot_kem *kem;
+    size_t cap, mask;
+    size_t high, low;
+    keypool_slot *slots;
+    unsigned char *keys;                // pk || sk of every slot
+    size_t keysbytes;
+    void *scratch;                      // of the background thread, NULL without *_with_scratch
+
+    _Alignas(64) atomic_size_t head;    // next slot to take
+    _Alignas(64) atomic_size_t tail;    // next slot to fill, advanced by the thread only
+
+    atomic_int sleeping;                // the thread waits (or is about to) on wake
+    atomic_int stop;
+    sem_t wake;
+    pthread_t thread;
+
+    atomic_ullong hits, misses, generated, failures;
+    atomic_ullong refill_ns;
+};
+
+// Pause after a failed keypair, doubled per failure in a row
+#define FAIL_BACKOFF_MIN_NS 1000000ULL
+#define FAIL_BACKOFF_MAX_NS 1000000000ULL
+
+static unsigned long long now_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (unsigned long long)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+/********************************************************************************************
+* Background thread
+*********************************************************************************************/
+
+// Runs only when the CPU would otherwise idle, or at least at the lowest priority
+static void lower_priority(void)
+{
+#ifdef SCHED_IDLE
+    struct sched_param param = { .sched_priority = 0 };
+
+    if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) == 0)
+        return;
+#endif
+    setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 19);
+}
+
+// Sleeps while more than low keypairs are ready; a taker or stop posts wake
+static void refill_wait(qsiot_keypool *pool, size_t pos)
+{
+    atomic_store(&pool->sleeping, 1);
+    if (pos - atomic_load(&pool->head) > pool->low && !atomic_load(&pool->stop))
+        while (sem_wait(&pool->wake) != 0);
+    atomic_store(&pool->sleeping, 0);
+}
+
+// Pauses for ns after a failed keypair; stop posts wake and ends it early
+static void refill_backoff(qsiot_keypool *pool, unsigned long long ns)
+{
+    struct timespec until;
+
+    clock_gettime(CLOCK_REALTIME, &until);
+    ns += until.tv_nsec;
+    until.tv_sec += ns / 1000000000ULL;
+    until.tv_nsec = ns % 1000000000ULL;
+    while (!atomic_load(&pool->stop) && sem_timedwait(&pool->wake, &until) != 0 && errno == EINTR);
+}
+
+static void *refill_main(void *arg)
+{
+    qsiot_keypool *pool = arg;
+    const qsiot_kem *kem = pool->kem;
+    keypool_slot *slot;
+    unsigned long long start, backoff = FAIL_BACKOFF_MIN_NS;
+    size_t pos;
+    int r;
+
+    lower_priority();
+
+    while (!atomic_load(&pool->stop)) {
+        pos = atomic_load_explicit(&pool->tail, memory_order_relaxed);
+        if (pos - atomic_load(&pool->head) >= pool->high) {
+            refill_wait(pool, pos);
+            continue;
+        }
+        // Free unless a taker of the previous lap is still copying out
+        slot = &pool->slots[pos & pool->mask];
+        if (atomic_load_explicit(&slot->seq, memory_order_acquire) != pos) {
+            sched_yield();
+            continue;
+        }
+
+        start = now_ns();
+        if (pool->scratch != NULL)
+            r = kem->keypair_with_scratch(slot->pk, slot->sk, pool->scratch);
+        else
+            r = kem->keypair(slot->pk, slot->sk);
+        atomic_fetch_add_explicit(&pool->refill_ns, now_ns() - start, memory_order_relaxed);
+        if (r != 0) {
+            // A failure that persists must not turn the thread into a spin
+            atomic_fetch_add_explicit(&pool->failures, 1, memory_order_relaxed);
+            refill_backoff(pool, backoff);
+            if (backoff < FAIL_BACKOFF_MAX_NS) backoff *= 2;
+            continue;
+        }
+        backoff = FAIL_BACKOFF_MIN_NS;
+
+        atomic_fetch_add_explicit(&pool->generated, 1, memory_order_relaxed);
+        atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+        atomic_store(&pool->tail, pos + 1);
+    }
+    return NULL;
+}
+
+/********************************************************************************************
+* Pool
+*********************************************************************************************/
+
+static void keypool_free(qsiot_keypool *pool)
+{
+    if (pool->keys != NULL)
+        qsiot_wipe(pool->keys, pool->keysbytes);
+    if (pool->scratch != NULL)
+        qsiot_wipe(pool->scratch, pool->kem->scratch_bytes());
+    free(pool->keys);
+    free(pool->slots);
+    free(pool->scratch);
+    sem_destroy(&pool->wake);
+    free(pool);
+}
+
+qsiot_keypool *qsiot_keypool_create(const qsiot_kem *kem, size_t high, size_t low)
+{
+    qsiot_keypool *pool;
+    size_t i, cap, pairbytes;
+
+    if (high == 0) high = 1;
+    if (low >= high) low = high - 1;
+    for (cap = 1; cap < high; cap *= 2);
+
+    pool = calloc(1, sizeof(qsiot_keypool));
+    if (pool == NULL) return NULL;
+    pool->kem = kem;
+    pool->cap = cap;
+    pool->mask = cap - 1;
+    pool->high = high;
+    pool->low = low;
+    if (sem_init(&pool->wake, 0, 0) != 0) {
+        free(pool);
+        return NULL;
+    }
+
+    pairbytes = kem->publickeybytes + kem->secretkeybytes;
+    pool->keysbytes = cap * pairbytes;
+    pool->slots = calloc(cap, sizeof(keypool_slot));
+    pool->keys = malloc(pool->keysbytes);
+    if (kem->scratch_bytes != NULL && kem->keypair_with_scratch != NULL)
+        pool->scratch = aligned_alloc(64, (kem->scratch_bytes() + 63) & ~(size_t)63);
+    if (pool->slots == NULL || pool->keys == NULL) {
+        keypool_free(pool);
+        return NULL;
+    }
+    for (i = 0; i < cap; i++) {
+        atomic_init(&pool->slots[i].seq, i);
+        pool->slots[i].pk = pool->keys + i*pairbytes;
+        pool->slots[i].sk = pool->slots[i].pk + kem->publickeybytes;
+    }
+    atomic_init(&pool->head, 0);
+    atomic_init(&pool->tail, 0);
+    atomic_init(&pool->sleeping, 0);
+    atomic_init(&pool->stop, 0);
+    atomic_init(&pool->hits, 0);
+    atomic_init(&pool->misses, 0);
+    atomic_init(&pool->generated, 0);
+    atomic_init(&pool->failures, 0);
+    atomic_init(&pool->refill_ns, 0);
+
+    if (pthread_create(&pool->thread, NULL, refill_main, pool) != 0) {
+        keypool_free(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+static void wake_refill(qsiot_keypool *pool)
+{
+    if (atomic_load(&pool->sleeping) && atomic_exchange(&pool->sleeping, 0))
+        sem_post(&pool->wake);
+}
+
+int qsiot_keypool_keypair(qsiot_keypool *pool, unsigned char *pk, unsigned char *sk)
+{
+    const qsiot_kem *kem = pool->kem;
+    keypool_slot *slot;
+    size_t pos, seq;
+
+    pos = atomic_load_explicit(&pool->head, memory_order_relaxed);
+    for (;;) {
+        slot = &pool->slots[pos & pool->mask];
+        seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if (seq == pos + 1) {
+            if (atomic_compare_exchange_weak(&pool->head, &pos, pos + 1))
+                break;
+        } else if ((intptr_t)(seq - (pos + 1)) < 0) {
+            // Empty: the handshake cannot wait for the thread
+            atomic_fetch_add_explicit(&pool->misses, 1, memory_order_relaxed);
+            wake_refill(pool);
+            return kem->keypair(pk, sk);
+        } else {
+            pos = atomic_load_explicit(&pool->head, memory_order_relaxed);
+        }
+    }
+
+    memcpy(pk, slot->pk, kem->publickeybytes);
+    memcpy(sk, slot->sk, kem->secretkeybytes);
+    memset(slot->sk, 0, kem->secretkeybytes);
+    atomic_store_explicit(&slot->seq, pos + pool->cap, memory_order_release);
+
+    atomic_fetch_add_explicit(&pool->hits, 1, memory_order_relaxed);
+    if (atomic_load(&pool->tail) - (pos + 1) <= pool->low)
+        wake_refill(pool);
+    return 0;
+}
+
+size_t qsiot_keypool_available(const qsiot_keypool *pool)
+{
+    size_t head = atomic_load(&((qsiot_keypool *)pool)->head);
+    size_t tail = atomic_load(&((qsiot_keypool *)pool)->tail);
+
+    return tail > head ? tail - head : 0;
+}
+
+void qsiot_keypool_wait_filled(qsiot_keypool *pool, size_t n)
+{
+    struct timespec tick = { 0, 1000000 };
+
+    if (n > pool->high) n = pool->high;
+    // The thread may be asleep above the low watermark, so it is woken first
+    while (qsiot_keypool_available(pool) < n) {
+        wake_refill(pool);
+        nanosleep(&tick, NULL);
+    }
+}
+
+void qsiot_keypool_stats_get(const qsiot_keypool *pool, qsiot_keypool_stats *stats)
+{
+    qsiot_keypool *p = (qsiot_keypool *)pool;
+
+    stats->hits = atomic_load_explicit(&p->hits, memory_order_relaxed);
+    stats->misses = atomic_load_explicit(&p->misses, memory_order_relaxed);
+    stats->generated = atomic_load_explicit(&p->generated, memory_order_relaxed);
+    stats->failures = atomic_load_explicit(&p->failures, memory_order_relaxed);
+    stats->refill_seconds = atomic_load_explicit(&p->refill_ns, memory_order_relaxed) / 1e9;
+}
+
+void qsiot_keypool_destroy(qsiot_keypool *pool)
+{
+    atomic_store(&pool->stop, 1);
+    sem_post(&pool->wake);
+    pthread_join(pool->thread, NULL);
+    keypool_free(pool);
+}
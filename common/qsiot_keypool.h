@@ -0,0 +1,50 @@
+#ifndef QSIOT_KEYPOOL_H
+#define QSIOT_KEYPOOL_H
+
+#include <stddef.h>
+
+#include "qsiot_kem.h"
+
+/* Pool of precomputed ephemeral keypairs of one qsiot_kem.
+ *
+ * A background thread at idle priority (SCHED_IDLE, nice 19 as fallback)
+ * fills the pool up to its high watermark, sleeps, and is woken once a take
+ * leaves no more than the low watermark. Takes are lock free (a bounded ring
+ * with a sequence number per slot) and may come from any number of threads;
+ * a take from an empty pool runs the scheme's keypair inline instead. A
+ * keypair is handed out once and its slot is cleared on the way out. After
+ * a failed keypair the thread pauses, 1 ms doubling up to 1 s while the
+ * failures go on, and counts them in the stats. */
+
+typedef struct qsiot_keypool qsiot_keypool;
+
+typedef struct {
+    unsigned long long hits;        /* takes served from the pool */
+    unsigned long long misses;      /* takes that ran keypair inline */
+    unsigned long long generated;   /* keypairs made by the background thread */
+    unsigned long long failures;    /* keypair calls of the background thread that failed */
+    double refill_seconds;          /* time the background thread spent generating */
+} qsiot_keypool_stats;
+
+/* Keeps between low and high keypairs ready (low < high; low >= high counts
+ * as high-1). NULL when the thread or the memory cannot be had. */
+qsiot_keypool *qsiot_keypool_create(const qsiot_kem *kem, size_t high, size_t low);
+
+/* Writes a keypair to pk, sk, from the pool when it has one; returns the
+ * scheme's result (0 for a pooled keypair) */
+int qsiot_keypool_keypair(qsiot_keypool *pool, unsigned char *pk, unsigned char *sk);
+
+/* Keypairs ready right now */
+size_t qsiot_keypool_available(const qsiot_keypool *pool);
+
+/* Blocks until the pool holds high keypairs (or n, if smaller) */
+void qsiot_keypool_wait_filled(qsiot_keypool *pool, size_t n);
+
+/* Counters since creation; hit rate is hits/(hits+misses), refill throughput
+ * generated/refill_seconds */
+void qsiot_keypool_stats_get(const qsiot_keypool *pool, qsiot_keypool_stats *stats);
+
+/* Stops the thread, clears the unused keypairs and frees the pool */
+void qsiot_keypool_destroy(qsiot_keypool *pool);
+
+#endif
@@ -0,0 +1,28 @@
+# Namespaced library for the KEM registry (qsiot_kem.h), so that several
+# schemes can be linked into one program.
+#
+# The objects of the scheme are linked into one relocatable object, and
+# every symbol except the qsiot_kem_$(QSIOT_NAME) descriptor (and
+# $(QSIOT_KEEP)) is made local. randombytes() stays outside, in its own
+# member (with a private copy of the AES it uses): the scheme keeps an
+# undefined reference that the benchmark can wrap (RNGCOST=1), and the
+# first library linked provides it for all.
+#
+# Set before using $(qsiot_lib) as the recipe of the library:
+#   QSIOT_NAME       descriptor suffix
+#   QSIOT_KEM_OBJS   objects of the scheme, without randombytes
+#   QSIOT_RAND_OBJS  randombytes and the AES objects it uses
+#   QSIOT_OBJDIR     directory for the intermediate objects
+#   QSIOT_KEEP       further symbols to keep global (optional)
+#   QSIOT_LIB        library to write (default: the target)
+
+QSIOT_LIB ?= $@
+
+define qsiot_lib
+mkdir -p $(QSIOT_OBJDIR) $(dir $(QSIOT_LIB))
+ld -r $(QSIOT_KEM_OBJS) -o $(QSIOT_OBJDIR)/$(QSIOT_NAME)-r.o
+objcopy $(addprefix --keep-global-symbol=,qsiot_kem_$(QSIOT_NAME) $(QSIOT_KEEP)) $(QSIOT_OBJDIR)/$(QSIOT_NAME)-r.o $(QSIOT_OBJDIR)/$(QSIOT_NAME).o
+ld -r $(QSIOT_RAND_OBJS) -o $(QSIOT_OBJDIR)/randombytes-r.o
+objcopy --keep-global-symbol=randombytes --keep-global-symbol=randombytes_init $(QSIOT_OBJDIR)/randombytes-r.o $(QSIOT_OBJDIR)/randombytes.o
+rm -f $(QSIOT_LIB) && $(AR) $(QSIOT_LIB) $(QSIOT_OBJDIR)/$(QSIOT_NAME).o $(QSIOT_OBJDIR)/randombytes.o
+endef
@@ -0,0 +1,497 @@
+/* Work-stealing pool for qsiot_kem jobs (see qsiot_pool.h).
+ *
+ * The deques are short critical sections under a per-worker mutex: the owner
+ * works at the tail, thieves at the head, and a submitter from outside only
+ * appends, so contention stays on the rare steals. Idle workers sleep on one
+ * condition variable; the count of queued jobs is raised under the pool lock
+ * before the jobs are pushed, so a worker either sees it or is woken.
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "qsiot_pool.h"
+#include "qsiot_wipe.h"
+
+#define DEQUE_INITIAL 64
+
+// Longest sleep of a worker that counts queued jobs but finds none, in ns
+#define BACKOFF_MAX_NS 1000000
+
+typedef struct {
+    pthread_mutex_t lock;
+    qsiot_job **ring;
+    size_t cap;
+    size_t head, tail;                  // jobs at [head, tail), modulo cap
+} job_deque;
+
+typedef struct {
+    qsiot_pool *pool;
+    pthread_t thread;
+    int index;
+    job_deque deque;
+    void *scratch;
+    size_t scratchbytes;
+    unsigned long long jobs, steals;    // written by the worker only
+} worker;
+
+struct qsiot_pool {
+    worker *workers;
+    int nworkers;
+    int pin;
+
+    pthread_mutex_t lock;
+    pthread_cond_t work;                // jobs were queued, or stop
+    int sleepers;                       // workers waiting on work
+    pthread_cond_t idle;                // outstanding reached 0
+    pthread_cond_t completed;           // the completion queue is not empty
+    atomic_size_t queued;               // jobs in the deques
+    size_t outstanding;                 // submitted, not yet completed
+    atomic_uint next;                   // round robin of outside submissions
+    int stop;
+
+    qsiot_job *done_head, *done_tail;   // completion queue
+};
+
+static __thread worker *current_worker;
+
+/********************************************************************************************
+* Deques
+*********************************************************************************************/
+
+static int deque_init(job_deque *d)
+{
+    d->ring = malloc(DEQUE_INITIAL * sizeof(qsiot_job *));
+    if (d->ring == NULL) return -1;
+    d->cap = DEQUE_INITIAL;
+    d->head = d->tail = 0;
+    pthread_mutex_init(&d->lock, NULL);
+    return 0;
+}
+
+static void deque_free(job_deque *d)
+{
+    pthread_mutex_destroy(&d->lock);
+    free(d->ring);
+}
+
+// Appends jobs[0..n) at the tail; they keep their order for the thieves. A
+// larger ring is allocated with the lock released, so the thieves never wait
+// on malloc; -1 (nothing appended) when it cannot be had.
+static int deque_push(job_deque *d, qsiot_job **jobs, size_t n)
+{
+    qsiot_job **ring = NULL, **old = NULL;
+    size_t i, cap = 0;
+
+    pthread_mutex_lock(&d->lock);
+    while (d->tail - d->head + n > d->cap) {
+        // Another push may have filled the deque while the lock was released
+        if (d->tail - d->head + n > cap) {
+            for (cap = d->cap; d->tail - d->head + n > cap; cap *= 2);
+            pthread_mutex_unlock(&d->lock);
+            free(ring);
+            ring = malloc(cap * sizeof(qsiot_job *));
+            if (ring == NULL) return -1;
+            pthread_mutex_lock(&d->lock);
+            continue;
+        }
+        for (i = d->head; i < d->tail; i++)
+            ring[i - d->head] = d->ring[i % d->cap];
+        old = d->ring;
+        d->ring = ring;
+        d->tail -= d->head;
+        d->head = 0;
+        d->cap = cap;
+        ring = NULL;
+    }
+    for (i = 0; i < n; i++)
+        d->ring[d->tail++ % d->cap] = jobs[i];
+    pthread_mutex_unlock(&d->lock);
+    free(old);
+    free(ring);                         // unused when another push grew the deque meanwhile
+    return 0;
+}
+
+// Newest job, for the owner
+static qsiot_job *deque_pop(job_deque *d)
+{
+    qsiot_job *job = NULL;
+
+    pthread_mutex_lock(&d->lock);
+    if (d->tail != d->head)
+        job = d->ring[--d->tail % d->cap];
+    pthread_mutex_unlock(&d->lock);
+    return job;
+}
+
+// Oldest job, for a thief; unless wait, NULL when the deque is busy
+static qsiot_job *deque_steal(job_deque *d, int wait)
+{
+    qsiot_job *job = NULL;
+
+    if (wait)
+        pthread_mutex_lock(&d->lock);
+    else if (pthread_mutex_trylock(&d->lock) != 0)
+        return NULL;
+    if (d->tail != d->head)
+        job = d->ring[d->head++ % d->cap];
+    pthread_mutex_unlock(&d->lock);
+    return job;
+}
+
+/********************************************************************************************
+* Workers
+*********************************************************************************************/
+
+// Scratch arena of the worker for kem, NULL when the scheme has none (or it cannot be allocated)
+static void *worker_scratch(worker *w, const qsiot_kem *kem)
+{
+    size_t need;
+    void *p;
+
+    if (kem->scratch_bytes == NULL) return NULL;
+    need = kem->scratch_bytes();
+    if (need > w->scratchbytes) {
+        p = aligned_alloc(64, (need + 63) & ~(size_t)63);
+        if (p == NULL) return NULL;
+        qsiot_wipe(w->scratch, w->scratchbytes);
+        free(w->scratch);
+        w->scratch = p;
+        w->scratchbytes = need;
+    }
+    return w->scratch;
+}
+
+static int run_job(worker *w, qsiot_job *job)
+{
+    const qsiot_kem *kem = job->kem;
+    void *scratch;
+
+    if (job->n > 1) {
+        switch (job->op) {
+        case QSIOT_JOB_KEYPAIR: return qsiot_kem_keypair_batch(kem, job->pk, job->sk, job->n);
+        case QSIOT_JOB_ENC: return qsiot_kem_enc_batch(kem, job->ct, job->ss, job->pk, job->n);
+        case QSIOT_JOB_DEC: return qsiot_kem_dec_batch(kem, job->ss, job->ct, job->sk, job->n);
+        }
+        return -1;
+    }
+
+    scratch = worker_scratch(w, kem);
+    switch (job->op) {
+    case QSIOT_JOB_KEYPAIR:
+        if (scratch != NULL && kem->keypair_with_scratch != NULL)
+            return kem->keypair_with_scratch(job->pk, job->sk, scratch);
+        return kem->keypair(job->pk, job->sk);
+    case QSIOT_JOB_ENC:
+        if (scratch != NULL && kem->enc_with_scratch != NULL)
+            return kem->enc_with_scratch(job->ct, job->ss, job->pk, scratch);
+        return kem->enc(job->ct, job->ss, job->pk);
+    case QSIOT_JOB_DEC:
+        if (scratch != NULL && kem->dec_with_scratch != NULL)
+            return kem->dec_with_scratch(job->ss, job->ct, job->sk, scratch);
+        return kem->dec(job->ss, job->ct, job->sk);
+    }
+    return -1;
+}
+
+static void complete_job(qsiot_pool *pool, qsiot_job *job)
+{
+    if (job->done != NULL) {
+        job->done(job, job->arg);
+        pthread_mutex_lock(&pool->lock);
+    } else {
+        pthread_mutex_lock(&pool->lock);
+        job->next = NULL;
+        if (pool->done_tail != NULL)
+            pool->done_tail->next = job;
+        else
+            pool->done_head = job;
+        pool->done_tail = job;
+        pthread_cond_signal(&pool->completed);
+    }
+    if (--pool->outstanding == 0)
+        pthread_cond_broadcast(&pool->idle);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Own newest job, or another worker's oldest; wait takes the locks of busy deques
+static qsiot_job *find_job(worker *w, int wait)
+{
+    qsiot_pool *pool = w->pool;
+    qsiot_job *job;
+    int i;
+
+    if ((job = deque_pop(&w->deque)) != NULL)
+        return job;
+    for (i = 1; i < pool->nworkers; i++) {
+        job = deque_steal(&pool->workers[(w->index + i) % pool->nworkers].deque, wait);
+        if (job != NULL) {
+            w->steals++;
+            return job;
+        }
+    }
+    return NULL;
+}
+
+static void pin_worker(worker *w)
+{
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t set;
+
+    if (ncpu < 1) return;
+    CPU_ZERO(&set);
+    CPU_SET(w->index % ncpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+// Sleeps on work for ns at most; the caller holds the pool lock
+static void backoff_wait(qsiot_pool *pool, long ns)
+{
+    struct timespec until;
+
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_nsec += ns;
+    if (until.tv_nsec >= 1000000000L) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000L;
+    }
+    pool->sleepers++;
+    pthread_cond_timedwait(&pool->work, &pool->lock, &until);
+    pool->sleepers--;
+}
+
+static void *worker_main(void *arg)
+{
+    worker *w = arg;
+    qsiot_pool *pool = w->pool;
+    qsiot_job *job;
+    long backoff = 0;
+
+    current_worker = w;
+    if (pool->pin) pin_worker(w);
+
+    for (;;) {
+        job = find_job(w, 0);
+        // A trylock may have missed the jobs counted in queued: look again, waiting for the locks
+        if (job == NULL && atomic_load(&pool->queued) > 0)
+            job = find_job(w, 1);
+        if (job != NULL) {
+            atomic_fetch_sub(&pool->queued, 1);
+            job->result = run_job(w, job);
+            w->jobs++;
+            complete_job(pool, job);
+            backoff = 0;
+            continue;
+        }
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->stop && atomic_load(&pool->queued) == 0) {
+            pool->sleepers++;
+            pthread_cond_wait(&pool->work, &pool->lock);
+            pool->sleepers--;
+            backoff = 0;
+        }
+        if (pool->stop && atomic_load(&pool->queued) == 0) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        // Counted but in no deque: still being pushed, or just taken by another worker.
+        // The push signals work; the doubling timeout bounds the wait otherwise.
+        if (atomic_load(&pool->queued) > 0 && backoff > 0)
+            backoff_wait(pool, backoff);
+        backoff = backoff == 0 ? 1000 : backoff < BACKOFF_MAX_NS / 2 ? 2 * backoff : BACKOFF_MAX_NS;
+        pthread_mutex_unlock(&pool->lock);
+    }
+    return NULL;
+}
+
+/********************************************************************************************
+* Pool
+*********************************************************************************************/
+
+// Stops the first nstarted workers and frees the pool with its first ndeques deques
+static void pool_free(qsiot_pool *pool, int ndeques, int nstarted)
+{
+    int i;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < nstarted; i++)
+        pthread_join(pool->workers[i].thread, NULL);
+    for (i = 0; i < ndeques; i++) {
+        deque_free(&pool->workers[i].deque);
+        qsiot_wipe(pool->workers[i].scratch, pool->workers[i].scratchbytes);
+        free(pool->workers[i].scratch);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work);
+    pthread_cond_destroy(&pool->idle);
+    pthread_cond_destroy(&pool->completed);
+    free(pool->workers);
+    free(pool);
+}
+
+qsiot_pool *qsiot_pool_create(int nthreads, int pin)
+{
+    qsiot_pool *pool;
+    int i, started;
+
+    if (nthreads <= 0) nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (nthreads <= 0) nthreads = 1;
+
+    pool = calloc(1, sizeof(qsiot_pool));
+    if (pool == NULL) return NULL;
+    pool->workers = calloc(nthreads, sizeof(worker));
+    if (pool->workers == NULL) {
+        free(pool);
+        return NULL;
+    }
+    pool->nworkers = nthreads;
+    pool->pin = pin;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+    pthread_cond_init(&pool->completed, NULL);
+    atomic_init(&pool->queued, 0);
+    atomic_init(&pool->next, 0);
+
+    for (i = 0; i < nthreads; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        if (deque_init(&pool->workers[i].deque) != 0) {
+            pool_free(pool, i, 0);
+            return NULL;
+        }
+    }
+    for (started = 0; started < nthreads; started++) {
+        if (pthread_create(&pool->workers[started].thread, NULL, worker_main, &pool->workers[started]) != 0) {
+            pool_free(pool, nthreads, started);
+            return NULL;
+        }
+    }
+    return pool;
+}
+
+int qsiot_pool_threads(const qsiot_pool *pool)
+{
+    return pool->nworkers;
+}
+
+static int push_jobs(qsiot_pool *pool, worker *w, qsiot_job **jobs, size_t n)
+{
+    size_t i;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->outstanding += n;
+    atomic_fetch_add(&pool->queued, n);
+    pthread_mutex_unlock(&pool->lock);
+
+    if (deque_push(&w->deque, jobs, n) != 0) {
+        pthread_mutex_lock(&pool->lock);
+        atomic_fetch_sub(&pool->queued, n);
+        pool->outstanding -= n;
+        if (pool->outstanding == 0)
+            pthread_cond_broadcast(&pool->idle);
+        pthread_mutex_unlock(&pool->lock);
+        return -1;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    if (n >= (size_t)pool->sleepers)
+        pthread_cond_broadcast(&pool->work);
+    else
+        for (i = 0; i < n; i++)
+            pthread_cond_signal(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+    return 0;
+}
+
+int qsiot_pool_submit(qsiot_pool *pool, qsiot_job *job)
+{
+    worker *w = current_worker;
+
+    if (w == NULL || w->pool != pool)
+        w = &pool->workers[atomic_fetch_add(&pool->next, 1) % pool->nworkers];
+    return push_jobs(pool, w, &job, 1);
+}
+
+size_t qsiot_pool_submit_many(qsiot_pool *pool, qsiot_job *jobs, size_t n)
+{
+    qsiot_job *chunk[DEQUE_INITIAL];
+    size_t i, k = 0;
+    worker *w = current_worker;
+
+    // Consecutive jobs go to the same deque in chunks, which the other workers then steal from
+    for (i = 0; i < n; i++) {
+        chunk[k++] = &jobs[i];
+        if (k == DEQUE_INITIAL || i == n - 1) {
+            if (current_worker == NULL || current_worker->pool != pool)
+                w = &pool->workers[atomic_fetch_add(&pool->next, 1) % pool->nworkers];
+            if (push_jobs(pool, w, chunk, k) != 0)
+                return i + 1 - k;
+            k = 0;
+        }
+    }
+    return n;
+}
+
+qsiot_job *qsiot_pool_poll_completion(qsiot_pool *pool)
+{
+    qsiot_job *job;
+
+    pthread_mutex_lock(&pool->lock);
+    job = pool->done_head;
+    if (job != NULL) {
+        pool->done_head = job->next;
+        if (pool->done_head == NULL) pool->done_tail = NULL;
+        job->next = NULL;
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return job;
+}
+
+qsiot_job *qsiot_pool_wait_completion(qsiot_pool *pool)
+{
+    qsiot_job *job;
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->done_head == NULL)
+        pthread_cond_wait(&pool->completed, &pool->lock);
+    job = pool->done_head;
+    pool->done_head = job->next;
+    if (pool->done_head == NULL) pool->done_tail = NULL;
+    job->next = NULL;
+    pthread_mutex_unlock(&pool->lock);
+    return job;
+}
+
+void qsiot_pool_wait_idle(qsiot_pool *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    while (pool->outstanding > 0)
+        pthread_cond_wait(&pool->idle, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void qsiot_pool_stats(const qsiot_pool *pool, unsigned long long *jobs, unsigned long long *steals)
+{
+    int i;
+
+    *jobs = *steals = 0;
+    for (i = 0; i < pool->nworkers; i++) {
+        *jobs += pool->workers[i].jobs;
+        *steals += pool->workers[i].steals;
+    }
+}
+
+void qsiot_pool_destroy(qsiot_pool *pool)
+{
+    pool_free(pool, pool->nworkers, pool->nworkers);
+}
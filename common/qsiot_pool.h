@@ -0,0 +1,71 @@
+#ifndef QSIOT_POOL_H
+#define QSIOT_POOL_H
+
+#include <stddef.h>
+
+#include "qsiot_kem.h"
+
+/* Thread pool running keygen/encaps/decaps jobs of any qsiot_kem.
+ *
+ * Every worker owns a deque of jobs: it pops the newest of its own and, when
+ * that is empty, steals the oldest of another worker. Jobs submitted from
+ * outside are spread over the deques round robin, jobs submitted from a
+ * completion callback go to the deque of the calling worker. Workers can be
+ * pinned one per CPU. Each worker keeps a scratch arena for the schemes with
+ * *_with_scratch entry points, and draws randomness from its own per-thread
+ * generator (common/randombytes.c), so no two workers share state. */
+
+typedef enum {
+    QSIOT_JOB_KEYPAIR,      /* writes pk, sk */
+    QSIOT_JOB_ENC,          /* reads pk, writes ct, ss */
+    QSIOT_JOB_DEC           /* reads ct, sk, writes ss */
+} qsiot_job_op;
+
+typedef struct qsiot_job {
+    const qsiot_kem *kem;
+    qsiot_job_op op;
+    size_t n;               /* instances, back to back as for the batch entry points; 0 counts as 1 */
+    unsigned char *pk, *sk, *ct, *ss;
+
+    /* Called on the worker thread once the job is done; when NULL the job
+     * goes to the completion queue of the pool instead. */
+    void (*done)(struct qsiot_job *job, void *arg);
+    void *arg;
+
+    int result;             /* return value of the scheme, set before completion */
+    struct qsiot_job *next; /* owned by the pool while the job is in flight */
+} qsiot_job;
+
+typedef struct qsiot_pool qsiot_pool;
+
+/* nthreads <= 0 starts one worker per online CPU; pin binds worker i to CPU
+ * i modulo the number of CPUs. NULL when the threads cannot be started. */
+qsiot_pool *qsiot_pool_create(int nthreads, int pin);
+
+int qsiot_pool_threads(const qsiot_pool *pool);
+
+/* The job (or the n jobs of the array) must stay alive until completed.
+ * submit returns 0, or -1 when the job's deque cannot grow (out of memory)
+ * and the job was not submitted; submit_many returns how many jobs from the
+ * start of the array were submitted, n unless memory ran out. */
+int qsiot_pool_submit(qsiot_pool *pool, qsiot_job *job);
+size_t qsiot_pool_submit_many(qsiot_pool *pool, qsiot_job *jobs, size_t n);
+
+/* Next job of the completion queue, in completion order; wait_completion
+ * blocks until there is one, poll_completion returns NULL instead. */
+qsiot_job *qsiot_pool_wait_completion(qsiot_pool *pool);
+qsiot_job *qsiot_pool_poll_completion(qsiot_pool *pool);
+
+/* Blocks until every submitted job is completed (its callback returned, or
+ * it is in the completion queue). */
+void qsiot_pool_wait_idle(qsiot_pool *pool);
+
+/* Jobs run and jobs taken from another worker's deque since creation;
+ * consistent after qsiot_pool_wait_idle. */
+void qsiot_pool_stats(const qsiot_pool *pool, unsigned long long *jobs, unsigned long long *steals);
+
+/* Runs the remaining jobs, then stops and frees the workers. Jobs still in
+ * the completion queue are left to the caller. */
+void qsiot_pool_destroy(qsiot_pool *pool);
+
+#endif
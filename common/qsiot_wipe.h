@@ -0,0 +1,19 @@
+#ifndef QSIOT_WIPE_H
+#define QSIOT_WIPE_H
+
+#include <stddef.h>
+
+/* Zeroes len bytes at p. Keys, seeds and the scratch of a finished operation
+ * are usually wiped right before they are freed or go out of scope, where a
+ * plain memset is a dead store the compiler may drop; the volatile stores
+ * here are always kept. */
+static inline void qsiot_wipe(void *p, size_t len)
+{
+    volatile unsigned char *v = (volatile unsigned char *)p;
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        v[i] = 0;
+}
+
+#endif
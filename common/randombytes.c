@@ -0,0 +1,235 @@
+/* randombytes() shared by the KEMs.
+ *
+ * The default generator is per thread: a 256-bit AES key drawn from the
+ * kernel (getrandom(), /dev/urandom as fallback) runs AES-256-CTR into a
+ * buffer whose first 32 bytes immediately rekey the generator ("fast key
+ * erasure"), so earlier output cannot be recomputed from the live state and
+ * the kernel is entered once per thread instead of once per call. No lock is
+ * taken on this path.
+ *
+ * randombytes_init() switches to the NIST AES-256 CTR_DRBG of the reference
+ * rng.c, which the KAT generators need to reproduce the published vectors.
+ * Both generators use the AES of aes.c (AES-NI or bitsliced). Seeds and
+ * key material are wiped with qsiot_wipe() once used, and a thread's
+ * generator state when the thread exits.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "aes.h"
+#include "qsiot_wipe.h"
+#include "randombytes.h"
+
+/* Keystream produced per refill, the 32 bytes of the next key included */
+#define RNG_BUFBYTES 1024
+
+/********************************************************************************************
+* Kernel entropy
+*********************************************************************************************/
+
+static void randombytes_fallback(unsigned char *x, size_t xlen)
+{
+    static int fd = -1;
+    ssize_t r;
+
+    while (fd == -1) {
+        fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+        if (fd == -1) sleep(1);
+    }
+    while (xlen > 0) {
+        r = read(fd, x, xlen < 1048576 ? xlen : 1048576);
+        if (r < 1) {
+            if (r < 0 && errno == EINTR) continue;
+            sleep(1);
+            continue;
+        }
+        x += r;
+        xlen -= r;
+    }
+}
+
+static void randombytes_kernel(unsigned char *x, size_t xlen)
+{
+#ifdef SYS_getrandom
+    long r;
+
+    while (xlen > 0) {
+        r = syscall(SYS_getrandom, x, xlen, 0);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            randombytes_fallback(x, xlen);
+            return;
+        }
+        x += r;
+        xlen -= r;
+    }
+#else
+    randombytes_fallback(x, xlen);
+#endif
+}
+
+/********************************************************************************************
+* Per-thread AES-256-CTR generator
+*********************************************************************************************/
+
+typedef struct {
+    aes_ctx key;
+    unsigned char buf[RNG_BUFBYTES];
+    unsigned int pos;                       // first unused byte of buf
+    int seeded;
+} rng_state;
+
+static __thread rng_state rng;
+
+static pthread_once_t rng_once = PTHREAD_ONCE_INIT;
+static pthread_key_t rng_exit_key;
+
+// A forked child would otherwise replay its parent's stream
+static void rng_atfork_child(void)
+{
+    qsiot_wipe(&rng, sizeof(rng));
+}
+
+// Destructor of rng_exit_key, which every seeded thread sets to its own rng
+static void rng_thread_exit(void *state)
+{
+    qsiot_wipe(state, sizeof(rng_state));
+}
+
+static void rng_once_init(void)
+{
+    pthread_atfork(NULL, NULL, rng_atfork_child);
+    pthread_key_create(&rng_exit_key, rng_thread_exit);
+}
+
+static void rng_refill(void)
+{
+    static const unsigned char zero[16];
+
+    // Every key encrypts one buffer from counter 0 and is then replaced
+    aes_ctr(rng.buf, RNG_BUFBYTES, zero, &rng.key);
+    aes256_keyexp(&rng.key, rng.buf);
+    memset(rng.buf, 0, 32);
+    rng.pos = 32;
+}
+
+static void rng_seed(void)
+{
+    unsigned char seed[32];
+
+    pthread_once(&rng_once, rng_once_init);
+    pthread_setspecific(rng_exit_key, &rng);
+    randombytes_kernel(seed, sizeof(seed));
+    aes256_keyexp(&rng.key, seed);
+    qsiot_wipe(seed, sizeof(seed));
+    rng.pos = RNG_BUFBYTES;
+    rng.seeded = 1;
+}
+
+/********************************************************************************************
+* NIST KAT mode: AES-256 CTR_DRBG (no derivation function, no reseeding)
+*********************************************************************************************/
+
+static struct {
+    aes_ctx key;
+    unsigned char V[16];
+} drbg;
+// Set under drbg_lock by randombytes_init(); may flip while other threads draw
+static atomic_int kat_mode = 0;
+static pthread_mutex_t drbg_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// V += n, big endian
+static void ctr_add(unsigned char *V, unsigned long long n)
+{
+    int i;
+
+    for (i = 15; i >= 0 && n; i--) {
+        n += V[i];
+        V[i] = (unsigned char)n;
+        n >>= 8;
+    }
+}
+
+static void drbg_update(const unsigned char *provided_data)
+{
+    unsigned char temp[48];
+    int i;
+
+    ctr_add(drbg.V, 1);
+    aes_ctr(temp, sizeof(temp), drbg.V, &drbg.key);
+    if (provided_data != NULL)
+        for (i = 0; i < 48; i++)
+            temp[i] ^= provided_data[i];
+    aes256_keyexp(&drbg.key, temp);
+    memcpy(drbg.V, temp + 32, 16);
+    qsiot_wipe(temp, sizeof(temp));
+}
+
+static void drbg_generate(unsigned char *x, unsigned long long xlen)
+{
+    if (xlen > 0) {
+        ctr_add(drbg.V, 1);
+        aes_ctr(x, xlen, drbg.V, &drbg.key);
+        // V ends at the last block used; a partial block is discarded
+        ctr_add(drbg.V, (xlen + 15) / 16 - 1);
+    }
+    drbg_update(NULL);
+}
+
+void randombytes_init(unsigned char *entropy_input,
+                      unsigned char *personalization_string,
+                      int security_strength)
+{
+    static const unsigned char zero[32];
+    unsigned char seed_material[48];
+    int i;
+
+    (void)security_strength;
+    memcpy(seed_material, entropy_input, 48);
+    if (personalization_string)
+        for (i = 0; i < 48; i++)
+            seed_material[i] ^= personalization_string[i];
+
+    pthread_mutex_lock(&drbg_lock);
+    aes256_keyexp(&drbg.key, zero);
+    memset(drbg.V, 0, 16);
+    drbg_update(seed_material);
+    atomic_store_explicit(&kat_mode, 1, memory_order_release);
+    pthread_mutex_unlock(&drbg_lock);
+    qsiot_wipe(seed_material, sizeof(seed_material));
+}
+
+/********************************************************************************************
+* randombytes
+*********************************************************************************************/
+
+int randombytes(unsigned char *x, unsigned long long xlen)
+{
+    unsigned int n;
+
+    if (atomic_load_explicit(&kat_mode, memory_order_acquire)) {
+        pthread_mutex_lock(&drbg_lock);
+        drbg_generate(x, xlen);
+        pthread_mutex_unlock(&drbg_lock);
+        return 0;
+    }
+
+    if (!rng.seeded) rng_seed();
+    while (xlen > 0) {
+        if (rng.pos == RNG_BUFBYTES) rng_refill();
+        n = RNG_BUFBYTES - rng.pos;
+        if (n > xlen) n = (unsigned int)xlen;
+        memcpy(x, rng.buf + rng.pos, n);
+        memset(rng.buf + rng.pos, 0, n);    // handed-out bytes do not stay in memory
+        rng.pos += n;
+        x += n;
+        xlen -= n;
+    }
+    return 0;
+}
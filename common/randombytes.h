@@ -0,0 +1,18 @@
+#ifndef RANDOMBYTES_H
+#define RANDOMBYTES_H
+
+/* Fill x with xlen random bytes. Thread-safe: every thread owns a buffered
+ * AES-256-CTR generator keyed from getrandom() on first use (and again in a
+ * forked child), wiped when the thread exits. Always returns 0. */
+int randombytes(unsigned char *x, unsigned long long xlen);
+
+/* NIST KAT mode: after this call every thread draws from one shared NIST
+ * SP 800-90A AES-256 CTR_DRBG seeded with the 48-byte entropy_input
+ * (xored with personalization_string when not NULL), so the output matches
+ * the reference rng.c of the PQC submissions. Calling it again reseeds.
+ * May be called while other threads draw; they switch at their next call. */
+void randombytes_init(unsigned char *entropy_input,
+                      unsigned char *personalization_string,
+                      int security_strength);
+
+#endif
@@ -0,0 +1,226 @@
+/* Four-way SHA-512 for the hashes of NTRU Prime.
+ *
+ * As in fips202x4.c, the four states are kept interleaved, word i of
+ * instance k at s[4*i + k], so that one AVX2 register holds the same word
+ * of all four and the 80 rounds run on the four at once. The AVX2 code is
+ * used when the CPU supports it (checked at run time); otherwise each
+ * instance goes through the scalar compression function.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "sha512x4.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SHA512_HAVE_AVX2
+#include <immintrin.h>
+#endif
+
+#define SHA512_BLOCKBYTES 128
+
+static const uint64_t K[80] = {
+  0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+  0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+  0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+  0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+  0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+  0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+  0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+  0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+  0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+  0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+  0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+  0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+  0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+  0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+  0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+  0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+  0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+  0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+  0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+  0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+static const uint64_t IV[8] = {
+  0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+  0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+/* SHA-512 words are big-endian */
+static uint64_t load64_be(const unsigned char *x)
+{
+  uint64_t r = 0;
+  unsigned int i;
+
+  for (i = 0; i < 8; ++i)
+    r = (r << 8) | x[i];
+  return r;
+}
+
+static void store64_be(unsigned char *x, uint64_t u)
+{
+  int i;
+
+  for (i = 7; i >= 0; --i) {
+    x[i] = (unsigned char)u;
+    u >>= 8;
+  }
+}
+
+/********************************************************************************************
+* AVX2 backend
+*********************************************************************************************/
+
+#ifdef SHA512_HAVE_AVX2
+
+#define AVX2 __attribute__((target("avx2")))
+
+#define ADD(a, b) _mm256_add_epi64(a, b)
+#define XOR(a, b) _mm256_xor_si256(a, b)
+#define ROR64(a, n) _mm256_or_si256(_mm256_srli_epi64(a, n), _mm256_slli_epi64(a, 64-(n)))
+#define SHR64(a, n) _mm256_srli_epi64(a, n)
+#define CH(e, f, g) XOR(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g))
+#define MAJ(a, b, c) XOR(_mm256_and_si256(a, XOR(b, c)), _mm256_and_si256(b, c))
+#define SIGMA0(a) XOR(XOR(ROR64(a, 28), ROR64(a, 34)), ROR64(a, 39))
+#define SIGMA1(e) XOR(XOR(ROR64(e, 14), ROR64(e, 18)), ROR64(e, 41))
+#define sigma0(w) XOR(XOR(ROR64(w, 1), ROR64(w, 8)), SHR64(w, 7))
+#define sigma1(w) XOR(XOR(ROR64(w, 19), ROR64(w, 61)), SHR64(w, 6))
+
+/* One block of each of the four inputs */
+static AVX2 void sha512x4_block_avx2(uint64_t *state, const unsigned char *in[4])
+{
+  __m256i S[8], V[8], W[16], T1, T2;
+  unsigned int i;
+
+  for (i = 0; i < 8; ++i)
+    S[i] = V[i] = _mm256_loadu_si256((const __m256i *)(state + 4*i));
+  for (i = 0; i < 16; ++i)
+    W[i] = _mm256_set_epi64x((long long)load64_be(in[3] + 8*i), (long long)load64_be(in[2] + 8*i),
+                             (long long)load64_be(in[1] + 8*i), (long long)load64_be(in[0] + 8*i));
+
+  for (i = 0; i < 80; ++i) {
+    if (i >= 16)
+      W[i & 15] = ADD(ADD(W[i & 15], sigma0(W[(i+1) & 15])), ADD(W[(i+9) & 15], sigma1(W[(i+14) & 15])));
+    T1 = ADD(ADD(V[7], SIGMA1(V[4])), ADD(CH(V[4], V[5], V[6]), ADD(_mm256_set1_epi64x((long long)K[i]), W[i & 15])));
+    T2 = ADD(SIGMA0(V[0]), MAJ(V[0], V[1], V[2]));
+    V[7] = V[6];
+    V[6] = V[5];
+    V[5] = V[4];
+    V[4] = ADD(V[3], T1);
+    V[3] = V[2];
+    V[2] = V[1];
+    V[1] = V[0];
+    V[0] = ADD(T1, T2);
+  }
+
+  for (i = 0; i < 8; ++i)
+    _mm256_storeu_si256((__m256i *)(state + 4*i), ADD(S[i], V[i]));
+}
+
+static int avx2_available(void)
+{
+  return __builtin_cpu_supports("avx2");
+}
+
+#else
+
+static int avx2_available(void)
+{
+  return 0;
+}
+
+#endif
+
+/********************************************************************************************
+* Scalar backend
+*********************************************************************************************/
+
+#define ROR(x, n) (((x) >> (n)) | ((x) << (64-(n))))
+
+/* One block of instance k */
+static void sha512x4_block_ref(uint64_t *state, unsigned int k, const unsigned char *in)
+{
+  uint64_t v[8], w[16], t1, t2;
+  unsigned int i;
+
+  for (i = 0; i < 8; ++i)
+    v[i] = state[4*i + k];
+  for (i = 0; i < 16; ++i)
+    w[i] = load64_be(in + 8*i);
+
+  for (i = 0; i < 80; ++i) {
+    if (i >= 16)
+      w[i & 15] += (ROR(w[(i+1) & 15], 1) ^ ROR(w[(i+1) & 15], 8) ^ (w[(i+1) & 15] >> 7)) + w[(i+9) & 15]
+                 + (ROR(w[(i+14) & 15], 19) ^ ROR(w[(i+14) & 15], 61) ^ (w[(i+14) & 15] >> 6));
+    t1 = v[7] + (ROR(v[4], 14) ^ ROR(v[4], 18) ^ ROR(v[4], 41)) + ((v[4] & v[5]) ^ (~v[4] & v[6])) + K[i] + w[i & 15];
+    t2 = (ROR(v[0], 28) ^ ROR(v[0], 34) ^ ROR(v[0], 39)) + ((v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]));
+    v[7] = v[6];
+    v[6] = v[5];
+    v[5] = v[4];
+    v[4] = v[3] + t1;
+    v[3] = v[2];
+    v[2] = v[1];
+    v[1] = v[0];
+    v[0] = t1 + t2;
+  }
+
+  for (i = 0; i < 8; ++i)
+    state[4*i + k] += v[i];
+}
+
+/********************************************************************************************
+* API
+*********************************************************************************************/
+
+static void sha512x4_blocks(uint64_t *state, int avx2, const unsigned char *in[4], unsigned long long nblocks)
+{
+  unsigned int k;
+
+  (void)avx2;
+  while (nblocks > 0) {
+#ifdef SHA512_HAVE_AVX2
+    if (avx2)
+      sha512x4_block_avx2(state, in);
+    else
+#endif
+      for (k = 0; k < 4; ++k)
+        sha512x4_block_ref(state, k, in[k]);
+    for (k = 0; k < 4; ++k)
+      in[k] += SHA512_BLOCKBYTES;
+    nblocks--;
+  }
+}
+
+void sha512x4(unsigned char *out0, unsigned char *out1, unsigned char *out2, unsigned char *out3,
+              const unsigned char *in0, const unsigned char *in1, const unsigned char *in2, const unsigned char *in3, unsigned long long inlen)
+{
+  const unsigned char *in[4] = {in0, in1, in2, in3};
+  unsigned char *out[4] = {out0, out1, out2, out3};
+  unsigned char t[4][2*SHA512_BLOCKBYTES];
+  uint64_t state[4*8];
+  unsigned long long nblocks = inlen / SHA512_BLOCKBYTES;
+  unsigned int i, k, rest = (unsigned int)(inlen % SHA512_BLOCKBYTES);
+  unsigned int padblocks = rest < SHA512_BLOCKBYTES - 16 ? 1 : 2;
+  int avx2 = avx2_available();
+
+  for (i = 0; i < 8; ++i)
+    for (k = 0; k < 4; ++k)
+      state[4*i + k] = IV[i];
+  sha512x4_blocks(state, avx2, in, nblocks);
+
+  /* The tail, 0x80, zeros and the 128-bit length in bits */
+  for (k = 0; k < 4; ++k) {
+    memset(t[k], 0, sizeof(t[k]));
+    memcpy(t[k], in[k], rest);
+    t[k][rest] = 0x80;
+    store64_be(t[k] + padblocks*SHA512_BLOCKBYTES - 16, inlen >> 61);
+    store64_be(t[k] + padblocks*SHA512_BLOCKBYTES - 8, inlen << 3);
+    in[k] = t[k];
+  }
+  sha512x4_blocks(state, avx2, in, padblocks);
+
+  for (k = 0; k < 4; ++k)
+    for (i = 0; i < 8; ++i)
+      store64_be(out[k] + 8*i, state[4*i + k]);
+}
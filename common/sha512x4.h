@@ -0,0 +1,8 @@
+#ifndef SHA512X4_H
+#define SHA512X4_H
+
+/* Four SHA-512 digests (64 bytes each) of inputs of equal length */
+void sha512x4(unsigned char *out0, unsigned char *out1, unsigned char *out2, unsigned char *out3,
+              const unsigned char *in0, const unsigned char *in1, const unsigned char *in2, const unsigned char *in3, unsigned long long inlen);
+
+#endif
@@ -0,0 +1,45 @@
+/**
+ * Microbenchmark for the shared sorting network. Reports the median number of cycles
+ * needed to sort arrays of the sizes used by the NTRU samplers:
+ *      -508 words for sample_fixed_type in NTRU-HPS2048509.
+ *      -653, 761 and 857 words for Short_fromlist in NTRU LPRime.
+ * Build with "make sortbench" for the AVX2 network, or "make sortbench_ref" for the
+ * portable one.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "crypto_sort.h"
+#include "../performance.h"
+
+#define REPS 1001
+
+static int compare(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+int main()
+{
+    long long sizes[] = {508, 653, 761, 857};
+    static uint32_t x[857];
+    static double cycles[REPS];
+    int i, j, s;
+    double low;
+
+    for (s = 0; s < 4; s++)
+    {
+        for (i = 0; i < REPS; i++)
+        {
+            for (j = 0; j < sizes[s]; j++)
+                x[j] = (uint32_t)rand() ^ ((uint32_t)rand() << 16);
+            low = (double) rdtsc();
+            crypto_sort_uint32(x, sizes[s]);
+            cycles[i] = (double) rdtsc() - low;
+        }
+        qsort(cycles, REPS, sizeof(double), compare);
+        printf("n = %4lld: %10.0f cycles\n", sizes[s], cycles[REPS/2]);
+    }
+    return 0;
+}
@@ -1,12 +1,14 @@
 #ifndef APIK_H
 #define APIK_H
 
+#include <stddef.h>
 #include "params.h"
 
 #define CRYPTO_SECRETKEYBYTES  KYBER_SECRETKEYBYTES
 #define CRYPTO_PUBLICKEYBYTES  KYBER_PUBLICKEYBYTES
 #define CRYPTO_CIPHERTEXTBYTES KYBER_CIPHERTEXTBYTES
 #define CRYPTO_BYTES           KYBER_SSBYTES
+#define CRYPTO_PREPAREDBYTES   KYBER_PREPAREDBYTES
 
 #if   (KYBER_K == 2)
 #define CRYPTO_ALGNAME "Kyber512"
@@ -24,5 +26,23 @@ int crypto_kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk
 
 int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk);
 
+size_t crypto_kem_scratch_bytes(void);
+
+int crypto_kem_keypair_with_scratch(unsigned char *pk, unsigned char *sk, void *scratch);
+
+int crypto_kem_enc_with_scratch(unsigned char *ct, unsigned char *ss, const unsigned char *pk, void *scratch);
+
+int crypto_kem_dec_with_scratch(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, void *scratch);
+
+int crypto_kem_keypair_batch(unsigned char *pk, unsigned char *sk, size_t n);
+
+int crypto_kem_enc_batch(unsigned char *ct, unsigned char *ss, const unsigned char *pk, size_t n);
+
+int crypto_kem_dec_batch(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, size_t n);
+
+int crypto_kem_prepare_pk(unsigned char *prepared, const unsigned char *pk);
+
+int crypto_kem_enc_prepared(unsigned char *ct, unsigned char *ss, const unsigned char *prepared);
+
 
 #endif
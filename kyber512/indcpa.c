@@ -1,10 +1,14 @@
 #include <stdint.h>
+#include <string.h>
 #include "indcpa.h"
 #include "poly.h"
 #include "polyvec.h"
 #include "randombytes.h"
 #include "ntt.h"
 #include "symmetric.h"
+#ifndef KYBER_90S
+#include "fips202x4.h"
+#endif
 
 /*************************************************
 * Name:        pack_pk
@@ -182,6 +186,74 @@ void gen_matrix(polyvec *a, const unsigned char *seed, int transposed) // Not st
   }
 }
 
+#ifndef KYBER_90S
+/*************************************************
+* Name:        gen_matrix_x4
+*
+* Description: gen_matrix for four independent seeds at once; each entry
+*              comes from one 4-way SHAKE128 over the four instances
+*
+* Arguments:   - polyvec a[4][KYBER_K]:      pointer to ouptput matrices A (or A^T), one per seed
+*              - const unsigned char *seed[4]: pointers to input seeds
+*              - int transposed:             boolean deciding whether A or A^T is generated
+**************************************************/
+static void gen_matrix_x4(polyvec a[4][KYBER_K], const unsigned char *seed[4], int transposed)
+{
+  unsigned int ctr[4], i, j, k;
+  const unsigned int maxnblocks=(530+XOF_BLOCKBYTES)/XOF_BLOCKBYTES; /* 530 is expected number of required bytes */
+  unsigned char buf[4][XOF_BLOCKBYTES*maxnblocks+1];
+  unsigned char extseed[4][KYBER_SYMBYTES+2];
+  keccakx4_state state;
+
+  for(i=0;i<KYBER_K;i++)
+  {
+    for(j=0;j<KYBER_K;j++)
+    {
+      for(k=0;k<4;k++)
+      {
+        memcpy(extseed[k], seed[k], KYBER_SYMBYTES);
+        extseed[k][KYBER_SYMBYTES]   = transposed ? i : j;
+        extseed[k][KYBER_SYMBYTES+1] = transposed ? j : i;
+      }
+      shake128x4_absorb(&state, extseed[0], extseed[1], extseed[2], extseed[3], KYBER_SYMBYTES+2);
+
+      shake128x4_squeezeblocks(buf[0], buf[1], buf[2], buf[3], maxnblocks, &state);
+      for(k=0;k<4;k++)
+        ctr[k] = rej_uniform(a[k][i].vec[j].coeffs, KYBER_N, buf[k], maxnblocks*XOF_BLOCKBYTES);
+
+      while(ctr[0] < KYBER_N || ctr[1] < KYBER_N || ctr[2] < KYBER_N || ctr[3] < KYBER_N)
+      {
+        shake128x4_squeezeblocks(buf[0], buf[1], buf[2], buf[3], 1, &state);
+        for(k=0;k<4;k++)
+          if(ctr[k] < KYBER_N)
+            ctr[k] += rej_uniform(a[k][i].vec[j].coeffs + ctr[k], KYBER_N - ctr[k], buf[k], XOF_BLOCKBYTES);
+      }
+    }
+  }
+}
+#endif
+
+static void keypair_core(unsigned char *pk, unsigned char *sk, polyvec *a, const unsigned char *publicseed, polyvec *skpv, polyvec *e)
+{
+  polyvec pkpv;
+  int i;
+
+  polyvec_ntt(skpv);
+  polyvec_ntt(e);
+
+  // matrix-vector multiplication
+  for(i=0;i<KYBER_K;i++) {
+    polyvec_pointwise_acc(&pkpv.vec[i], &a[i], skpv);
+    poly_frommont(&pkpv.vec[i]);
+  }
+
+  polyvec_add(&pkpv, &pkpv, e);
+  polyvec_reduce(&pkpv);
+
+  pack_sk(sk, skpv);
+  pack_pk(pk, &pkpv, publicseed);
+}
+
 /*************************************************
 * Name:        indcpa_keypair
 *
@@ -193,7 +265,19 @@ void gen_matrix(polyvec *a, const unsigned char *seed, int transposed) // Not st
 **************************************************/
 void indcpa_keypair(unsigned char *pk, unsigned char *sk)
 {
-  polyvec a[KYBER_K], e, pkpv, skpv;
+  indcpa_keypair_scratch w;
+
+  indcpa_keypair_with_scratch(pk, sk, &w);
+}
+
+/*************************************************
+* Name:        indcpa_keypair_with_scratch
+*
+* Description: indcpa_keypair with the matrix and vectors in w
+**************************************************/
+void indcpa_keypair_with_scratch(unsigned char *pk, unsigned char *sk, indcpa_keypair_scratch *w)
+{
+  polyvec *a = w->a, *e = &w->e, *skpv = &w->skpv;
   unsigned char buf[2*KYBER_SYMBYTES];
   unsigned char *publicseed = buf;
   unsigned char *noiseseed = buf+KYBER_SYMBYTES;
@@ -206,24 +290,97 @@ void indcpa_keypair(unsigned char *pk, unsigned char *sk)
   gen_a(a, publicseed);
 
   for(i=0;i<KYBER_K;i++)
-    poly_getnoise(skpv.vec+i, noiseseed, nonce++);
+    poly_getnoise(skpv->vec+i, noiseseed, nonce++);
   for(i=0;i<KYBER_K;i++)
-    poly_getnoise(e.vec+i, noiseseed, nonce++);
+    poly_getnoise(e->vec+i, noiseseed, nonce++);
 
-  polyvec_ntt(&skpv);
-  polyvec_ntt(&e);
+  keypair_core(pk, sk, a, publicseed, skpv, e);
+}
 
-  // matrix-vector multiplication
-  for(i=0;i<KYBER_K;i++) {
-    polyvec_pointwise_acc(&pkpv.vec[i], &a[i], &skpv);
-    poly_frommont(&pkpv.vec[i]);
+#ifndef KYBER_90S
+/*************************************************
+* Name:        indcpa_keypair_x4
+*
+* Description: Four independent indcpa_keypair; matrices and noise of the
+*              four instances come from 4-way SHAKE
+*
+* Arguments:   - unsigned char *pk[4]:         pointers to output public keys
+*              - unsigned char *sk[4]:         pointers to output private keys
+*              - const unsigned char *coins[4]: pointers to the KYBER_SYMBYTES random bytes
+*                                              indcpa_keypair would draw for each instance
+**************************************************/
+void indcpa_keypair_x4(unsigned char *pk[4], unsigned char *sk[4], const unsigned char *coins[4])
+{
+  polyvec a[4][KYBER_K], e[4], skpv[4];
+  unsigned char buf[4][2*KYBER_SYMBYTES];
+  const unsigned char *noiseseed[4];
+  poly *r[4];
+  int i, k;
+  unsigned char nonce=0;
+
+  for(k=0;k<4;k++)
+  {
+    hash_g(buf[k], coins[k], KYBER_SYMBYTES);
+    noiseseed[k] = buf[k]+KYBER_SYMBYTES;
   }
 
-  polyvec_add(&pkpv, &pkpv, &e);
-  polyvec_reduce(&pkpv);
+  gen_matrix_x4(a, (const unsigned char *[4]){buf[0], buf[1], buf[2], buf[3]}, 0);
 
-  pack_sk(sk, &skpv);
-  pack_pk(pk, &pkpv, publicseed);
+  for(i=0;i<KYBER_K;i++)
+  {
+    for(k=0;k<4;k++)
+      r[k] = skpv[k].vec+i;
+    poly_getnoise_x4(r, noiseseed, nonce++);
+  }
+  for(i=0;i<KYBER_K;i++)
+  {
+    for(k=0;k<4;k++)
+      r[k] = e[k].vec+i;
+    poly_getnoise_x4(r, noiseseed, nonce++);
+  }
+
+  for(k=0;k<4;k++)
+    keypair_core(pk[k], sk[k], a[k], buf[k], &skpv[k], &e[k]);
+}
+#endif
+
+static void enc_core(unsigned char *c, const unsigned char *m, const polyvec *pkpv, const polyvec *at, polyvec *sp, polyvec *ep, poly *epp)
+{
+  polyvec bp;
+  poly v, k;
+  int i;
+
+  poly_frommsg(&k, m);
+  polyvec_ntt(sp);
+
+  // matrix-vector multiplication
+  for(i=0;i<KYBER_K;i++)
+    polyvec_pointwise_acc(&bp.vec[i], &at[i], sp);
+
+  polyvec_pointwise_acc(&v, pkpv, sp);
+
+  polyvec_invntt(&bp);
+  poly_invntt(&v);
+
+  polyvec_add(&bp, &bp, ep);
+  poly_add(&v, &v, epp);
+  poly_add(&v, &v, &k);
+  polyvec_reduce(&bp);
+  poly_reduce(&v);
+
+  pack_ciphertext(c, &bp, &v);
+}
+
+static void enc_noise(polyvec *sp, polyvec *ep, poly *epp, const unsigned char *coins)
+{
+  int i;
+  unsigned char nonce=0;
+
+  for(i=0;i<KYBER_K;i++)
+    poly_getnoise(sp->vec+i, coins, nonce++);
+  for(i=0;i<KYBER_K;i++)
+    poly_getnoise(ep->vec+i, coins, nonce++);
+  poly_getnoise(epp, coins, nonce++);
 }
 
 /*************************************************
@@ -243,41 +400,112 @@ void indcpa_enc(unsigned char *c,
                 const unsigned char *pk,
                 const unsigned char *coins)
 {
-  polyvec sp, pkpv, ep, at[KYBER_K], bp;
-  poly v, k, epp;
+  indcpa_enc_scratch w;
+
+  indcpa_enc_with_scratch(c, m, pk, coins, &w);
+}
+
+/*************************************************
+* Name:        indcpa_enc_with_scratch
+*
+* Description: indcpa_enc with the matrix and vectors in w
+**************************************************/
+void indcpa_enc_with_scratch(unsigned char *c,
+                             const unsigned char *m,
+                             const unsigned char *pk,
+                             const unsigned char *coins,
+                             indcpa_enc_scratch *w)
+{
+  poly epp;
   unsigned char seed[KYBER_SYMBYTES];
-  int i;
-  unsigned char nonce=0;
 
-  unpack_pk(&pkpv, seed, pk);
-  poly_frommsg(&k, m);
-  gen_at(at, seed);
+  unpack_pk(&w->pkpv, seed, pk);
+  gen_at(w->at, seed);
+  enc_noise(&w->sp, &w->ep, &epp, coins);
+  enc_core(c, m, &w->pkpv, w->at, &w->sp, &w->ep, &epp);
+}
 
-  for(i=0;i<KYBER_K;i++)
-    poly_getnoise(sp.vec+i, coins, nonce++);
-  for(i=0;i<KYBER_K;i++)
-    poly_getnoise(ep.vec+i, coins, nonce++);
-  poly_getnoise(&epp, coins, nonce++);
+/*************************************************
+* Name:        indcpa_prepare_pk
+*
+* Description: Unpacks a public key and expands its matrix A^T once, for
+*              any number of indcpa_enc_prepared
+*
+* Arguments:   - indcpa_prepared_pk *p:   pointer to output prepared key
+*              - const unsigned char *pk: pointer to input public key (of length KYBER_INDCPA_PUBLICKEYBYTES bytes)
+**************************************************/
+void indcpa_prepare_pk(indcpa_prepared_pk *p, const unsigned char *pk)
+{
+  unsigned char seed[KYBER_SYMBYTES];
 
-  polyvec_ntt(&sp);
+  unpack_pk(&p->pkpv, seed, pk);
+  gen_at(p->at, seed);
+}
 
-  // matrix-vector multiplication
-  for(i=0;i<KYBER_K;i++)
-    polyvec_pointwise_acc(&bp.vec[i], &at[i], &sp);
+/*************************************************
+* Name:        indcpa_enc_prepared
+*
+* Description: indcpa_enc with a key from indcpa_prepare_pk
+**************************************************/
+void indcpa_enc_prepared(unsigned char *c,
+                         const unsigned char *m,
+                         const indcpa_prepared_pk *p,
+                         const unsigned char *coins)
+{
+  polyvec sp, ep;
+  poly epp;
 
-  polyvec_pointwise_acc(&v, &pkpv, &sp);
+  enc_noise(&sp, &ep, &epp, coins);
+  enc_core(c, m, &p->pkpv, p->at, &sp, &ep, &epp);
+}
 
-  polyvec_invntt(&bp);
-  poly_invntt(&v);
+#ifndef KYBER_90S
+/*************************************************
+* Name:        indcpa_enc_x4
+*
+* Description: Four independent indcpa_enc; matrices and noise of the
+*              four instances come from 4-way SHAKE
+*
+* Arguments:   - unsigned char *c[4]:          pointers to output ciphertexts
+*              - const unsigned char *m[4]:     pointers to input messages
+*              - const unsigned char *pk[4]:    pointers to input public keys
+*              - const unsigned char *coins[4]: pointers to input random coins
+**************************************************/
+void indcpa_enc_x4(unsigned char *c[4],
+                   const unsigned char *m[4],
+                   const unsigned char *pk[4],
+                   const unsigned char *coins[4])
+{
+  polyvec sp[4], pkpv[4], ep[4], at[4][KYBER_K];
+  poly epp[4], *r[4];
+  unsigned char seed[4][KYBER_SYMBYTES];
+  int i, k;
+  unsigned char nonce=0;
 
-  polyvec_add(&bp, &bp, &ep);
-  poly_add(&v, &v, &epp);
-  poly_add(&v, &v, &k);
-  polyvec_reduce(&bp);
-  poly_reduce(&v);
+  for(k=0;k<4;k++)
+    unpack_pk(&pkpv[k], seed[k], pk[k]);
+  gen_matrix_x4(at, (const unsigned char *[4]){seed[0], seed[1], seed[2], seed[3]}, 1);
 
-  pack_ciphertext(c, &bp, &v);
+  for(i=0;i<KYBER_K;i++)
+  {
+    for(k=0;k<4;k++)
+      r[k] = sp[k].vec+i;
+    poly_getnoise_x4(r, coins, nonce++);
+  }
+  for(i=0;i<KYBER_K;i++)
+  {
+    for(k=0;k<4;k++)
+      r[k] = ep[k].vec+i;
+    poly_getnoise_x4(r, coins, nonce++);
+  }
+  for(k=0;k<4;k++)
+    r[k] = &epp[k];
+  poly_getnoise_x4(r, coins, nonce++);
+
+  for(k=0;k<4;k++)
+    enc_core(c[k], m[k], &pkpv[k], at[k], &sp[k], &ep[k], &epp[k]);
 }
+#endif
 
 /*************************************************
 * Name:        indcpa_dec
@@ -293,14 +521,28 @@ void indcpa_dec(unsigned char *m,
                 const unsigned char *c,
                 const unsigned char *sk)
 {
-  polyvec bp, skpv;
+  indcpa_dec_scratch w;
+
+  indcpa_dec_with_scratch(m, c, sk, &w);
+}
+
+/*************************************************
+* Name:        indcpa_dec_with_scratch
+*
+* Description: indcpa_dec with the vectors in w
+**************************************************/
+void indcpa_dec_with_scratch(unsigned char *m,
+                             const unsigned char *c,
+                             const unsigned char *sk,
+                             indcpa_dec_scratch *w)
+{
   poly v, mp;
 
-  unpack_ciphertext(&bp, &v, c);
-  unpack_sk(&skpv, sk);
+  unpack_ciphertext(&w->bp, &v, c);
+  unpack_sk(&w->skpv, sk);
 
-  polyvec_ntt(&bp);
-  polyvec_pointwise_acc(&mp, &skpv, &bp);
+  polyvec_ntt(&w->bp);
+  polyvec_pointwise_acc(&mp, &w->skpv, &w->bp);
   poly_invntt(&mp);
 
   poly_sub(&mp, &v, &mp);
@@ -1,16 +1,72 @@
 #ifndef INDCPA_H
 #define INDCPA_H
 
+#include "params.h"
+#include "polyvec.h"
+
+/* Public key unpacked, with its matrix A^T expanded, for repeated encryption */
+typedef struct {
+  polyvec at[KYBER_K];
+  polyvec pkpv;
+} indcpa_prepared_pk;
+
+/* Large temporaries of indcpa_keypair, indcpa_enc and indcpa_dec; the
+ * *_with_scratch forms take them from the caller instead of the stack */
+typedef struct {
+  polyvec a[KYBER_K];
+  polyvec skpv, e;
+} indcpa_keypair_scratch;
+
+typedef struct {
+  polyvec at[KYBER_K];
+  polyvec pkpv, sp, ep;
+} indcpa_enc_scratch;
+
+typedef struct {
+  polyvec bp, skpv;
+} indcpa_dec_scratch;
+
 void indcpa_keypair(unsigned char *pk,
                     unsigned char *sk);
 
+void indcpa_keypair_with_scratch(unsigned char *pk,
+                                 unsigned char *sk,
+                                 indcpa_keypair_scratch *w);
+
 void indcpa_enc(unsigned char *c,
                 const unsigned char *m,
                 const unsigned char *pk,
                 const unsigned char *coins);
 
+void indcpa_enc_with_scratch(unsigned char *c,
+                             const unsigned char *m,
+                             const unsigned char *pk,
+                             const unsigned char *coins,
+                             indcpa_enc_scratch *w);
+
+void indcpa_prepare_pk(indcpa_prepared_pk *p, const unsigned char *pk);
+
+void indcpa_enc_prepared(unsigned char *c,
+                         const unsigned char *m,
+                         const indcpa_prepared_pk *p,
+                         const unsigned char *coins);
+
+#ifndef KYBER_90S
+void indcpa_keypair_x4(unsigned char *pk[4], unsigned char *sk[4], const unsigned char *coins[4]);
+
+void indcpa_enc_x4(unsigned char *c[4],
+                   const unsigned char *m[4],
+                   const unsigned char *pk[4],
+                   const unsigned char *coins[4]);
+#endif
+
 void indcpa_dec(unsigned char *m,
                 const unsigned char *c,
                 const unsigned char *sk);
 
+void indcpa_dec_with_scratch(unsigned char *m,
+                             const unsigned char *c,
+                             const unsigned char *sk,
+                             indcpa_dec_scratch *w);
+
 #endif
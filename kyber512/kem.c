@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <string.h>
 #include "api.h"
 #include "randombytes.h"
 #include "symmetric.h"
@@ -6,6 +7,17 @@
 #include "verify.h"
 #include "indcpa.h"
 
+/* Temporaries of the three operations; decapsulation uses dec, then enc */
+typedef union {
+  indcpa_keypair_scratch keypair;
+  indcpa_enc_scratch enc;
+  indcpa_dec_scratch dec;
+} kyber_scratch;
+
+static int kem_keypair(unsigned char *pk, unsigned char *sk, indcpa_keypair_scratch *w);
+static int kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk, indcpa_enc_scratch *w);
+static int kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, kyber_scratch *w);
+
 /*************************************************
 * Name:        crypto_kem_keypair
 *
@@ -18,9 +30,15 @@
 * Returns 0 (success)
 **************************************************/
 int crypto_kem_keypair(unsigned char *pk, unsigned char *sk)
+{
+  indcpa_keypair_scratch w;
+  return kem_keypair(pk, sk, &w);
+}
+
+static int kem_keypair(unsigned char *pk, unsigned char *sk, indcpa_keypair_scratch *w)
 {
   size_t i;
-  indcpa_keypair(pk,sk);
+  indcpa_keypair_with_scratch(pk, sk, w);
   for(i=0;i<KYBER_INDCPA_PUBLICKEYBYTES;i++)
     sk[i+KYBER_INDCPA_SECRETKEYBYTES] = pk[i];
   hash_h(sk+KYBER_SECRETKEYBYTES-2*KYBER_SYMBYTES, pk, KYBER_PUBLICKEYBYTES);
@@ -41,6 +59,12 @@ int crypto_kem_keypair(unsigned char *pk, unsigned char *sk)
 * Returns 0 (success)
 **************************************************/
 int crypto_kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk)
+{
+  indcpa_enc_scratch w;
+  return kem_enc(ct, ss, pk, &w);
+}
+
+static int kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk, indcpa_enc_scratch *w)
 {
   unsigned char  kr[2*KYBER_SYMBYTES];                                     /* Will contain key, coins */
   unsigned char buf[2*KYBER_SYMBYTES];
@@ -51,7 +75,7 @@ int crypto_kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk
   hash_h(buf+KYBER_SYMBYTES, pk, KYBER_PUBLICKEYBYTES);                    /* Multitarget countermeasure for coins + contributory KEM */
   hash_g(kr, buf, 2*KYBER_SYMBYTES);
 
-  indcpa_enc(ct, buf, pk, kr+KYBER_SYMBYTES);                              /* coins are in kr+KYBER_SYMBYTES */
+  indcpa_enc_with_scratch(ct, buf, pk, kr+KYBER_SYMBYTES, w);             /* coins are in kr+KYBER_SYMBYTES */
 
   hash_h(kr+KYBER_SYMBYTES, ct, KYBER_CIPHERTEXTBYTES);                    /* overwrite coins in kr with H(c) */
   kdf(ss, kr, 2*KYBER_SYMBYTES);                                           /* hash concatenation of pre-k and H(c) to k */
@@ -73,6 +97,12 @@ int crypto_kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk
 * On failure, ss will contain a pseudo-random value.
 **************************************************/
 int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk)
+{
+  kyber_scratch w;
+  return kem_dec(ss, ct, sk, &w);
+}
+
+static int kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, kyber_scratch *w)
 {
   size_t i;
   int fail;
@@ -81,13 +111,13 @@ int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned ch
   unsigned char kr[2*KYBER_SYMBYTES];                                      /* Will contain key, coins */
   const unsigned char *pk = sk+KYBER_INDCPA_SECRETKEYBYTES;
 
-  indcpa_dec(buf, ct, sk);
+  indcpa_dec_with_scratch(buf, ct, sk, &w->dec);
 
   for(i=0;i<KYBER_SYMBYTES;i++)                                            /* Multitarget countermeasure for coins + contributory KEM */
     buf[KYBER_SYMBYTES+i] = sk[KYBER_SECRETKEYBYTES-2*KYBER_SYMBYTES+i];   /* Save hash by storing H(pk) in sk */
   hash_g(kr, buf, 2*KYBER_SYMBYTES);
 
-  indcpa_enc(cmp, buf, pk, kr+KYBER_SYMBYTES);                             /* coins are in kr+KYBER_SYMBYTES */
+  indcpa_enc_with_scratch(cmp, buf, pk, kr+KYBER_SYMBYTES, &w->enc);      /* coins are in kr+KYBER_SYMBYTES */
 
   fail = verify(ct, cmp, KYBER_CIPHERTEXTBYTES);
 
@@ -98,3 +128,246 @@ int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned ch
   kdf(ss, kr, 2*KYBER_SYMBYTES);                                           /* hash concatenation of pre-k and H(c) to k */
   return 0;
 }
+
+/*************************************************
+* Name:        crypto_kem_scratch_bytes
+*
+* Description: Size of the arena taken by crypto_kem_keypair_with_scratch,
+*              crypto_kem_enc_with_scratch and crypto_kem_dec_with_scratch;
+*              one arena serves all three
+**************************************************/
+size_t crypto_kem_scratch_bytes(void)
+{
+  return sizeof(kyber_scratch);
+}
+
+/*************************************************
+* Name:        crypto_kem_keypair_with_scratch
+*
+* Description: crypto_kem_keypair with the matrix and vectors in scratch
+*              (crypto_kem_scratch_bytes() bytes, aligned as by malloc)
+**************************************************/
+int crypto_kem_keypair_with_scratch(unsigned char *pk, unsigned char *sk, void *scratch)
+{
+  return kem_keypair(pk, sk, &((kyber_scratch *)scratch)->keypair);
+}
+
+/*************************************************
+* Name:        crypto_kem_enc_with_scratch
+*
+* Description: crypto_kem_enc with the matrix and vectors in scratch
+**************************************************/
+int crypto_kem_enc_with_scratch(unsigned char *ct, unsigned char *ss, const unsigned char *pk, void *scratch)
+{
+  return kem_enc(ct, ss, pk, &((kyber_scratch *)scratch)->enc);
+}
+
+/*************************************************
+* Name:        crypto_kem_dec_with_scratch
+*
+* Description: crypto_kem_dec with the matrix and vectors in scratch
+**************************************************/
+int crypto_kem_dec_with_scratch(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, void *scratch)
+{
+  return kem_dec(ss, ct, sk, (kyber_scratch *)scratch);
+}
+
+/*************************************************
+* Name:        crypto_kem_prepare_pk
+*
+* Description: Expands a public key once for many crypto_kem_enc_prepared:
+*              stores H(pk) and the output of indcpa_prepare_pk
+*
+* Arguments:   - unsigned char *prepared: pointer to output prepared key (an already allocated array of CRYPTO_PREPAREDBYTES bytes,
+*                                         aligned as by malloc)
+*              - const unsigned char *pk: pointer to input public key (an already allocated array of CRYPTO_PUBLICKEYBYTES bytes)
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_kem_prepare_pk(unsigned char *prepared, const unsigned char *pk)
+{
+  _Static_assert(KYBER_SYMBYTES + sizeof(indcpa_prepared_pk) <= KYBER_PREPAREDBYTES, "KYBER_PREPAREDBYTES too small");
+
+  hash_h(prepared, pk, KYBER_PUBLICKEYBYTES);
+  indcpa_prepare_pk((indcpa_prepared_pk *)(prepared+KYBER_SYMBYTES), pk);
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_enc_prepared
+*
+* Description: crypto_kem_enc with a key from crypto_kem_prepare_pk; skips
+*              unpacking pk, expanding A^T and hashing pk
+*
+* Arguments:   - unsigned char *ct:             pointer to output cipher text (an already allocated array of CRYPTO_CIPHERTEXTBYTES bytes)
+*              - unsigned char *ss:             pointer to output shared secret (an already allocated array of CRYPTO_BYTES bytes)
+*              - const unsigned char *prepared: pointer to input prepared key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_kem_enc_prepared(unsigned char *ct, unsigned char *ss, const unsigned char *prepared)
+{
+  unsigned char  kr[2*KYBER_SYMBYTES];
+  unsigned char buf[2*KYBER_SYMBYTES];
+
+  randombytes(buf, KYBER_SYMBYTES);
+  hash_h(buf, buf, KYBER_SYMBYTES);
+
+  memcpy(buf+KYBER_SYMBYTES, prepared, KYBER_SYMBYTES);                    /* H(pk) */
+  hash_g(kr, buf, 2*KYBER_SYMBYTES);
+
+  indcpa_enc_prepared(ct, buf, (const indcpa_prepared_pk *)(prepared+KYBER_SYMBYTES), kr+KYBER_SYMBYTES);
+
+  hash_h(kr+KYBER_SYMBYTES, ct, KYBER_CIPHERTEXTBYTES);
+  kdf(ss, kr, 2*KYBER_SYMBYTES);
+  return 0;
+}
+
+/*************************************************
+* Batch API: n independent instances stored back to back (pk+i*CRYPTO_PUBLICKEYBYTES, ...).
+* Groups of four share their matrix and noise sampling through 4-way SHAKE
+* (indcpa_keypair_x4, indcpa_enc_x4), the remainder goes through the single
+* calls. Randomness is drawn per instance in the order of the single calls,
+* so a deterministic randombytes gives the same output as n single calls.
+* With KYBER_90S there is no 4-way XOF and every instance is a single call.
+**************************************************/
+
+/*************************************************
+* Name:        crypto_kem_keypair_batch
+*
+* Description: n calls of crypto_kem_keypair
+*
+* Arguments:   - unsigned char *pk: pointer to output public keys (n*CRYPTO_PUBLICKEYBYTES bytes)
+*              - unsigned char *sk: pointer to output private keys (n*CRYPTO_SECRETKEYBYTES bytes)
+*              - size_t n:          number of key pairs
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_kem_keypair_batch(unsigned char *pk, unsigned char *sk, size_t n)
+{
+  size_t i = 0;
+#ifndef KYBER_90S
+  unsigned char coins[4][KYBER_SYMBYTES];
+  unsigned char *pkx[4], *skx[4];
+  size_t k;
+
+  for(;i+4<=n;i+=4)
+  {
+    for(k=0;k<4;k++)
+    {
+      pkx[k] = pk+(i+k)*KYBER_PUBLICKEYBYTES;
+      skx[k] = sk+(i+k)*KYBER_SECRETKEYBYTES;
+      randombytes(coins[k], KYBER_SYMBYTES);
+      randombytes(skx[k]+KYBER_SECRETKEYBYTES-KYBER_SYMBYTES, KYBER_SYMBYTES);  /* Value z */
+    }
+    indcpa_keypair_x4(pkx, skx, (const unsigned char *[4]){coins[0], coins[1], coins[2], coins[3]});
+    for(k=0;k<4;k++)
+    {
+      memcpy(skx[k]+KYBER_INDCPA_SECRETKEYBYTES, pkx[k], KYBER_INDCPA_PUBLICKEYBYTES);
+      hash_h(skx[k]+KYBER_SECRETKEYBYTES-2*KYBER_SYMBYTES, pkx[k], KYBER_PUBLICKEYBYTES);
+    }
+  }
+#endif
+  for(;i<n;i++)
+    crypto_kem_keypair(pk+i*KYBER_PUBLICKEYBYTES, sk+i*KYBER_SECRETKEYBYTES);
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_enc_batch
+*
+* Description: n calls of crypto_kem_enc, the i-th one with the i-th public key
+*
+* Arguments:   - unsigned char *ct:       pointer to output cipher texts (n*CRYPTO_CIPHERTEXTBYTES bytes)
+*              - unsigned char *ss:       pointer to output shared secrets (n*CRYPTO_BYTES bytes)
+*              - const unsigned char *pk: pointer to input public keys (n*CRYPTO_PUBLICKEYBYTES bytes)
+*              - size_t n:                number of encapsulations
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_kem_enc_batch(unsigned char *ct, unsigned char *ss, const unsigned char *pk, size_t n)
+{
+  size_t i = 0;
+#ifndef KYBER_90S
+  unsigned char kr[4][2*KYBER_SYMBYTES];
+  unsigned char buf[4][2*KYBER_SYMBYTES];
+  unsigned char *ctx[4];
+  const unsigned char *pkx[4];
+  size_t k;
+
+  for(;i+4<=n;i+=4)
+  {
+    for(k=0;k<4;k++)
+    {
+      ctx[k] = ct+(i+k)*KYBER_CIPHERTEXTBYTES;
+      pkx[k] = pk+(i+k)*KYBER_PUBLICKEYBYTES;
+      randombytes(buf[k], KYBER_SYMBYTES);
+      hash_h(buf[k], buf[k], KYBER_SYMBYTES);
+      hash_h(buf[k]+KYBER_SYMBYTES, pkx[k], KYBER_PUBLICKEYBYTES);
+      hash_g(kr[k], buf[k], 2*KYBER_SYMBYTES);
+    }
+    indcpa_enc_x4(ctx, (const unsigned char *[4]){buf[0], buf[1], buf[2], buf[3]}, pkx,
+                  (const unsigned char *[4]){kr[0]+KYBER_SYMBYTES, kr[1]+KYBER_SYMBYTES, kr[2]+KYBER_SYMBYTES, kr[3]+KYBER_SYMBYTES});
+    for(k=0;k<4;k++)
+    {
+      hash_h(kr[k]+KYBER_SYMBYTES, ctx[k], KYBER_CIPHERTEXTBYTES);
+      kdf(ss+(i+k)*KYBER_SSBYTES, kr[k], 2*KYBER_SYMBYTES);
+    }
+  }
+#endif
+  for(;i<n;i++)
+    crypto_kem_enc(ct+i*KYBER_CIPHERTEXTBYTES, ss+i*KYBER_SSBYTES, pk+i*KYBER_PUBLICKEYBYTES);
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_kem_dec_batch
+*
+* Description: n calls of crypto_kem_dec, the i-th one with the i-th private key;
+*              the re-encryptions run four at a time
+*
+* Arguments:   - unsigned char *ss:       pointer to output shared secrets (n*CRYPTO_BYTES bytes)
+*              - const unsigned char *ct: pointer to input cipher texts (n*CRYPTO_CIPHERTEXTBYTES bytes)
+*              - const unsigned char *sk: pointer to input private keys (n*CRYPTO_SECRETKEYBYTES bytes)
+*              - size_t n:                number of decapsulations
+*
+* Returns 0.
+**************************************************/
+int crypto_kem_dec_batch(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, size_t n)
+{
+  size_t i = 0;
+#ifndef KYBER_90S
+  unsigned char __attribute__((aligned(32))) cmp[4][KYBER_CIPHERTEXTBYTES];
+  unsigned char buf[4][2*KYBER_SYMBYTES];
+  unsigned char kr[4][2*KYBER_SYMBYTES];
+  const unsigned char *ctx[4], *skx[4], *pkx[4];
+  int fail;
+  size_t k;
+
+  for(;i+4<=n;i+=4)
+  {
+    for(k=0;k<4;k++)
+    {
+      ctx[k] = ct+(i+k)*KYBER_CIPHERTEXTBYTES;
+      skx[k] = sk+(i+k)*KYBER_SECRETKEYBYTES;
+      pkx[k] = skx[k]+KYBER_INDCPA_SECRETKEYBYTES;
+      indcpa_dec(buf[k], ctx[k], skx[k]);
+      memcpy(buf[k]+KYBER_SYMBYTES, skx[k]+KYBER_SECRETKEYBYTES-2*KYBER_SYMBYTES, KYBER_SYMBYTES);
+      hash_g(kr[k], buf[k], 2*KYBER_SYMBYTES);
+    }
+    indcpa_enc_x4((unsigned char *[4]){cmp[0], cmp[1], cmp[2], cmp[3]},
+                  (const unsigned char *[4]){buf[0], buf[1], buf[2], buf[3]}, pkx,
+                  (const unsigned char *[4]){kr[0]+KYBER_SYMBYTES, kr[1]+KYBER_SYMBYTES, kr[2]+KYBER_SYMBYTES, kr[3]+KYBER_SYMBYTES});
+    for(k=0;k<4;k++)
+    {
+      fail = verify(ctx[k], cmp[k], KYBER_CIPHERTEXTBYTES);
+      hash_h(kr[k]+KYBER_SYMBYTES, ctx[k], KYBER_CIPHERTEXTBYTES);
+      cmov(kr[k], skx[k]+KYBER_SECRETKEYBYTES-KYBER_SYMBYTES, KYBER_SYMBYTES, fail);
+      kdf(ss+(i+k)*KYBER_SSBYTES, kr[k], 2*KYBER_SYMBYTES);
+    }
+  }
+#endif
+  for(;i<n;i++)
+    crypto_kem_dec(ss+i*KYBER_SSBYTES, ct+i*KYBER_CIPHERTEXTBYTES, sk+i*KYBER_SECRETKEYBYTES);
+  return 0;
+}
@@ -39,4 +39,6 @@
 #define KYBER_SECRETKEYBYTES  (KYBER_INDCPA_SECRETKEYBYTES +  KYBER_INDCPA_PUBLICKEYBYTES + 2*KYBER_SYMBYTES) /* 32 bytes of additional space to save H(pk) */
 #define KYBER_CIPHERTEXTBYTES  KYBER_INDCPA_BYTES
 
+#define KYBER_PREPAREDBYTES   (KYBER_SYMBYTES + (KYBER_K+1)*KYBER_K*KYBER_N*2) /* H(pk), then A^T and pk unpacked (indcpa_prepared_pk) */
+
 #endif
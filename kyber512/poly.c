@@ -1,10 +1,14 @@
 #include <stdint.h>
+#include <string.h>
 #include "params.h"
 #include "poly.h"
 #include "ntt.h"
 #include "reduce.h"
 #include "cbd.h"
 #include "symmetric.h"
+#ifndef KYBER_90S
+#include "fips202x4.h"
+#endif
 
 /*************************************************
 * Name:        poly_compress
@@ -180,6 +184,35 @@ void poly_getnoise(poly *r, const unsigned char *seed, unsigned char nonce)
   cbd(r, buf);
 }
 
+#ifndef KYBER_90S
+/*************************************************
+* Name:        poly_getnoise_x4
+*
+* Description: poly_getnoise for four seeds and one nonce, with a single
+*              4-way SHAKE256
+*
+* Arguments:   - poly *r[4]:                   pointers to output polynomials
+*              - const unsigned char *seed[4]: pointers to input seeds (each of length KYBER_SYMBYTES bytes)
+*              - unsigned char nonce:          one-byte input nonce
+**************************************************/
+void poly_getnoise_x4(poly *r[4], const unsigned char *seed[4], unsigned char nonce)
+{
+  unsigned char buf[4][KYBER_ETA*KYBER_N/4];
+  unsigned char extkey[4][KYBER_SYMBYTES+1];
+  int i;
+
+  for(i=0;i<4;i++)
+  {
+    memcpy(extkey[i], seed[i], KYBER_SYMBYTES);
+    extkey[i][KYBER_SYMBYTES] = nonce;
+  }
+  shake256x4(buf[0], buf[1], buf[2], buf[3], KYBER_ETA*KYBER_N/4,
+             extkey[0], extkey[1], extkey[2], extkey[3], KYBER_SYMBYTES+1);
+  for(i=0;i<4;i++)
+    cbd(r[i], buf[i]);
+}
+#endif
+
 /*************************************************
 * Name:        poly_ntt
 *
@@ -22,6 +22,9 @@ void poly_frommsg(poly *r, const unsigned char msg[KYBER_SYMBYTES]);
 void poly_tomsg(unsigned char msg[KYBER_SYMBYTES], poly *r);
 
 void poly_getnoise(poly *r,const unsigned char *seed, unsigned char nonce);
+#ifndef KYBER_90S
+void poly_getnoise_x4(poly *r[4], const unsigned char *seed[4], unsigned char nonce);
+#endif
 
 void poly_ntt(poly *r);
 void poly_invntt(poly *r);
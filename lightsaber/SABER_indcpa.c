@@ -4,8 +4,9 @@
 #include "poly.h"
 #include "pack_unpack.h"
 #include "poly_mul.c"
-#include "rng.h"
+#include "randombytes.h"
 #include "fips202.h"
+#include "fips202x4.h"
 #include "SABER_params.h"
 
 
@@ -18,24 +19,20 @@
 
 #define h2 ( (1<<(SABER_EP-2)) - (1<<(SABER_EP-SABER_ET-1)) + (1<<(SABER_EQ-SABER_EP-1)) )
 
-void InnerProd(uint16_t pkcl[SABER_K][SABER_N],uint16_t skpv[SABER_K][SABER_N],uint16_t mod,uint16_t res[SABER_N]);
-void MatrixVectorMul(polyvec *a, uint16_t skpv[SABER_K][SABER_N], uint16_t res[SABER_K][SABER_N], uint16_t mod, int16_t transpose);
+void InnerProd(uint16_t pkcl[SABER_K][SABER_N],uint16_t skpv[SABER_K][SABER_N],uint16_t mod,uint16_t res[SABER_N], saber_mul_scratch *w);
+void MatrixVectorMul(polyvec *a, uint16_t skpv[SABER_K][SABER_N], uint16_t res[SABER_K][SABER_N], uint16_t mod, int16_t transpose, saber_mul_scratch *w);
 
 void POL2MSG(uint16_t *message_dec_unpacked, unsigned char *message_dec);
 
-void GenMatrix(polyvec *a, const unsigned char *seed) 
+static void BS2MATRIX(polyvec *a, const unsigned char *buf) // buf: SHAKE128 output of GenMatrix
 {
   unsigned int one_vector=13*SABER_N/8;
-  unsigned int byte_bank_length=SABER_K*SABER_K*one_vector;
-  unsigned char buf[byte_bank_length];
 
   uint16_t temp_ar[SABER_N];
 
   int i,j,k;
   uint16_t mod = (SABER_Q-1);
 
-  shake128(buf,byte_bank_length,seed,SABER_SEEDBYTES);
-  
   for(i=0;i<SABER_K;i++)
   {
     for(j=0;j<SABER_K;j++)
@@ -50,28 +47,46 @@ void GenMatrix(polyvec *a, const unsigned char *seed)
 
 }
 
+void GenMatrix(polyvec *a, const unsigned char *seed, unsigned char *buf) // buf: SABER_K*SABER_K*13*SABER_N/8 bytes of workspace
+{
+  unsigned int byte_bank_length=SABER_K*SABER_K*13*SABER_N/8;
+
+  shake128(buf,byte_bank_length,seed,SABER_SEEDBYTES);
+  BS2MATRIX(a, buf);
+}
+
+// GenMatrix of four seeds at once, each into the a and a_bytes of its own scratch
+static void GenMatrix_x4(saber_scratch *w, const unsigned char *seed[4])
+{
+  unsigned int byte_bank_length=SABER_K*SABER_K*13*SABER_N/8;
+  int k;
+
+  shake128x4(w[0].a_bytes, w[1].a_bytes, w[2].a_bytes, w[3].a_bytes, byte_bank_length, seed[0], seed[1], seed[2], seed[3], SABER_SEEDBYTES);
+  for(k=0;k<4;k++)
+    BS2MATRIX(w[k].a, w[k].a_bytes);
+}
+
 
 void indcpa_kem_keypair(unsigned char *pk, unsigned char *sk)
 {
-  polyvec a[SABER_K];// skpv;
+  saber_scratch w;
 
-  uint16_t skpv[SABER_K][SABER_N];
- 
-  unsigned char seed[SABER_SEEDBYTES];
-  unsigned char noiseseed[SABER_COINBYTES];
-  int32_t i,j;
-  uint16_t mod_q=SABER_Q-1;
+  indcpa_kem_keypair_with_scratch(pk, sk, &w);
+}
 
 
-  uint16_t res[SABER_K][SABER_N];
+// The rest of the key generation, once A and s are sampled into w
+static void keypair_core(unsigned char *pk, unsigned char *sk, const unsigned char *seed, saber_scratch *w)
+{
+  polyvec *a = w->a;// skpv;
 
-  randombytes(seed, SABER_SEEDBYTES);
-  shake128(seed, SABER_SEEDBYTES, seed, SABER_SEEDBYTES); // for not revealing system RNG state
-  randombytes(noiseseed, SABER_COINBYTES);
+  uint16_t (*skpv)[SABER_N] = w->skpv;
+ 
+  int32_t i,j;
+  uint16_t mod_q=SABER_Q-1;
 
-  GenMatrix(a, seed);	//sample matrix A
 
-  GenSecret(skpv,noiseseed);//generate secret from constant-time binomial distribution
+  uint16_t (*res)[SABER_N] = w->res;
 
   //------------------------do the matrix vector multiplication and rounding------------
 
@@ -81,7 +96,7 @@ void indcpa_kem_keypair(unsigned char *pk, unsigned char *sk)
 		}
 	}
 
-	MatrixVectorMul(a,skpv,res,SABER_Q-1,1);
+	MatrixVectorMul(a,skpv,res,SABER_Q-1,1,&w->mul);
 	
 	//-----now rounding
 	for(i=0;i<SABER_K;i++){ //shift right 3 bits
@@ -109,20 +124,63 @@ void indcpa_kem_keypair(unsigned char *pk, unsigned char *sk)
 }
 
 
+void indcpa_kem_keypair_with_scratch(unsigned char *pk, unsigned char *sk, saber_scratch *w)
+{
+  unsigned char seed[SABER_SEEDBYTES];
+  unsigned char noiseseed[SABER_COINBYTES];
+
+  randombytes(seed, SABER_SEEDBYTES);
+  shake128(seed, SABER_SEEDBYTES, seed, SABER_SEEDBYTES); // for not revealing system RNG state
+  randombytes(noiseseed, SABER_COINBYTES);
+
+  GenMatrix(w->a, seed, w->a_bytes);	//sample matrix A
+
+  GenSecret(w->skpv,noiseseed);//generate secret from constant-time binomial distribution
+
+  keypair_core(pk, sk, seed, w);
+}
+
+
+// Four key generations from the randomness the single one would draw, seed[k] as
+// it comes from randombytes(); w points to four scratches
+void indcpa_kem_keypair_x4(unsigned char *pk[4], unsigned char *sk[4], const unsigned char *seed[4], const unsigned char *noiseseed[4], saber_scratch *w)
+{
+  unsigned char hseed[4][SABER_SEEDBYTES];
+  int k;
+
+  shake128x4(hseed[0], hseed[1], hseed[2], hseed[3], SABER_SEEDBYTES, seed[0], seed[1], seed[2], seed[3], SABER_SEEDBYTES);
+
+  GenMatrix_x4(w, (const unsigned char *[4]){hseed[0], hseed[1], hseed[2], hseed[3]});
+
+  GenSecret_x4((uint16_t (*[4])[SABER_N]){w[0].skpv, w[1].skpv, w[2].skpv, w[3].skpv}, noiseseed);
+
+  for(k=0;k<4;k++)
+    keypair_core(pk[k], sk[k], hseed[k], &w[k]);
+}
+
+
 void indcpa_kem_enc(unsigned char *message_received, unsigned char *noiseseed, const unsigned char *pk, unsigned char *ciphertext)
+{
+	saber_scratch w;
+
+	indcpa_kem_enc_with_scratch(message_received, noiseseed, pk, ciphertext, &w);
+}
+
+
+// The rest of the encryption, once A and s' are sampled into w
+static void enc_core(const unsigned char *message_received, const unsigned char *pk, unsigned char *ciphertext, saber_scratch *w)
 { 
 	uint32_t i,j,k;
-	polyvec a[SABER_K];		// skpv;
-	unsigned char seed[SABER_SEEDBYTES];
-	uint16_t pkcl[SABER_K][SABER_N]; 	//public key of received by the client
+	polyvec *a = w->a;		// skpv;
+	uint16_t (*pkcl)[SABER_N] = w->pkcl; 	//public key of received by the client
 
 
 
-	uint16_t skpv1[SABER_K][SABER_N];
+	uint16_t (*skpv1)[SABER_N] = w->skpv;
 
 	uint16_t message[SABER_KEYBYTES*8];
 
-	uint16_t res[SABER_K][SABER_N];
+	uint16_t (*res)[SABER_N] = w->res;
 	uint16_t mod_p=SABER_P-1;
 	uint16_t mod_q=SABER_Q-1;
 	
@@ -132,14 +190,6 @@ void indcpa_kem_enc(unsigned char *message_received, unsigned char *noiseseed, c
 
 	unsigned char msk_c[SABER_SCALEBYTES_KEM];
 	
-	for(i=0;i<SABER_SEEDBYTES;i++){ // extract the seedbytes from Public Key.
-		seed[i]=pk[ SABER_POLYVECCOMPRESSEDBYTES + i]; 
-	}
-
-	GenMatrix(a, seed);				
-
-	GenSecret(skpv1,noiseseed);//generate secret from constant-time binomial distribution
-
 	//-----------------matrix-vector multiplication and rounding
 
 	for(i=0;i<SABER_K;i++){
@@ -148,7 +198,7 @@ void indcpa_kem_enc(unsigned char *message_received, unsigned char *noiseseed, c
 		}
 	}
 
-	MatrixVectorMul(a,skpv1,res,SABER_Q-1,0);
+	MatrixVectorMul(a,skpv1,res,SABER_Q-1,0,&w->mul);
 	
 	  //-----now rounding
 
@@ -182,7 +232,7 @@ void indcpa_kem_enc(unsigned char *message_received, unsigned char *noiseseed, c
 	}
 
 	// vector-vector scalar multiplication with mod p
-	InnerProd(pkcl,skpv1,mod_p,vprime);
+	InnerProd(pkcl,skpv1,mod_p,vprime,&w->mul);
 
 	//addition of h1 to vprime
 	for(i=0;i<SABER_N;i++)
@@ -228,16 +278,56 @@ void indcpa_kem_enc(unsigned char *message_received, unsigned char *noiseseed, c
 }
 
 
+void indcpa_kem_enc_with_scratch(unsigned char *message_received, unsigned char *noiseseed, const unsigned char *pk, unsigned char *ciphertext, saber_scratch *w)
+{
+	unsigned char seed[SABER_SEEDBYTES];
+	uint32_t i;
+
+	for(i=0;i<SABER_SEEDBYTES;i++){ // extract the seedbytes from Public Key.
+		seed[i]=pk[ SABER_POLYVECCOMPRESSEDBYTES + i]; 
+	}
+
+	GenMatrix(w->a, seed, w->a_bytes);				
+
+	GenSecret(w->skpv,noiseseed);//generate secret from constant-time binomial distribution
+
+	enc_core(message_received, pk, ciphertext, w);
+}
+
+
+// Four encryptions, the k-th of message[k] with noiseseed[k] to pk[k]; w points to four scratches
+void indcpa_kem_enc_x4(const unsigned char *message[4], const unsigned char *noiseseed[4], const unsigned char *pk[4], unsigned char *ciphertext[4], saber_scratch *w)
+{
+	int k;
+
+	GenMatrix_x4(w, (const unsigned char *[4]){pk[0]+SABER_POLYVECCOMPRESSEDBYTES, pk[1]+SABER_POLYVECCOMPRESSEDBYTES,
+	                                            pk[2]+SABER_POLYVECCOMPRESSEDBYTES, pk[3]+SABER_POLYVECCOMPRESSEDBYTES});
+
+	GenSecret_x4((uint16_t (*[4])[SABER_N]){w[0].skpv, w[1].skpv, w[2].skpv, w[3].skpv}, noiseseed);
+
+	for(k=0;k<4;k++)
+		enc_core(message[k], pk[k], ciphertext[k], &w[k]);
+}
+
+
 void indcpa_kem_dec(const unsigned char *sk, const unsigned char *ciphertext, unsigned char message_dec[])
+{
+	saber_scratch w;
+
+	indcpa_kem_dec_with_scratch(sk, ciphertext, message_dec, &w);
+}
+
+
+void indcpa_kem_dec_with_scratch(const unsigned char *sk, const unsigned char *ciphertext, unsigned char message_dec[], saber_scratch *w)
 {
 
 	uint32_t i,j;
 	
 	
-	uint16_t sksv[SABER_K][SABER_N]; //secret key of the server
+	uint16_t (*sksv)[SABER_N] = w->skpv; //secret key of the server
 	
 
-	uint16_t pksv[SABER_K][SABER_N];
+	uint16_t (*pksv)[SABER_N] = w->pkcl;
 	
 	uint8_t scale_ar[SABER_SCALEBYTES_KEM];
 	
@@ -261,7 +351,7 @@ void indcpa_kem_dec(const unsigned char *sk, const unsigned char *ciphertext, un
 		}
 	}
 
-	InnerProd(pksv,sksv,mod_p,v);
+	InnerProd(pksv,sksv,mod_p,v,&w->mul);
 
 
 	//Extraction
@@ -290,15 +380,15 @@ void indcpa_kem_dec(const unsigned char *sk, const unsigned char *ciphertext, un
 
 }
 
-void MatrixVectorMul(polyvec *a, uint16_t skpv[SABER_K][SABER_N], uint16_t res[SABER_K][SABER_N], uint16_t mod, int16_t transpose){
+void MatrixVectorMul(polyvec *a, uint16_t skpv[SABER_K][SABER_N], uint16_t res[SABER_K][SABER_N], uint16_t mod, int16_t transpose, saber_mul_scratch *w){
 
-	uint16_t acc[SABER_N]; 
+	uint16_t *acc = w->acc; 
 	int32_t i,j,k;
 
 	if(transpose==1){
 		for(i=0;i<SABER_K;i++){
 			for(j=0;j<SABER_K;j++){
-				pol_mul((uint16_t *)&a[j].vec[i], skpv[j], acc, SABER_Q, SABER_N);			
+				pol_mul((uint16_t *)&a[j].vec[i], skpv[j], acc, SABER_Q, SABER_N, w);			
 
 				for(k=0;k<SABER_N;k++){
 					res[i][k]=res[i][k]+acc[k];
@@ -313,7 +403,7 @@ void MatrixVectorMul(polyvec *a, uint16_t skpv[SABER_K][SABER_N], uint16_t res[S
 
 		for(i=0;i<SABER_K;i++){
 			for(j=0;j<SABER_K;j++){
-				pol_mul((uint16_t *)&a[i].vec[j], skpv[j], acc, SABER_Q, SABER_N);			
+				pol_mul((uint16_t *)&a[i].vec[j], skpv[j], acc, SABER_Q, SABER_N, w);			
 				for(k=0;k<SABER_N;k++){
 					res[i][k]=res[i][k]+acc[k];
 					res[i][k]=res[i][k]&mod; //reduction
@@ -341,15 +431,15 @@ void POL2MSG(uint16_t *message_dec_unpacked, unsigned char *message_dec){
 }
 
 
-void InnerProd(uint16_t pkcl[SABER_K][SABER_N],uint16_t skpv[SABER_K][SABER_N],uint16_t mod,uint16_t res[SABER_N]){
+void InnerProd(uint16_t pkcl[SABER_K][SABER_N],uint16_t skpv[SABER_K][SABER_N],uint16_t mod,uint16_t res[SABER_N], saber_mul_scratch *w){
 
 
 	uint32_t j,k;
-	uint16_t acc[SABER_N]; 
+	uint16_t *acc = w->acc; 
 
 	// vector-vector scalar multiplication with mod p
 	for(j=0;j<SABER_K;j++){
-		pol_mul(pkcl[j], skpv[j], acc , SABER_P, SABER_N);
+		pol_mul(pkcl[j], skpv[j], acc , SABER_P, SABER_N, w);
 
 			for(k=0;k<SABER_N;k++){
 				res[k]=res[k]+acc[k];
@@ -1,14 +1,31 @@
 #ifndef INDCPA_H
 #define INDCPA_H
 
+#include "poly.h"
+#include "poly_mul.h"
+
+// Large temporaries of the three operations, on the stack of indcpa_kem_*, or
+// from the caller for indcpa_kem_*_with_scratch
+typedef struct {
+	polyvec a[SABER_K];                                 // matrix A
+	unsigned char a_bytes[SABER_K*SABER_K*13*SABER_N/8]; // SHAKE128 output expanded to A
+	uint16_t skpv[SABER_K][SABER_N];                    // secret vector
+	uint16_t res[SABER_K][SABER_N];                     // A*s, rounded
+	uint16_t pkcl[SABER_K][SABER_N];                    // unpacked public key, or ciphertext
+	saber_mul_scratch mul;
+} saber_scratch;
+
 void indcpa_kem_keypair(unsigned char *pk, unsigned char *sk);
 void indcpa_kem_enc(unsigned char *message, unsigned char *noiseseed, const unsigned char *pk, unsigned char *ciphertext);
 void indcpa_kem_dec(const unsigned char *sk, const unsigned char *ciphertext, unsigned char *message_dec);
 
+void indcpa_kem_keypair_with_scratch(unsigned char *pk, unsigned char *sk, saber_scratch *w);
+void indcpa_kem_enc_with_scratch(unsigned char *message, unsigned char *noiseseed, const unsigned char *pk, unsigned char *ciphertext, saber_scratch *w);
+void indcpa_kem_dec_with_scratch(const unsigned char *sk, const unsigned char *ciphertext, unsigned char *message_dec, saber_scratch *w);
 
-uint64_t clock1,clock2;
-uint64_t clock_kp_mv,clock_cl_mv, clock_kp_sm, clock_cl_sm;
-
+// Four at a time with the SHAKE128 four-way; w points to four scratches
+void indcpa_kem_keypair_x4(unsigned char *pk[4], unsigned char *sk[4], const unsigned char *seed[4], const unsigned char *noiseseed[4], saber_scratch *w);
+void indcpa_kem_enc_x4(const unsigned char *message[4], const unsigned char *noiseseed[4], const unsigned char *pk[4], unsigned char *ciphertext[4], saber_scratch *w);
 
 #endif
 
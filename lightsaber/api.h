@@ -11,6 +11,8 @@
 #ifndef api_h
 #define api_h
 
+#include <stddef.h>
+
 // Available algorithms for different security levels
 #define LightSaber 1
 #define Saber 2
@@ -50,4 +52,16 @@ int crypto_kem_keypair(unsigned char *pk, unsigned char *sk);
 int crypto_kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk);
 int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk);
 
+// The same with the large temporaries in a caller-owned arena of crypto_kem_scratch_bytes() bytes
+size_t crypto_kem_scratch_bytes(void);
+int crypto_kem_keypair_with_scratch(unsigned char *pk, unsigned char *sk, void *scratch);
+int crypto_kem_enc_with_scratch(unsigned char *ct, unsigned char *ss, const unsigned char *pk, void *scratch);
+int crypto_kem_dec_with_scratch(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, void *scratch);
+
+// n operations over arrays of keys, ciphertexts and shared secrets, the Keccak calls four at a time;
+// same output as n single calls
+int crypto_kem_keypair_batch(unsigned char *pk, unsigned char *sk, size_t n);
+int crypto_kem_enc_batch(unsigned char *ct, unsigned char *ss, const unsigned char *pk, size_t n);
+int crypto_kem_dec_batch(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, size_t n);
+
 #endif /* api_h */
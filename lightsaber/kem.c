@@ -5,15 +5,16 @@
 #include "SABER_indcpa.h"
 #include "kem.h"
 #include "verify.h"
-#include "rng.h"
+#include "randombytes.h"
 #include "fips202.h"
+#include "fips202x4.h"
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-int crypto_kem_keypair(unsigned char *pk, unsigned char *sk)
+static int kem_keypair(unsigned char *pk, unsigned char *sk, saber_scratch *w)
 {
   int i;
  
-  indcpa_kem_keypair(pk, sk);					      // sk[0:SABER_INDCPA_SECRETKEYBYTES-1] <-- sk
+  indcpa_kem_keypair_with_scratch(pk, sk, w);			      // sk[0:SABER_INDCPA_SECRETKEYBYTES-1] <-- sk
   for(i=0;i<SABER_INDCPA_PUBLICKEYBYTES;i++)
     sk[i+SABER_INDCPA_SECRETKEYBYTES] = pk[i];			      // sk[SABER_INDCPA_SECRETKEYBYTES:SABER_INDCPA_SECRETKEYBYTES+SABER_INDCPA_SECRETKEYBYTES-1] <-- pk	
 
@@ -24,7 +25,7 @@ int crypto_kem_keypair(unsigned char *pk, unsigned char *sk)
   return(0);	
 }
 
-int crypto_kem_enc(unsigned char *c, unsigned char *k, const unsigned char *pk)
+static int kem_enc(unsigned char *c, unsigned char *k, const unsigned char *pk, saber_scratch *w)
 {
 
   unsigned char kr[64];                             	  // Will contain key, coins
@@ -39,7 +40,7 @@ int crypto_kem_enc(unsigned char *c, unsigned char *k, const unsigned char *pk)
   sha3_512(kr, buf, 64);				// kr[0:63] <-- Hash(buf[0:63]);  	
 							  								// K^ <-- kr[0:31]
 							  								// noiseseed (r) <-- kr[32:63];	
-  indcpa_kem_enc(buf, kr+32, pk,  c);	// buf[0:31] contains message; kr[32:63] contains randomness r;  
+  indcpa_kem_enc_with_scratch(buf, kr+32, pk,  c, w);	// buf[0:31] contains message; kr[32:63] contains randomness r;  
 
   sha3_256(kr+32, c, SABER_BYTES_CCA_DEC);              
 
@@ -49,7 +50,7 @@ int crypto_kem_enc(unsigned char *c, unsigned char *k, const unsigned char *pk)
 }
 
 
-int crypto_kem_dec(unsigned char *k, const unsigned char *c, const unsigned char *sk)
+static int kem_dec(unsigned char *k, const unsigned char *c, const unsigned char *sk, saber_scratch *w)
 {
   int i, fail;
   unsigned char cmp[SABER_BYTES_CCA_DEC];
@@ -57,7 +58,7 @@ int crypto_kem_dec(unsigned char *k, const unsigned char *c, const unsigned char
   unsigned char kr[64];                             // Will contain key, coins
   const unsigned char *pk = sk + SABER_INDCPA_SECRETKEYBYTES;
 
-   indcpa_kem_dec(sk, c, buf);			     // buf[0:31] <-- message
+   indcpa_kem_dec_with_scratch(sk, c, buf, w);	     // buf[0:31] <-- message
 
  
   // Multitarget countermeasure for coins + contributory KEM 
@@ -66,7 +67,7 @@ int crypto_kem_dec(unsigned char *k, const unsigned char *c, const unsigned char
 
   sha3_512(kr, buf, 64);
 
-  indcpa_kem_enc(buf, kr+32, pk, cmp);
+  indcpa_kem_enc_with_scratch(buf, kr+32, pk, cmp, w);
 
 
   fail = verify(c, cmp, SABER_BYTES_CCA_DEC);
@@ -79,3 +80,156 @@ int crypto_kem_dec(unsigned char *k, const unsigned char *c, const unsigned char
 
   return(0);	
 }
+
+int crypto_kem_keypair(unsigned char *pk, unsigned char *sk)
+{
+  saber_scratch w;
+
+  return kem_keypair(pk, sk, &w);
+}
+
+int crypto_kem_enc(unsigned char *c, unsigned char *k, const unsigned char *pk)
+{
+  saber_scratch w;
+
+  return kem_enc(c, k, pk, &w);
+}
+
+int crypto_kem_dec(unsigned char *k, const unsigned char *c, const unsigned char *sk)
+{
+  saber_scratch w;
+
+  return kem_dec(k, c, sk, &w);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The same with the matrix, vectors and multiplication temporaries in a caller-owned arena of
+// crypto_kem_scratch_bytes() bytes (aligned as by malloc), which all three operations can share
+
+size_t crypto_kem_scratch_bytes(void)
+{
+  return sizeof(saber_scratch);
+}
+
+int crypto_kem_keypair_with_scratch(unsigned char *pk, unsigned char *sk, void *scratch)
+{
+  return kem_keypair(pk, sk, (saber_scratch *)scratch);
+}
+
+int crypto_kem_enc_with_scratch(unsigned char *c, unsigned char *k, const unsigned char *pk, void *scratch)
+{
+  return kem_enc(c, k, pk, (saber_scratch *)scratch);
+}
+
+int crypto_kem_dec_with_scratch(unsigned char *k, const unsigned char *c, const unsigned char *sk, void *scratch)
+{
+  return kem_dec(k, c, sk, (saber_scratch *)scratch);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// n calls of crypto_kem_*, the i-th one with the i-th key or ciphertext and with randomness drawn in the
+// same order: groups of four share the SHAKE128 of A and s and the SHA3-256 of pk and c, the rest goes singly
+
+int crypto_kem_keypair_batch(unsigned char *pk, unsigned char *sk, size_t n)
+{
+  saber_scratch w[4];
+  unsigned char seed[4][SABER_SEEDBYTES];
+  unsigned char noiseseed[4][SABER_COINBYTES];
+  unsigned char *pkx[4], *skx[4];
+  size_t i = 0, k;
+
+  for(;i+4<=n;i+=4)
+  {
+    for(k=0;k<4;k++)
+    {
+      pkx[k] = pk+(i+k)*SABER_PUBLICKEYBYTES;
+      skx[k] = sk+(i+k)*SABER_SECRETKEYBYTES;
+      randombytes(seed[k], SABER_SEEDBYTES);
+      randombytes(noiseseed[k], SABER_COINBYTES);
+      randombytes(skx[k]+SABER_SECRETKEYBYTES-SABER_KEYBYTES, SABER_KEYBYTES);
+    }
+    indcpa_kem_keypair_x4(pkx, skx, (const unsigned char *[4]){seed[0], seed[1], seed[2], seed[3]},
+                          (const unsigned char *[4]){noiseseed[0], noiseseed[1], noiseseed[2], noiseseed[3]}, w);
+    for(k=0;k<4;k++)
+      memcpy(skx[k]+SABER_INDCPA_SECRETKEYBYTES, pkx[k], SABER_INDCPA_PUBLICKEYBYTES);
+    sha3_256x4(skx[0]+SABER_SECRETKEYBYTES-64, skx[1]+SABER_SECRETKEYBYTES-64, skx[2]+SABER_SECRETKEYBYTES-64, skx[3]+SABER_SECRETKEYBYTES-64,
+               pkx[0], pkx[1], pkx[2], pkx[3], SABER_INDCPA_PUBLICKEYBYTES);
+  }
+  for(;i<n;i++)
+    kem_keypair(pk+i*SABER_PUBLICKEYBYTES, sk+i*SABER_SECRETKEYBYTES, &w[0]);
+  return(0);
+}
+
+int crypto_kem_enc_batch(unsigned char *c, unsigned char *k, const unsigned char *pk, size_t n)
+{
+  saber_scratch w[4];
+  unsigned char kr[4][64];
+  unsigned char buf[4][64];
+  unsigned char *cx[4];
+  const unsigned char *pkx[4];
+  size_t i = 0, j;
+
+  for(;i+4<=n;i+=4)
+  {
+    for(j=0;j<4;j++)
+    {
+      cx[j] = c+(i+j)*SABER_BYTES_CCA_DEC;
+      pkx[j] = pk+(i+j)*SABER_PUBLICKEYBYTES;
+      randombytes(buf[j], 32);
+    }
+    sha3_256x4(buf[0], buf[1], buf[2], buf[3], buf[0], buf[1], buf[2], buf[3], 32);
+    sha3_256x4(buf[0]+32, buf[1]+32, buf[2]+32, buf[3]+32, pkx[0], pkx[1], pkx[2], pkx[3], SABER_INDCPA_PUBLICKEYBYTES);
+    for(j=0;j<4;j++)
+      sha3_512(kr[j], buf[j], 64);
+
+    indcpa_kem_enc_x4((const unsigned char *[4]){buf[0], buf[1], buf[2], buf[3]},
+                      (const unsigned char *[4]){kr[0]+32, kr[1]+32, kr[2]+32, kr[3]+32}, pkx, cx, w);
+
+    sha3_256x4(kr[0]+32, kr[1]+32, kr[2]+32, kr[3]+32, cx[0], cx[1], cx[2], cx[3], SABER_BYTES_CCA_DEC);
+    sha3_256x4(k+i*SABER_KEYBYTES, k+(i+1)*SABER_KEYBYTES, k+(i+2)*SABER_KEYBYTES, k+(i+3)*SABER_KEYBYTES,
+               kr[0], kr[1], kr[2], kr[3], 64);
+  }
+  for(;i<n;i++)
+    kem_enc(c+i*SABER_BYTES_CCA_DEC, k+i*SABER_KEYBYTES, pk+i*SABER_PUBLICKEYBYTES, &w[0]);
+  return(0);
+}
+
+int crypto_kem_dec_batch(unsigned char *k, const unsigned char *c, const unsigned char *sk, size_t n)
+{
+  saber_scratch w[4];
+  unsigned char cmp[4][SABER_BYTES_CCA_DEC];
+  unsigned char buf[4][64];
+  unsigned char kr[4][64];
+  const unsigned char *cx[4], *skx[4], *pkx[4];
+  int fail;
+  size_t i = 0, j;
+
+  for(;i+4<=n;i+=4)
+  {
+    for(j=0;j<4;j++)
+    {
+      cx[j] = c+(i+j)*SABER_BYTES_CCA_DEC;
+      skx[j] = sk+(i+j)*SABER_SECRETKEYBYTES;
+      pkx[j] = skx[j]+SABER_INDCPA_SECRETKEYBYTES;
+      indcpa_kem_dec_with_scratch(skx[j], cx[j], buf[j], &w[j]);
+      memcpy(buf[j]+32, skx[j]+SABER_SECRETKEYBYTES-64, 32);
+      sha3_512(kr[j], buf[j], 64);
+    }
+
+    indcpa_kem_enc_x4((const unsigned char *[4]){buf[0], buf[1], buf[2], buf[3]},
+                      (const unsigned char *[4]){kr[0]+32, kr[1]+32, kr[2]+32, kr[3]+32}, pkx,
+                      (unsigned char *[4]){cmp[0], cmp[1], cmp[2], cmp[3]}, w);
+
+    sha3_256x4(kr[0]+32, kr[1]+32, kr[2]+32, kr[3]+32, cx[0], cx[1], cx[2], cx[3], SABER_BYTES_CCA_DEC);
+    for(j=0;j<4;j++)
+    {
+      fail = verify(cx[j], cmp[j], SABER_BYTES_CCA_DEC);
+      cmov(kr[j], skx[j]+SABER_SECRETKEYBYTES-SABER_KEYBYTES, SABER_KEYBYTES, fail);
+    }
+    sha3_256x4(k+i*SABER_KEYBYTES, k+(i+1)*SABER_KEYBYTES, k+(i+2)*SABER_KEYBYTES, k+(i+3)*SABER_KEYBYTES,
+               kr[0], kr[1], kr[2], kr[3], 64);
+  }
+  for(;i<n;i++)
+    kem_dec(k+i*SABER_KEYBYTES, c+i*SABER_BYTES_CCA_DEC, sk+i*SABER_SECRETKEYBYTES, &w[0]);
+  return(0);
+}
@@ -10,6 +10,7 @@ Vadim Lyubashevsky, John M. Schanck, Peter Schwabe & Damien stehle
 #include "poly.h"
 #include "cbd.h"
 #include "fips202.h"
+#include "fips202x4.h"
 
 
 
@@ -29,3 +30,24 @@ void GenSecret(uint16_t r[SABER_K][SABER_N],const unsigned char *seed){
 			cbd(r[i],buf+i*SABER_MU*SABER_N/8);
 		}
 }
+
+// GenSecret of four seeds at once, the SHAKE128 four-way
+void GenSecret_x4(uint16_t (*r[4])[SABER_N],const unsigned char *seed[4]){
+
+
+		uint32_t i,k;
+
+		int32_t buf_size= SABER_MU*SABER_N*SABER_K/8;
+
+		uint8_t buf[4][buf_size];
+
+		shake128x4(buf[0], buf[1], buf[2], buf[3], buf_size, seed[0], seed[1], seed[2], seed[3], SABER_NOISESEEDBYTES);
+
+		for(k=0;k<4;k++)
+		{
+			for(i=0;i<SABER_K;i++)
+			{
+				cbd(r[k][i],buf[k]+i*SABER_MU*SABER_N/8);
+			}
+		}
+}
@@ -22,5 +22,6 @@ typedef struct{
 } polyvec;
 
 void GenSecret(uint16_t r[SABER_K][SABER_N],const unsigned char *seed);
+void GenSecret_x4(uint16_t (*r[4])[SABER_N],const unsigned char *seed[4]);
 
 #endif
@@ -27,7 +27,7 @@ void print_poly2(int16_t *a, int64_t n, uint64_t p){
 	printf("\n-----------------------\n");
 }
 
-void pol_mul(uint16_t* a, uint16_t* b, uint16_t* res, uint16_t p, uint32_t n)
+void pol_mul(uint16_t* a, uint16_t* b, uint16_t* res, uint16_t p, uint32_t n, saber_mul_scratch *w)
 
 { 
 	// Polynomial multiplication using the schoolbook method, c[x] = a[x]*b[x] 
@@ -37,11 +37,11 @@ void pol_mul(uint16_t* a, uint16_t* b, uint16_t* res, uint16_t p, uint32_t n)
 
 //-------------------normal multiplication-----------------
 
-	uint16_t c[512];
+	uint16_t *c = w->c;
 
 	for (i = 0; i < 512; i++) c[i] = 0;
 
-	toom_cook_4way(a, b, c);
+	toom_cook_4way(a, b, c, w);
 
 	//---------------reduction-------
 	for(i=n;i<2*n;i++){
@@ -50,13 +50,13 @@ void pol_mul(uint16_t* a, uint16_t* b, uint16_t* res, uint16_t p, uint32_t n)
 	
 
 }
-void karatsuba_simple(const uint16_t* a_1,const uint16_t* b_1, uint16_t* result_final){//uses 10 registers
+void karatsuba_simple(const uint16_t* a_1,const uint16_t* b_1, uint16_t* result_final, saber_mul_scratch *w){//uses 10 registers
 
 	uint16_t N=64;
-	uint16_t d01[N/2-1];
-	uint16_t d0123[N/2-1];
-	uint16_t d23[N/2-1];
-	uint16_t result_d01[N-1];	
+	uint16_t *d01 = w->d01;
+	uint16_t *d0123 = w->d0123;
+	uint16_t *d23 = w->d23;
+	uint16_t *result_d01 = w->result_d01;
 
 	int32_t i,j;
 
@@ -139,14 +139,14 @@ void karatsuba_simple(const uint16_t* a_1,const uint16_t* b_1, uint16_t* result_
 
 
 
-void toom_cook_4way (const uint16_t* a1,const uint16_t* b1, uint16_t* result)
+void toom_cook_4way (const uint16_t* a1,const uint16_t* b1, uint16_t* result, saber_mul_scratch *w)
 {
 	uint16_t inv3 = 43691, inv9 = 36409, inv15 = 61167;
 
-	uint16_t aw1[N_SB], aw2[N_SB], aw3[N_SB], aw4[N_SB], aw5[N_SB], aw6[N_SB], aw7[N_SB];
-	uint16_t bw1[N_SB], bw2[N_SB], bw3[N_SB], bw4[N_SB], bw5[N_SB], bw6[N_SB], bw7[N_SB];
-	uint16_t w1[N_SB_RES] = {0}, w2[N_SB_RES] = {0}, w3[N_SB_RES] = {0}, w4[N_SB_RES] = {0},
-			 w5[N_SB_RES] = {0}, w6[N_SB_RES] = {0}, w7[N_SB_RES] = {0};
+	// Evaluations and point products in w; karatsuba_simple sets all of w1..w7
+	uint16_t *aw1 = w->aw[0], *aw2 = w->aw[1], *aw3 = w->aw[2], *aw4 = w->aw[3], *aw5 = w->aw[4], *aw6 = w->aw[5], *aw7 = w->aw[6];
+	uint16_t *bw1 = w->bw[0], *bw2 = w->bw[1], *bw3 = w->bw[2], *bw4 = w->bw[3], *bw5 = w->bw[4], *bw6 = w->bw[5], *bw7 = w->bw[6];
+	uint16_t *w1 = w->w[0], *w2 = w->w[1], *w3 = w->w[2], *w4 = w->w[3], *w5 = w->w[4], *w6 = w->w[5], *w7 = w->w[6];
 	uint16_t r0, r1, r2, r3, r4, r5, r6, r7;
 	uint16_t *A0, *A1, *A2, *A3, *B0, *B1, *B2, *B3;
 	A0 = (uint16_t*)a1;
@@ -205,13 +205,13 @@ void toom_cook_4way (const uint16_t* a1,const uint16_t* b1, uint16_t* result)
 
 // MULTIPLICATION
 
-	karatsuba_simple(aw1, bw1, w1);
-	karatsuba_simple(aw2, bw2, w2);
-	karatsuba_simple(aw3, bw3, w3);
-	karatsuba_simple(aw4, bw4, w4);
-	karatsuba_simple(aw5, bw5, w5);
-	karatsuba_simple(aw6, bw6, w6);
-	karatsuba_simple(aw7, bw7, w7);
+	karatsuba_simple(aw1, bw1, w1, w);
+	karatsuba_simple(aw2, bw2, w2, w);
+	karatsuba_simple(aw3, bw3, w3, w);
+	karatsuba_simple(aw4, bw4, w4, w);
+	karatsuba_simple(aw5, bw5, w5, w);
+	karatsuba_simple(aw6, bw6, w6, w);
+	karatsuba_simple(aw7, bw7, w7, w);
 
 // INTERPOLATION
 	for (i = 0; i < N_SB_RES; ++i) {
@@ -1,9 +1,24 @@
+#ifndef POLY_MUL_H
+#define POLY_MUL_H
+
+#include <stdint.h>
 #include"SABER_params.h"
 
-void pol_mul(uint16_t* a, uint16_t* b, uint16_t* res, uint16_t p, uint32_t n);
+// Temporaries of pol_mul: the unreduced product, the Toom-Cook 4-way evaluations
+// and point products, and the Karatsuba intermediates
+typedef struct {
+	uint16_t c[2*SABER_N];
+	uint16_t aw[7][SABER_N/4], bw[7][SABER_N/4];
+	uint16_t w[7][SABER_N/2-1];
+	uint16_t d01[SABER_N/8-1], d0123[SABER_N/8-1], d23[SABER_N/8-1], result_d01[SABER_N/4-1];
+	uint16_t acc[SABER_N];
+} saber_mul_scratch;
+
+void pol_mul(uint16_t* a, uint16_t* b, uint16_t* res, uint16_t p, uint32_t n, saber_mul_scratch *w);
 
 void pol_mul_sb(int16_t* a, int16_t* b, int16_t* res, uint16_t p, uint32_t n,uint32_t start);
 
-void toom_cook_4way(const uint16_t* a1, const uint16_t* b1, uint16_t* result);
+void toom_cook_4way(const uint16_t* a1, const uint16_t* b1, uint16_t* result, saber_mul_scratch *w);
+
 
-static inline int16_t reduce(int16_t a, int64_t p);
+#endif
@@ -0,0 +1,27 @@
+#include "api.h"
+#include "qsiot_kem.h"
+
+// As declared in kem.h
+int crypto_kem_keypair(unsigned char *pk, unsigned char *sk);
+int crypto_kem_enc(unsigned char *c, unsigned char *k, const unsigned char *pk);
+int crypto_kem_dec(unsigned char *k, const unsigned char *c, const unsigned char *sk);
+
+// Registry descriptor (../common/qsiot_kem.h)
+const qsiot_kem qsiot_kem_lightsaber = {
+	.name = CRYPTO_ALGNAME,
+	.family = CRYPTO_ALGNAME,
+	.publickeybytes = CRYPTO_PUBLICKEYBYTES,
+	.secretkeybytes = CRYPTO_SECRETKEYBYTES,
+	.ciphertextbytes = CRYPTO_CIPHERTEXTBYTES,
+	.bytes = CRYPTO_BYTES,
+	.keypair = crypto_kem_keypair,
+	.enc = crypto_kem_enc,
+	.dec = crypto_kem_dec,
+	.keypair_batch = crypto_kem_keypair_batch,
+	.enc_batch = crypto_kem_enc_batch,
+	.dec_batch = crypto_kem_dec_batch,
+	.scratch_bytes = crypto_kem_scratch_bytes,
+	.keypair_with_scratch = crypto_kem_keypair_with_scratch,
+	.enc_with_scratch = crypto_kem_enc_with_scratch,
+	.dec_with_scratch = crypto_kem_dec_with_scratch,
+};
@@ -4,12 +4,29 @@
  *      -Set TIME=1 for measuring the CPU usage.
  *      -Set MEMORY=1 for measuring the RAM usage.
  *      -Set RPI=1 if the tests are to be done on a RPI device. 
+ *      -Set RNGCOST=1 (with TIME=1) to also time every randombytes() call of the scheme and split
+ *       each operation into randomness and algorithm, or RNGSTREAM=1 to additionally replace the
+ *       scheme's generator with a pre-filled deterministic stream.
+ *      -Set BATCH=n (implies TIME=1) to also run n instances at a time through the single calls
+ *       and through the batch entry points of the descriptor (and n encapsulations to one public
+ *       key through prepare_pk/enc_prepared), and report per-item latency and throughput of both.
+ *      -Set POOL=t (implies TIME=1) to run every measured call as a job of a pool of t pinned
+ *       threads (common/qsiot_pool.h), and then N jobs of each operation at once through it.
+ *      -Set KEYPOOL=w (implies TIME=1) to also time N ephemeral handshakes (keygen, enc, dec) with
+ *       the keypair generated inline and with it taken from a background pool refilled up to w
+ *       keypairs (common/qsiot_keypool.h), and report the pool's hit rate and refill throughput.
  * Select an appropiate mechanism for performance measurment:
  *      -Set NTRU=1 for selecting NTRUhps2048509.
  *      -Set NTRUP=1 for selecting NTRULPr653. 
+ *      -Set SNTRUP653=1, SNTRUP761=1 or SNTRUP857=1 for selecting Streamlined NTRU Prime, or
+ *       NTRULPR653=1, NTRULPR761=1 or NTRULPR857=1 for selecting NTRU LPRime, from the
+ *       namespaced libraries built by "make variants" in ntrulpr653/.
  *      -Set SABER=1 for selecting LightSaber.
  *      -Set KYBER=1 for selecting Kyber512.
- *      -Set FRODO=1 for selecting FrodoKEM-640.
+ *      -Set FRODO=1 for selecting FrodoKEM-640 (matrix A from AES128), or FRODO_SHAKE=1 for
+ *       FrodoKEM-640 with A from SHAKE128 (both built by "make variants" in FrodoKEM-640/).
+ *      -Or set ALL=1 to link every scheme behind the registry of common/qsiot_kem.h and pick one
+ *       at run time by name (e.g. ./test output.csv Kyber512); without a name the list is printed.
  * For this program to work, it is assumed that a static library from the selected mechanism is present 
  * in the same location as this file, and the api.h file is present in folders described bellow.
  * When measuring the CPU performance, you should pass a csv file when running the program. In this file, 
@@ -38,6 +55,34 @@
 #include "ntrulpr653/crypto_kem.h"
 #endif
 
+// NTRU Prime parameter sets, one namespaced library each
+#if defined(SNTRUP653)
+#define NTRUPRIME_VARIANT sntrup653
+#elif defined(SNTRUP761)
+#define NTRUPRIME_VARIANT sntrup761
+#elif defined(SNTRUP857)
+#define NTRUPRIME_VARIANT sntrup857
+#elif defined(NTRULPR653)
+#define NTRUPRIME_VARIANT ntrulpr653
+#elif defined(NTRULPR761)
+#define NTRUPRIME_VARIANT ntrulpr761
+#elif defined(NTRULPR857)
+#define NTRUPRIME_VARIANT ntrulpr857
+#endif
+
+#ifdef NTRUPRIME_VARIANT
+#include "ntrulpr653/crypto_kem_variants.h"
+#define NTRUPRIME_NAME2(v, f) crypto_kem_##v##_##f
+#define NTRUPRIME_NAME(v, f) NTRUPRIME_NAME2(v, f)
+#define CRYPTO_PUBLICKEYBYTES NTRUPRIME_NAME(NTRUPRIME_VARIANT, PUBLICKEYBYTES)
+#define CRYPTO_SECRETKEYBYTES NTRUPRIME_NAME(NTRUPRIME_VARIANT, SECRETKEYBYTES)
+#define CRYPTO_CIPHERTEXTBYTES NTRUPRIME_NAME(NTRUPRIME_VARIANT, CIPHERTEXTBYTES)
+#define CRYPTO_BYTES NTRUPRIME_NAME(NTRUPRIME_VARIANT, BYTES)
+#define crypto_kem_keypair NTRUPRIME_NAME(NTRUPRIME_VARIANT, keypair)
+#define crypto_kem_enc NTRUPRIME_NAME(NTRUPRIME_VARIANT, enc)
+#define crypto_kem_dec NTRUPRIME_NAME(NTRUPRIME_VARIANT, dec)
+#endif
+
 #ifdef SABER
 #include "lightsaber/api.h"
 #endif
@@ -50,41 +95,174 @@
 #include "FrodoKEM-640/api.h"
 #endif
 
+#include "common/qsiot_kem.h"
+#ifdef POOL
+#include "common/qsiot_pool.h"
+#endif
+#ifdef KEYPOOL
+#include <unistd.h>
+#include "common/qsiot_keypool.h"
+#endif
 #include "performance.h"
 
+#if !defined(QSIOT_REGISTRY) && defined(NTRUPRIME_VARIANT)
+// The namespaced library keeps its scratch entry points local: its own descriptor has them all
+#define NTRUPRIME_KEM2(v) qsiot_kem_##v
+#define NTRUPRIME_KEM(v) NTRUPRIME_KEM2(v)
+extern const qsiot_kem NTRUPRIME_KEM(NTRUPRIME_VARIANT);
+#define selectedKEM NTRUPRIME_KEM(NTRUPRIME_VARIANT)
+#elif !defined(QSIOT_REGISTRY)
+// The scheme selected at build time, behind the same descriptor as the registry's
+static const qsiot_kem selectedKEM = {
+    .name = "selected",
+    .publickeybytes = CRYPTO_PUBLICKEYBYTES,
+    .secretkeybytes = CRYPTO_SECRETKEYBYTES,
+    .ciphertextbytes = CRYPTO_CIPHERTEXTBYTES,
+    .bytes = CRYPTO_BYTES,
+    .keypair = crypto_kem_keypair,
+    .enc = crypto_kem_enc,
+    .dec = crypto_kem_dec,
+    .scratch_bytes = crypto_kem_scratch_bytes,
+    .keypair_with_scratch = crypto_kem_keypair_with_scratch,
+    .enc_with_scratch = crypto_kem_enc_with_scratch,
+    .dec_with_scratch = crypto_kem_dec_with_scratch,
+    .keypair_batch = crypto_kem_keypair_batch,
+    .enc_batch = crypto_kem_enc_batch,
+    .dec_batch = crypto_kem_dec_batch,
+#ifdef KYBER
+    .preparedbytes = CRYPTO_PREPAREDBYTES,
+    .prepare_pk = crypto_kem_prepare_pk,
+    .enc_prepared = crypto_kem_enc_prepared,
+#endif
+};
+#endif
+
+#ifdef BATCH
+// Operations of the batch report; "Enc (one pk)" is n encapsulations to the same public key
+enum { BATCH_KEYGEN, BATCH_ENC, BATCH_DEC, BATCH_ENC_ONEPK, BATCH_OPS };
+static const char *batchNames[BATCH_OPS] = { "KeyGen", "Enc", "Dec", "Enc (one pk)" };
+#endif
+
 #ifdef RPI
 #define uint64_t u_int64_t
 #endif
 
 void computeMean(int N, struct values **means, struct values **keygen, struct values **dec, struct values **enc)
 {
-    means[0]->cycles = means[0]->time = 0;
-    means[1]->cycles = means[1]->time = 0;
-    means[2]->cycles = means[2]->time = 0;
+    means[0]->cycles = means[0]->time = means[0]->rng_cycles = 0;
+    means[1]->cycles = means[1]->time = means[1]->rng_cycles = 0;
+    means[2]->cycles = means[2]->time = means[2]->rng_cycles = 0;
     for (int i = 0; i < N; i++)
     {
         means[0]->cycles += keygen[i]->cycles;
         means[0]->time += keygen[i]->time;
+        means[0]->rng_cycles += keygen[i]->rng_cycles;
         means[1]->cycles += enc[i]->cycles;
         means[1]->time += enc[i]->time;
+        means[1]->rng_cycles += enc[i]->rng_cycles;
         means[2]->cycles += dec[i]->cycles;
         means[2]->time += dec[i]->time;
+        means[2]->rng_cycles += dec[i]->rng_cycles;
     }
     means[0]->cycles /= N;
     means[0]->time /= N;
+    means[0]->rng_cycles /= N;
     means[1]->cycles /= N;
     means[1]->time /= N;
+    means[1]->rng_cycles /= N;
     means[2]->cycles /= N;
     means[2]->time /= N;
+    means[2]->rng_cycles /= N;
+}
+
+#ifdef POOL
+// measureTimeKEM drives the pool through these, one job in flight at a time
+static qsiot_pool *pool;
+static const qsiot_kem *poolKEM;
+
+static int runPoolJob(qsiot_job_op op, unsigned char *pk, unsigned char *sk, unsigned char *ct, unsigned char *ss)
+{
+    qsiot_job job = { .kem = poolKEM, .op = op, .pk = pk, .sk = sk, .ct = ct, .ss = ss };
+
+    if (qsiot_pool_submit(pool, &job) != 0)
+        return -1;
+    qsiot_pool_wait_completion(pool);
+    return job.result;
+}
+
+static int poolKeypair(unsigned char *pk, unsigned char *sk)
+{
+    return runPoolJob(QSIOT_JOB_KEYPAIR, pk, sk, NULL, NULL);
+}
+
+static int poolEnc(unsigned char *ct, unsigned char *ss, const unsigned char *pk)
+{
+    return runPoolJob(QSIOT_JOB_ENC, (unsigned char *)pk, NULL, ct, ss);
+}
+
+static int poolDec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk)
+{
+    return runPoolJob(QSIOT_JOB_DEC, NULL, (unsigned char *)sk, (unsigned char *)ct, ss);
 }
 
-void measureTimeKEM(int N, struct values **means, struct values **keygen, struct values **dec, struct values **enc)
+/*
+ * N jobs of each operation submitted at once, every one on its own key or ciphertext; out[0..2]
+ * get the KeyGen, Enc and Dec cycles and microseconds per job. Returns the number of jobs
+ * that failed or whose decapsulated secret differs from the encapsulated one.
+ */
+int measurePoolKEM(const qsiot_kem *kem, int N, struct values *out)
+{
+    unsigned char *pk = malloc(N * kem->publickeybytes), *sk = malloc(N * kem->secretkeybytes);
+    unsigned char *ct = malloc(N * kem->ciphertextbytes);
+    unsigned char *ss = malloc(N * kem->bytes), *ss2 = malloc(N * kem->bytes);
+    qsiot_job *jobs = calloc(N, sizeof(qsiot_job)), *job;
+    struct timeval start, end;
+    double low, high;
+    int i, op, failed = 0;
+
+    for (op = 0; op < 3; op++)
+    {
+        for (i = 0; i < N; i++)
+        {
+            jobs[i].kem = kem;
+            jobs[i].op = op == 0 ? QSIOT_JOB_KEYPAIR : op == 1 ? QSIOT_JOB_ENC : QSIOT_JOB_DEC;
+            jobs[i].pk = pk + i*kem->publickeybytes;
+            jobs[i].sk = sk + i*kem->secretkeybytes;
+            jobs[i].ct = ct + i*kem->ciphertextbytes;
+            jobs[i].ss = (op == 2 ? ss2 : ss) + i*kem->bytes;
+        }
+        gettimeofday(&start, NULL);
+        low = (double) rdtsc();
+        failed += N - (int) qsiot_pool_submit_many(pool, jobs, N);
+        qsiot_pool_wait_idle(pool);
+        high = (double) rdtsc();
+        gettimeofday(&end, NULL);
+        out[op].cycles = (high - low) / N;
+        out[op].time = ((double) (end.tv_sec * 1000000 + end.tv_usec) - (start.tv_sec * 1000000 + start.tv_usec)) / N;
+        while ((job = qsiot_pool_poll_completion(pool)) != NULL)
+            failed += job->result != 0;
+    }
+    for (i = 0; i < N; i++)
+        failed += memcmp(ss + i*kem->bytes, ss2 + i*kem->bytes, kem->bytes) != 0;
+
+    free(pk);
+    free(sk);
+    free(ct);
+    free(ss);
+    free(ss2);
+    free(jobs);
+    return failed;
+}
+#endif
+
+void measureTimeKEM(const qsiot_kem *kem, int N, struct values **means, struct values **keygen, struct values **dec, struct values **enc)
 {
     // For measuring time
     int i;
 
     // For the scheme
-    unsigned char pk[CRYPTO_PUBLICKEYBYTES], sk[CRYPTO_SECRETKEYBYTES], ss[CRYPTO_BYTES], ct[CRYPTO_CIPHERTEXTBYTES];
+    unsigned char *pk = malloc(kem->publickeybytes), *sk = malloc(kem->secretkeybytes);
+    unsigned char *ss = malloc(kem->bytes), *ct = malloc(kem->ciphertextbytes);
     struct values *keygenA = NULL, *encA = NULL, *decA = NULL;
 
     for (i = 0; i < N; i++)
@@ -94,22 +272,209 @@ void measureTimeKEM(int N, struct values **means, struct values **keygen, struct
         encA = enc[i];
         decA = dec[i];
 #endif
+#ifdef POOL
+        poolKEM = kem;
+        testKeyGen(poolKeypair, pk, sk, keygenA);
+        testEnc(poolEnc, ct, ss, pk, encA);
+        testDec(poolDec, ss, ct, sk, decA);
+#else
         // Key generation
-        testKeyGen(crypto_kem_keypair, pk, sk, keygenA);
+        testKeyGen(kem->keypair, pk, sk, keygenA);
         // Encapsulation
-        testEnc(crypto_kem_enc, ct, ss, pk, encA);
+        testEnc(kem->enc, ct, ss, pk, encA);
         // Decapsulation
-        testDec(crypto_kem_dec, ss, ct, sk, decA);
+        testDec(kem->dec, ss, ct, sk, decA);
+#endif
     }
+    free(pk);
+    free(sk);
+    free(ss);
+    free(ct);
 
 #ifdef TIME
     computeMean(N, means, keygen, dec, enc);
 #endif
 }
 
-void makeTest(int N, struct values **means, struct values **keygen, struct values **dec, struct values **enc, char *file)
+#ifdef BATCH
+static double batchCycles;
+static struct timeval batchStart;
+
+static void startBatchClock()
 {
-    measureTimeKEM(N, means, keygen, dec, enc);
+    gettimeofday(&batchStart, NULL);
+    batchCycles = (double) rdtsc();
+}
+
+// Adds the cycles and microseconds since startBatchClock() to v
+static void stopBatchClock(struct values *v)
+{
+    double high = (double) rdtsc();
+    struct timeval end;
+
+    gettimeofday(&end, NULL);
+    v->cycles += high - batchCycles;
+    v->time += (double) (end.tv_sec * 1000000 + end.tv_usec) - (batchStart.tv_sec * 1000000 + batchStart.tv_usec);
+}
+
+/*
+ * Runs rounds x n instances of every operation through the single calls (single[op]) and
+ * through the batch entry points (batch[op]); both end up with the mean cycles and
+ * microseconds per item. Schemes without batch or prepared-key entry points go through
+ * the loops of the qsiot_kem_*_batch helpers and the single enc.
+ */
+void measureBatchKEM(const qsiot_kem *kem, int rounds, size_t n, struct values *single, struct values *batch)
+{
+    unsigned char *pk = malloc(n * kem->publickeybytes), *sk = malloc(n * kem->secretkeybytes);
+    unsigned char *ss = malloc(n * kem->bytes), *ct = malloc(n * kem->ciphertextbytes);
+    unsigned char *prepared = kem->enc_prepared != NULL ? malloc(kem->preparedbytes) : NULL;
+    size_t i;
+    int r, op;
+
+    memset(single, 0, BATCH_OPS * sizeof(struct values));
+    memset(batch, 0, BATCH_OPS * sizeof(struct values));
+    for (r = 0; r < rounds; r++)
+    {
+        startBatchClock();
+        for (i = 0; i < n; i++)
+            kem->keypair(pk + i*kem->publickeybytes, sk + i*kem->secretkeybytes);
+        stopBatchClock(&single[BATCH_KEYGEN]);
+        startBatchClock();
+        qsiot_kem_keypair_batch(kem, pk, sk, n);
+        stopBatchClock(&batch[BATCH_KEYGEN]);
+
+        startBatchClock();
+        for (i = 0; i < n; i++)
+            kem->enc(ct + i*kem->ciphertextbytes, ss + i*kem->bytes, pk + i*kem->publickeybytes);
+        stopBatchClock(&single[BATCH_ENC]);
+        startBatchClock();
+        qsiot_kem_enc_batch(kem, ct, ss, pk, n);
+        stopBatchClock(&batch[BATCH_ENC]);
+
+        startBatchClock();
+        for (i = 0; i < n; i++)
+            kem->dec(ss + i*kem->bytes, ct + i*kem->ciphertextbytes, sk + i*kem->secretkeybytes);
+        stopBatchClock(&single[BATCH_DEC]);
+        startBatchClock();
+        qsiot_kem_dec_batch(kem, ss, ct, sk, n);
+        stopBatchClock(&batch[BATCH_DEC]);
+
+        startBatchClock();
+        for (i = 0; i < n; i++)
+            kem->enc(ct + i*kem->ciphertextbytes, ss + i*kem->bytes, pk);
+        stopBatchClock(&single[BATCH_ENC_ONEPK]);
+        startBatchClock();
+        if (prepared != NULL)
+        {
+            kem->prepare_pk(prepared, pk);
+            for (i = 0; i < n; i++)
+                kem->enc_prepared(ct + i*kem->ciphertextbytes, ss + i*kem->bytes, prepared);
+        }
+        else
+        {
+            for (i = 0; i < n; i++)
+                kem->enc(ct + i*kem->ciphertextbytes, ss + i*kem->bytes, pk);
+        }
+        stopBatchClock(&batch[BATCH_ENC_ONEPK]);
+    }
+    for (op = 0; op < BATCH_OPS; op++)
+    {
+        single[op].cycles /= (double) rounds * n;
+        single[op].time /= (double) rounds * n;
+        batch[op].cycles /= (double) rounds * n;
+        batch[op].time /= (double) rounds * n;
+    }
+    free(pk);
+    free(sk);
+    free(ss);
+    free(ct);
+    free(prepared);
+}
+#endif
+
+#ifdef KEYPOOL
+// Idle time before every handshake, in which the background thread refills the pool
+#define HANDSHAKE_IDLE_US 1000
+
+enum { HANDSHAKE_KEYGEN, HANDSHAKE_TOTAL };
+
+/*
+ * N ephemeral handshakes (keygen and decaps on one side, encaps on the other), each after
+ * HANDSHAKE_IDLE_US of idle time: first with keypair() on the critical path (plain), then with
+ * the keypair taken from a pool of KEYPOOL keypairs refilled from KEYPOOL/2 (pooled). Both get
+ * the mean cycles and microseconds of the key generation and of the whole handshake. Returns
+ * the number of handshakes whose two secrets differ, or -1 when the pool cannot be started.
+ */
+int measureHandshakeKEM(const qsiot_kem *kem, int N, struct values *plain, struct values *pooled, qsiot_keypool_stats *stats)
+{
+    unsigned char *pk = malloc(kem->publickeybytes), *sk = malloc(kem->secretkeybytes);
+    unsigned char *ct = malloc(kem->ciphertextbytes);
+    unsigned char *ss = malloc(kem->bytes), *ss2 = malloc(kem->bytes);
+    qsiot_keypool *keypool = NULL;
+    struct values *out;
+    struct timeval start, mid, end;
+    double low, between, high;
+    int i, pass, failed = 0;
+
+    for (pass = 0; pass < 2; pass++)
+    {
+        out = pass == 0 ? plain : pooled;
+        memset(out, 0, 2 * sizeof(struct values));
+        if (pass == 1)
+        {
+            keypool = qsiot_keypool_create(kem, KEYPOOL, KEYPOOL / 2);
+            if (keypool == NULL)
+            {
+                failed = -1;
+                break;
+            }
+            qsiot_keypool_wait_filled(keypool, KEYPOOL);
+        }
+        for (i = 0; i < N; i++)
+        {
+            usleep(HANDSHAKE_IDLE_US);
+            gettimeofday(&start, NULL);
+            low = (double) rdtsc();
+            if (keypool != NULL)
+                qsiot_keypool_keypair(keypool, pk, sk);
+            else
+                kem->keypair(pk, sk);
+            between = (double) rdtsc();
+            gettimeofday(&mid, NULL);
+            kem->enc(ct, ss, pk);
+            kem->dec(ss2, ct, sk);
+            high = (double) rdtsc();
+            gettimeofday(&end, NULL);
+            out[HANDSHAKE_KEYGEN].cycles += between - low;
+            out[HANDSHAKE_KEYGEN].time += (double) (mid.tv_sec * 1000000 + mid.tv_usec) - (start.tv_sec * 1000000 + start.tv_usec);
+            out[HANDSHAKE_TOTAL].cycles += high - low;
+            out[HANDSHAKE_TOTAL].time += (double) (end.tv_sec * 1000000 + end.tv_usec) - (start.tv_sec * 1000000 + start.tv_usec);
+            failed += memcmp(ss, ss2, kem->bytes) != 0;
+        }
+        for (i = 0; i < 2; i++)
+        {
+            out[i].cycles /= N;
+            out[i].time /= N;
+        }
+    }
+    if (keypool != NULL)
+    {
+        qsiot_keypool_stats_get(keypool, stats);
+        qsiot_keypool_destroy(keypool);
+    }
+
+    free(pk);
+    free(sk);
+    free(ct);
+    free(ss);
+    free(ss2);
+    return failed;
+}
+#endif
+
+void makeTest(const qsiot_kem *kem, int N, struct values **means, struct values **keygen, struct values **dec, struct values **enc, char *file)
+{
+    measureTimeKEM(kem, N, means, keygen, dec, enc);
 }
 
 int main(int argc, char **argv)
@@ -125,6 +490,20 @@ int main(int argc, char **argv)
     struct values **keygen = NULL, **enc = NULL, **dec = NULL, **means = NULL;
     int N = 1, i, j;
     char *file = NULL;
+    const qsiot_kem *kem;
+
+#ifdef QSIOT_REGISTRY
+    kem = argc > 2 ? qsiot_kem_by_name(argv[2]) : NULL;
+    if (kem == NULL)
+    {
+        printf("Provide the name of the mechanism: output.csv name. Available:\n");
+        for (i = 0; i < (int)qsiot_kem_count(); i++)
+            printf("\t%s\n", qsiot_kem_get(i)->name);
+        return 0;
+    }
+#else
+    kem = &selectedKEM;
+#endif
 
 #ifdef TIME
     N = 2000;
@@ -136,21 +515,90 @@ int main(int argc, char **argv)
     /* Allocate memory for each entry */
     for (j = 0; j < N; j++)
     {
-        keygen[j] = (struct values *) malloc (sizeof(struct values));
-        enc[j] = (struct values *) malloc (sizeof(struct values));
-        dec[j] = (struct values *) malloc (sizeof(struct values));
+        keygen[j] = (struct values *) calloc (1, sizeof(struct values));
+        enc[j] = (struct values *) calloc (1, sizeof(struct values));
+        dec[j] = (struct values *) calloc (1, sizeof(struct values));
     }
     means[0] = (struct values *)malloc(sizeof(struct values));
     means[1] = (struct values *)malloc(sizeof(struct values));
     means[2] = (struct values *)malloc(sizeof(struct values));
 #endif
 
-    makeTest(N, means, keygen, dec, enc, file);
+#ifdef POOL
+    pool = qsiot_pool_create(POOL, 1);
+    if (pool == NULL)
+    {
+        printf("Could not start the pool of %d threads\n", POOL);
+        return 1;
+    }
+#endif
+    makeTest(kem, N, means, keygen, dec, enc, file);
+#ifdef POOL
+    // The same number of jobs as measured calls, all at once
+    struct values poolBulk[3];
+    unsigned long long poolJobs, poolSteals;
+    int poolFailed = measurePoolKEM(kem, N, poolBulk);
+    qsiot_pool_stats(pool, &poolJobs, &poolSteals);
+    qsiot_pool_destroy(pool);
+#endif
+#ifdef KEYPOOL
+    // As many handshakes as measured calls
+    struct values handshakePlain[2], handshakePooled[2];
+    qsiot_keypool_stats keypoolStats = { 0 };
+    int handshakeFailed = measureHandshakeKEM(kem, N, handshakePlain, handshakePooled, &keypoolStats);
+    if (handshakeFailed < 0)
+    {
+        printf("Could not start the keypair pool\n");
+        return 1;
+    }
+    unsigned long long keypoolTakes = keypoolStats.hits + keypoolStats.misses;
+    double keypoolHitRate = keypoolTakes ? (double) keypoolStats.hits / keypoolTakes : 0;
+    double keypoolRefill = keypoolStats.refill_seconds > 0 ? keypoolStats.generated / keypoolStats.refill_seconds : 0;
+#endif
+#ifdef BATCH
+    // As many instances as the per-call measurement, BATCH at a time
+    struct values batchSingle[BATCH_OPS], batchBatch[BATCH_OPS];
+    measureBatchKEM(kem, (N + BATCH - 1) / BATCH, BATCH, batchSingle, batchBatch);
+#endif
 
 #ifdef TIME
     printf("Mean for the KeyGen function:\n\t%f\t%f\n", means[0]->cycles, means[0]->time);
     printf("Mean for the Enc function:\n\t%f\t%f\n", means[1]->cycles, means[1]->time);
     printf("Mean for the Dec function:\n\t%f\t%f\n", means[2]->cycles, means[2]->time);
+#ifdef RNGCOST
+    printf("Cycles split into randomness and algorithm:\n");
+    printf("\tKeyGen:\t%f\t%f\n", means[0]->rng_cycles, means[0]->cycles - means[0]->rng_cycles);
+    printf("\tEnc:\t%f\t%f\n", means[1]->rng_cycles, means[1]->cycles - means[1]->rng_cycles);
+    printf("\tDec:\t%f\t%f\n", means[2]->rng_cycles, means[2]->cycles - means[2]->rng_cycles);
+#endif
+
+#ifdef BATCH
+    printf("Per item, %d instances at a time (cycles, uS, items/s):\n", BATCH);
+    for (i = 0; i < BATCH_OPS; i++)
+    {
+        printf("\t%s, single calls:\t%f\t%f\t%f\n", batchNames[i], batchSingle[i].cycles, batchSingle[i].time, 1e6 / batchSingle[i].time);
+        printf("\t%s, batch:\t%f\t%f\t%f\n", batchNames[i], batchBatch[i].cycles, batchBatch[i].time, 1e6 / batchBatch[i].time);
+    }
+#endif
+
+#ifdef POOL
+    printf("%d jobs at once on %d threads, per job (cycles, uS, jobs/s):\n", N, POOL);
+    printf("\tKeyGen:\t%f\t%f\t%f\n", poolBulk[0].cycles, poolBulk[0].time, 1e6 / poolBulk[0].time);
+    printf("\tEnc:\t%f\t%f\t%f\n", poolBulk[1].cycles, poolBulk[1].time, 1e6 / poolBulk[1].time);
+    printf("\tDec:\t%f\t%f\t%f\n", poolBulk[2].cycles, poolBulk[2].time, 1e6 / poolBulk[2].time);
+    printf("\t%llu jobs, %llu stolen, %d failed\n", poolJobs, poolSteals, poolFailed);
+#endif
+
+#ifdef KEYPOOL
+    printf("%d handshakes, %d uS apart, keypair inline or from a pool of %d (cycles, uS):\n", N, HANDSHAKE_IDLE_US, KEYPOOL);
+    printf("\tKeyGen, inline:\t%f\t%f\n", handshakePlain[HANDSHAKE_KEYGEN].cycles, handshakePlain[HANDSHAKE_KEYGEN].time);
+    printf("\tKeyGen, keypool:\t%f\t%f\n", handshakePooled[HANDSHAKE_KEYGEN].cycles, handshakePooled[HANDSHAKE_KEYGEN].time);
+    printf("\tHandshake, inline:\t%f\t%f\n", handshakePlain[HANDSHAKE_TOTAL].cycles, handshakePlain[HANDSHAKE_TOTAL].time);
+    printf("\tHandshake, keypool:\t%f\t%f\n", handshakePooled[HANDSHAKE_TOTAL].cycles, handshakePooled[HANDSHAKE_TOTAL].time);
+    printf("\t%llu hits, %llu misses (hit rate %.2f%%), %llu refilled at %f keypairs/s (%llu refill failures), %d failed\n",
+           keypoolStats.hits, keypoolStats.misses, 100 * keypoolHitRate, keypoolStats.generated, keypoolRefill,
+           keypoolStats.failures, handshakeFailed);
+#endif
 
     FILE *pFile;
     pFile = fopen(argv[1], "w");
@@ -181,6 +629,41 @@ int main(int argc, char **argv)
         fprintf(pFile, "%f,", dec[i]->cycles);
     fprintf(pFile, "%f\n", dec[N-1]->cycles);
 
+#ifdef RNGCOST
+    // The algorithm part of each operation is cycles - randomness cycles
+    fprintf(pFile, "KeyGen randomness (cycles), Enc randomness (cycles), Dec randomness (cycles)\n");
+    for (i = 0; i < N - 1; i++)
+        fprintf(pFile, "%f,", keygen[i]->rng_cycles);
+    fprintf(pFile, "%f\n", keygen[N-1]->rng_cycles);
+
+    for (i = 0; i < N - 1; i++)
+        fprintf(pFile, "%f,", enc[i]->rng_cycles);
+    fprintf(pFile, "%f\n", enc[N-1]->rng_cycles);
+
+    for (i = 0; i < N - 1; i++)
+        fprintf(pFile, "%f,", dec[i]->rng_cycles);
+    fprintf(pFile, "%f\n", dec[N-1]->rng_cycles);
+
+#endif
+#ifdef POOL
+    fprintf(pFile, "Per job (%d at once on %d threads), KeyGen (cycles), Enc (cycles), Dec (cycles), KeyGen (uS), Enc (uS), Dec (uS)\n", N, POOL);
+    fprintf(pFile, "%f,%f,%f,%f,%f,%f\n", poolBulk[0].cycles, poolBulk[1].cycles, poolBulk[2].cycles,
+            poolBulk[0].time, poolBulk[1].time, poolBulk[2].time);
+#endif
+#ifdef KEYPOOL
+    fprintf(pFile, "Handshakes (keypool of %d), inline KeyGen (cycles), keypool KeyGen (cycles), inline handshake (cycles), keypool handshake (cycles), "
+            "inline KeyGen (uS), keypool KeyGen (uS), inline handshake (uS), keypool handshake (uS), hit rate, refill (keypairs/s)\n", KEYPOOL);
+    fprintf(pFile, "%f,%f,%f,%f,%f,%f,%f,%f,%f,%f\n", handshakePlain[HANDSHAKE_KEYGEN].cycles, handshakePooled[HANDSHAKE_KEYGEN].cycles,
+            handshakePlain[HANDSHAKE_TOTAL].cycles, handshakePooled[HANDSHAKE_TOTAL].cycles,
+            handshakePlain[HANDSHAKE_KEYGEN].time, handshakePooled[HANDSHAKE_KEYGEN].time,
+            handshakePlain[HANDSHAKE_TOTAL].time, handshakePooled[HANDSHAKE_TOTAL].time, keypoolHitRate, keypoolRefill);
+#endif
+#ifdef BATCH
+    fprintf(pFile, "Per item (%d at a time), single (cycles), batch (cycles), single (uS), batch (uS), single (items/s), batch (items/s)\n", BATCH);
+    for (i = 0; i < BATCH_OPS; i++)
+        fprintf(pFile, "%s,%f,%f,%f,%f,%f,%f\n", batchNames[i], batchSingle[i].cycles, batchBatch[i].cycles,
+                batchSingle[i].time, batchBatch[i].time, 1e6 / batchSingle[i].time, 1e6 / batchBatch[i].time);
+#endif
     for (j = 0; j < N; j++)
     {
         free(keygen[j]);
@@ -8,8 +8,11 @@ def measureCPUPerformance():
     """
     For each cipher, execute the performances tests.
     """
-    ciphers = ["NTRUP=1", "NTRU=1", "SABER=1", "KYBER=1", "FRODO=1"]
-    files = ["ntrulpr653", "ntruhps2048509", "ligthsaber", "kyber512", "frodoKEM640"]
+    ciphers = ["NTRUP=1", "NTRU=1", "SABER=1", "KYBER=1", "FRODO=1", "FRODO_SHAKE=1",
+               "SNTRUP653=1", "SNTRUP761=1", "SNTRUP857=1", "NTRULPR653=1", "NTRULPR761=1", "NTRULPR857=1"]
+    # NTRULPR653=1 is the namespaced build of the same code as NTRUP=1
+    files = ["ntrulpr653", "ntruhps2048509", "ligthsaber", "kyber512", "frodoKEM640", "frodoKEM640shake",
+             "sntrup653", "sntrup761", "sntrup857", "ntrulpr653variant", "ntrulpr761", "ntrulpr857"]
     perf = "Performance.csv"
     folder = "CPUPerformance/"
     for i in range(len(ciphers)):
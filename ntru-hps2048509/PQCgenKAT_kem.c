@@ -9,7 +9,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
-#include "rng.h"
+#include "randombytes.h"
 #include "api.h"
 
 #define	MAX_MARKER_LEN		50
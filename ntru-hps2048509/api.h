@@ -1,6 +1,8 @@
 #ifndef API_H
 #define API_H
 
+#include <stddef.h>
+
 #include "params.h"
 
 #define CRYPTO_SECRETKEYBYTES NTRU_SECRETKEYBYTES
@@ -16,5 +18,21 @@ int crypto_kem_enc(unsigned char *ct, unsigned char *ss, const unsigned char *pk
 
 int crypto_kem_dec(unsigned char *ss, const unsigned char *ct, const unsigned char *sk);
 
+size_t crypto_kem_scratch_bytes(void);
+
+int crypto_kem_keypair_with_scratch(unsigned char *pk, unsigned char *sk, void *scratch);
+
+int crypto_kem_enc_with_scratch(unsigned char *ct, unsigned char *ss, const unsigned char *pk, void *scratch);
+
+int crypto_kem_dec_with_scratch(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, void *scratch);
+
+/* n operations over arrays of keys, ciphertexts and shared secrets, the
+ * SHA3-256 hashing four at a time; same output as n single calls */
+int crypto_kem_keypair_batch(unsigned char *pk, unsigned char *sk, size_t n);
+
+int crypto_kem_enc_batch(unsigned char *ct, unsigned char *ss, const unsigned char *pk, size_t n);
+
+int crypto_kem_dec_batch(unsigned char *ss, const unsigned char *ct, const unsigned char *sk, size_t n);
+
 
 #endif
@@ -1,6 +0,0 @@
-#ifndef CRYPTO_SORT
-#define CRYPTO_SORT
-
-void crypto_sort(void *array,long long n);
-
-#endif
@@ -1,23 +1,138 @@
-#include "rng.h"
+#include <string.h>
+#include "randombytes.h"
 #include "fips202.h"
+#include "fips202x4.h"
 #include "params.h"
 #include "verify.h"
 #include "owcpa.h"
 
+static int kem_keypair(unsigned char *pk, unsigned char *sk, owcpa_scratch *w);
+static int kem_enc(unsigned char *c, unsigned char *k, const unsigned char *pk, owcpa_scratch *w);
+static int kem_dec(unsigned char *k, const unsigned char *c, const unsigned char *sk, owcpa_scratch *w);
+
 // API FUNCTIONS 
 int crypto_kem_keypair(unsigned char *pk, unsigned char *sk)
+{
+  owcpa_scratch w;
+  return kem_keypair(pk, sk, &w);
+}
+
+int crypto_kem_enc(unsigned char *c, unsigned char *k, const unsigned char *pk)
+{
+  owcpa_scratch w;
+  return kem_enc(c, k, pk, &w);
+}
+
+int crypto_kem_dec(unsigned char *k, const unsigned char *c, const unsigned char *sk)
+{
+  owcpa_scratch w;
+  return kem_dec(k, c, sk, &w);
+}
+
+/* One arena of crypto_kem_scratch_bytes() bytes, aligned as by malloc,
+ * serves the three *_with_scratch functions */
+size_t crypto_kem_scratch_bytes(void)
+{
+  return sizeof(owcpa_scratch);
+}
+
+int crypto_kem_keypair_with_scratch(unsigned char *pk, unsigned char *sk, void *scratch)
+{
+  return kem_keypair(pk, sk, (owcpa_scratch *)scratch);
+}
+
+int crypto_kem_enc_with_scratch(unsigned char *c, unsigned char *k, const unsigned char *pk, void *scratch)
+{
+  return kem_enc(c, k, pk, (owcpa_scratch *)scratch);
+}
+
+int crypto_kem_dec_with_scratch(unsigned char *k, const unsigned char *c, const unsigned char *sk, void *scratch)
+{
+  return kem_dec(k, c, sk, (owcpa_scratch *)scratch);
+}
+
+/* n calls of crypto_kem_*, the i-th one with the i-th key or ciphertext and
+ * with randomness drawn in the same order. Key generation hashes nothing, so
+ * it only shares one arena; the SHA3-256 of enc and dec run four at a time */
+int crypto_kem_keypair_batch(unsigned char *pk, unsigned char *sk, size_t n)
+{
+  owcpa_scratch w;
+  size_t i;
+
+  for(i=0;i<n;i++)
+    kem_keypair(pk+i*NTRU_PUBLICKEYBYTES, sk+i*NTRU_SECRETKEYBYTES, &w);
+  return 0;
+}
+
+int crypto_kem_enc_batch(unsigned char *c, unsigned char *k, const unsigned char *pk, size_t n)
+{
+  owcpa_scratch w;
+  unsigned char rm[4][NTRU_OWCPA_MSGBYTES];
+  unsigned char rm_seed[NTRU_SAMPLE_RM_BYTES];
+  size_t i = 0, j;
+
+  for(;i+4<=n;i+=4)
+  {
+    for(j=0;j<4;j++)
+    {
+      randombytes(rm_seed, NTRU_SAMPLE_RM_BYTES);
+      owcpa_samplemsg(rm[j], rm_seed);
+    }
+
+    sha3_256x4(k+i*NTRU_SHAREDKEYBYTES, k+(i+1)*NTRU_SHAREDKEYBYTES, k+(i+2)*NTRU_SHAREDKEYBYTES, k+(i+3)*NTRU_SHAREDKEYBYTES,
+               rm[0], rm[1], rm[2], rm[3], NTRU_OWCPA_MSGBYTES);
+
+    for(j=0;j<4;j++)
+      owcpa_enc_with_scratch(c+(i+j)*NTRU_CIPHERTEXTBYTES, rm[j], pk+(i+j)*NTRU_PUBLICKEYBYTES, &w);
+  }
+  for(;i<n;i++)
+    kem_enc(c+i*NTRU_CIPHERTEXTBYTES, k+i*NTRU_SHAREDKEYBYTES, pk+i*NTRU_PUBLICKEYBYTES, &w);
+  return 0;
+}
+
+int crypto_kem_dec_batch(unsigned char *k, const unsigned char *c, const unsigned char *sk, size_t n)
+{
+  owcpa_scratch w;
+  unsigned char rm[4][NTRU_OWCPA_MSGBYTES];
+  unsigned char prfc[4][NTRU_PRFKEYBYTES+NTRU_CIPHERTEXTBYTES];
+  int fail[4];
+  size_t i = 0, j;
+
+  for(;i+4<=n;i+=4)
+  {
+    for(j=0;j<4;j++)
+    {
+      fail[j] = owcpa_dec_with_scratch(rm[j], c+(i+j)*NTRU_CIPHERTEXTBYTES, sk+(i+j)*NTRU_SECRETKEYBYTES, &w);
+      /* sha3_256x4 takes whole inputs: prf || c is laid out here */
+      memcpy(prfc[j], sk+(i+j)*NTRU_SECRETKEYBYTES+NTRU_OWCPA_SECRETKEYBYTES, NTRU_PRFKEYBYTES);
+      memcpy(prfc[j]+NTRU_PRFKEYBYTES, c+(i+j)*NTRU_CIPHERTEXTBYTES, NTRU_CIPHERTEXTBYTES);
+    }
+
+    sha3_256x4(k+i*NTRU_SHAREDKEYBYTES, k+(i+1)*NTRU_SHAREDKEYBYTES, k+(i+2)*NTRU_SHAREDKEYBYTES, k+(i+3)*NTRU_SHAREDKEYBYTES,
+               rm[0], rm[1], rm[2], rm[3], NTRU_OWCPA_MSGBYTES);
+    sha3_256x4(rm[0], rm[1], rm[2], rm[3], prfc[0], prfc[1], prfc[2], prfc[3], NTRU_PRFKEYBYTES+NTRU_CIPHERTEXTBYTES);
+
+    for(j=0;j<4;j++)
+      cmov(k+(i+j)*NTRU_SHAREDKEYBYTES, rm[j], NTRU_SHAREDKEYBYTES, fail[j]);
+  }
+  for(;i<n;i++)
+    kem_dec(k+i*NTRU_SHAREDKEYBYTES, c+i*NTRU_CIPHERTEXTBYTES, sk+i*NTRU_SECRETKEYBYTES, &w);
+  return 0;
+}
+
+static int kem_keypair(unsigned char *pk, unsigned char *sk, owcpa_scratch *w)
 {
   unsigned char seed[NTRU_SAMPLE_FG_BYTES];
 
   randombytes(seed, NTRU_SAMPLE_FG_BYTES);
-  owcpa_keypair(pk, sk, seed);
+  owcpa_keypair_with_scratch(pk, sk, seed, w);
 
   randombytes(sk+NTRU_OWCPA_SECRETKEYBYTES, NTRU_PRFKEYBYTES);
 
   return 0;
 }
 
-int crypto_kem_enc(unsigned char *c, unsigned char *k, const unsigned char *pk)
+static int kem_enc(unsigned char *c, unsigned char *k, const unsigned char *pk, owcpa_scratch *w)
 {
   unsigned char rm[NTRU_OWCPA_MSGBYTES];
   unsigned char rm_seed[NTRU_SAMPLE_RM_BYTES];
@@ -27,30 +142,28 @@ int crypto_kem_enc(unsigned char *c, unsigned char *k, const unsigned char *pk)
 
   sha3_256(k, rm, NTRU_OWCPA_MSGBYTES);
 
-  owcpa_enc(c, rm, pk);
+  owcpa_enc_with_scratch(c, rm, pk, w);
 
   return 0;
 }
 
-int crypto_kem_dec(unsigned char *k, const unsigned char *c, const unsigned char *sk)
+static int kem_dec(unsigned char *k, const unsigned char *c, const unsigned char *sk, owcpa_scratch *w)
 {
-  int i, fail;
+  int fail;
   unsigned char rm[NTRU_OWCPA_MSGBYTES];
-  unsigned char buf[NTRU_PRFKEYBYTES+NTRU_CIPHERTEXTBYTES];
-  unsigned char *cmp = buf+NTRU_PRFKEYBYTES;
+  keccak_incctx state;
 
-  fail = owcpa_dec(rm, c, sk);
+  fail = owcpa_dec_with_scratch(rm, c, sk, w);
   /* If fail = 0 then c = Enc(h, rm), there is no need to re-encapsulate. */
   /* See comment in owcpa_dec for details.                                */
 
   sha3_256(k, rm, NTRU_OWCPA_MSGBYTES);
 
-  /* shake(secret PRF key || input ciphertext) */
-  for(i=0;i<NTRU_PRFKEYBYTES;i++)
-    buf[i] = sk[i+NTRU_OWCPA_SECRETKEYBYTES];
-  for(i=0;i<NTRU_CIPHERTEXTBYTES;i++)
-    cmp[i] = c[i];
-  sha3_256(rm, cmp, NTRU_PRFKEYBYTES+NTRU_CIPHERTEXTBYTES);
+  /* shake(secret PRF key || input ciphertext), absorbed in place */
+  sha3_256_inc_init(&state);
+  sha3_256_inc_absorb(&state, sk+NTRU_OWCPA_SECRETKEYBYTES, NTRU_PRFKEYBYTES);
+  sha3_256_inc_absorb(&state, c, NTRU_CIPHERTEXTBYTES);
+  sha3_256_inc_finalize(rm, &state);
 
   cmov(k, rm, NTRU_SHAREDKEYBYTES, fail);
 
@@ -57,14 +57,21 @@ void owcpa_keypair(unsigned char *pk,
                    unsigned char *sk,
                    const unsigned char seed[NTRU_SAMPLE_FG_BYTES])
 {
-  int i;
+  owcpa_scratch w;
+  owcpa_keypair_with_scratch(pk, sk, seed, &w);
+}
 
-  poly x1, x2, x3, x4, x5;
+void owcpa_keypair_with_scratch(unsigned char *pk,
+                                unsigned char *sk,
+                                const unsigned char seed[NTRU_SAMPLE_FG_BYTES],
+                                owcpa_scratch *w)
+{
+  int i;
 
-  poly *f=&x1, *invf_mod3=&x2;
-  poly *g=&x3, *G=&x2;
-  poly *Gf=&x3, *invGf=&x4, *tmp=&x5;
-  poly *invh=&x3, *h=&x3;
+  poly *f=&w->x[0], *invf_mod3=&w->x[1];
+  poly *g=&w->x[2], *G=&w->x[1];
+  poly *Gf=&w->x[2], *invGf=&w->x[3], *tmp=&w->x[4];
+  poly *invh=&w->x[2], *h=&w->x[2];
 
   sample_fg(f,g,seed);
 
@@ -91,7 +98,7 @@ void owcpa_keypair(unsigned char *pk,
 
   poly_Rq_mul(Gf, G, f);
 
-  poly_Rq_inv(invGf, Gf);
+  poly_Rq_inv(invGf, Gf, w->inv);
 
   poly_Rq_mul(tmp, invGf, f);
   poly_Sq_mul(invh, tmp, f);
@@ -106,12 +113,20 @@ void owcpa_keypair(unsigned char *pk,
 void owcpa_enc(unsigned char *c,
                const unsigned char *rm,
                const unsigned char *pk)
+{
+  owcpa_scratch w;
+  owcpa_enc_with_scratch(c, rm, pk, &w);
+}
+
+void owcpa_enc_with_scratch(unsigned char *c,
+                            const unsigned char *rm,
+                            const unsigned char *pk,
+                            owcpa_scratch *w)
 {
   int i;
-  poly x1, x2, x3;
-  poly *h = &x1, *liftm = &x1;
-  poly *r = &x2, *m = &x2;
-  poly *ct = &x3;
+  poly *h = &w->x[0], *liftm = &w->x[0];
+  poly *r = &w->x[1], *m = &w->x[1];
+  poly *ct = &w->x[2];
 
   poly_Rq_sum_zero_frombytes(h, pk);
 
@@ -131,15 +146,23 @@ void owcpa_enc(unsigned char *c,
 int owcpa_dec(unsigned char *rm,
               const unsigned char *ciphertext,
               const unsigned char *secretkey)
+{
+  owcpa_scratch w;
+  return owcpa_dec_with_scratch(rm, ciphertext, secretkey, &w);
+}
+
+int owcpa_dec_with_scratch(unsigned char *rm,
+                           const unsigned char *ciphertext,
+                           const unsigned char *secretkey,
+                           owcpa_scratch *w)
 {
   int i;
   int fail;
-  poly x1, x2, x3, x4;
 
-  poly *c = &x1, *f = &x2, *cf = &x3;
-  poly *mf = &x2, *finv3 = &x3, *m = &x4;
-  poly *liftm = &x2, *invh = &x3, *r = &x4;
-  poly *b = &x1;
+  poly *c = &w->x[0], *f = &w->x[1], *cf = &w->x[2];
+  poly *mf = &w->x[1], *finv3 = &w->x[2], *m = &w->x[3];
+  poly *liftm = &w->x[1], *invh = &w->x[2], *r = &w->x[3];
+  poly *b = &w->x[0];
 
   poly_Rq_sum_zero_frombytes(c, ciphertext);
   poly_S3_frombytes(f, secretkey);
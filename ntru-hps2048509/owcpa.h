@@ -2,19 +2,42 @@
 #define OWCPA_H
 
 #include "params.h"
+#include "poly.h"
+
+/* Polynomials of owcpa_keypair (x, and inv for poly_Rq_inv); owcpa_enc and
+ * owcpa_dec use the first polys of x */
+typedef struct{
+  poly x[5];
+  poly inv[4];
+} owcpa_scratch;
 
 void owcpa_samplemsg(unsigned char msg[NTRU_OWCPA_MSGBYTES],
-                     const unsigned char seed[NTRU_SEEDBYTES]);
+                     const unsigned char seed[NTRU_SAMPLE_RM_BYTES]);
+
+void owcpa_keypair_with_scratch(unsigned char *pk,
+                                unsigned char *sk,
+                                const unsigned char seed[NTRU_SAMPLE_FG_BYTES],
+                                owcpa_scratch *w);
 
 void owcpa_keypair(unsigned char *pk,
                    unsigned char *sk,
-                   const unsigned char seed[NTRU_SEEDBYTES]);
+                   const unsigned char seed[NTRU_SAMPLE_FG_BYTES]);
 
 void owcpa_enc(unsigned char *c,
                const unsigned char *rm,
                const unsigned char *pk);
 
+void owcpa_enc_with_scratch(unsigned char *c,
+                            const unsigned char *rm,
+                            const unsigned char *pk,
+                            owcpa_scratch *w);
+
 int owcpa_dec(unsigned char *rm,
               const unsigned char *c,
               const unsigned char *sk);
+
+int owcpa_dec_with_scratch(unsigned char *rm,
+                           const unsigned char *c,
+                           const unsigned char *sk,
+                           owcpa_scratch *w);
 #endif
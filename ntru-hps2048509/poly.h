@@ -11,6 +11,15 @@ typedef struct{
   uint16_t coeffs[NTRU_N];
 } poly;
 
+#define NTRU_WORDS ((NTRU_N+63)/64)
+
+/* Bitsliced element of S3: coefficient i is bit i of each plane.  */
+/* nz marks the nonzero coefficients, sg those equal to 2 (= -1).  */
+typedef struct{
+  uint64_t nz[NTRU_WORDS];
+  uint64_t sg[NTRU_WORDS];
+} poly3;
+
 
 void poly_Sq_tobytes(unsigned char *r, const poly *a);
 void poly_Sq_frombytes(poly *r, const unsigned char *a);
@@ -28,7 +37,8 @@ void poly_S3_mul(poly *r, const poly *a, const poly *b);
 void poly_lift(poly *r, const poly *a);
 void poly_Rq_to_S3(poly *r, const poly *a);
 
-void poly_Rq_inv(poly *r, const poly *a);
+void poly_R2_inv(poly *r, const poly *a);
+void poly_Rq_inv(poly *r, const poly *a, poly tmp[4]);
 void poly_S3_inv(poly *r, const poly *a);
 
 void poly_Z3_to_Zq(poly *r);
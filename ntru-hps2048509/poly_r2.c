@@ -0,0 +1,77 @@
+#include "poly.h"
+#include "poly_words.h"
+
+/* Inversion in R2 on polynomials packed into 64-bit words. */
+
+static inline void words_cswap(uint64_t *a, uint64_t *b, uint64_t swap)
+{
+  int i;
+  uint64_t t;
+
+  for(i=0; i<NTRU_WORDS; i++)
+  {
+    t = (a[i] ^ b[i]) & swap;
+    a[i] ^= t;
+    b[i] ^= t;
+  }
+}
+
+void poly_R2_inv(poly *r, const poly *a)
+{
+  /* Bernstein--Yang constant-time divstep inversion */
+  /* ("Fast constant-time gcd computation and modular inversion") */
+  int i, j;
+  int16_t delta = 1, t;
+  uint64_t swap, sign, an;
+  uint64_t f[NTRU_WORDS], g[NTRU_WORDS], v[NTRU_WORDS], w[NTRU_WORDS];
+
+  /* g(X) := reverse of a(X) mod (2, Phi_n) */
+  for(i=0; i<NTRU_WORDS; i++)
+    f[i] = 0;
+  for(i=0; i<NTRU_N; i++)
+    f[i>>6] |= (uint64_t)(a->coeffs[i] & 1) << (i & 63);
+  an = -((f[NTRU_WORDS-1] >> ((NTRU_N-1) & 63)) & 1);
+  for(i=0; i<NTRU_WORDS; i++)
+    f[i] ^= an;
+  f[NTRU_WORDS-1] &= TOPMASK;
+  words_reverse(g, f);
+
+  /* f(X) := 1 + X + X^2 + ... + X^{N-1} */
+  for(i=0; i<NTRU_WORDS; i++)
+  {
+    f[i] = ~0ULL;
+    v[i] = 0;
+    w[i] = 0;
+  }
+  f[NTRU_WORDS-1] = TOPMASK;
+  w[0] = 1;
+
+  for(j=0; j<2*(NTRU_N-1)-1; j++)
+  {
+    words_mulx(v);
+
+    sign = -(f[0] & g[0] & 1);
+
+    /* swap if delta > 0 and g0 != 0 */
+    swap = -(((uint16_t)-delta >> 15) & g[0] & 1);
+    t = (delta ^ -delta) & (int16_t)swap;
+    delta ^= t;
+    delta += 1;
+
+    words_cswap(f, g, swap);
+    words_cswap(v, w, swap);
+
+    for(i=0; i<NTRU_WORDS; i++)
+    {
+      g[i] ^= f[i] & sign;
+      w[i] ^= v[i] & sign;
+    }
+
+    words_divx(g);
+  }
+
+  /* r(X) := reverse of v(X) */
+  words_reverse(g, v);
+  for(i=0; i<NTRU_N; i++)
+    r->coeffs[i] = (g[i>>6] >> (i & 63)) & 1;
+}
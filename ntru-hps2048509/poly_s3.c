@@ -0,0 +1,180 @@
+#include "poly.h"
+#include "poly_words.h"
+
+/* Arithmetic in S3 on bitsliced polynomials (see poly3 in poly.h).     */
+/* Every routine is branch free and runs over whole 64-bit words.       */
+
+static void poly_S3_tobits(poly3 *r, const poly *a)
+{
+  int i;
+  uint64_t c;
+
+  for(i=0; i<NTRU_WORDS; i++)
+  {
+    r->nz[i] = 0;
+    r->sg[i] = 0;
+  }
+  for(i=0; i<NTRU_N; i++)
+  {
+    c = a->coeffs[i] & 3;
+    r->nz[i>>6] |= ((c | (c >> 1)) & 1) << (i & 63);
+    r->sg[i>>6] |= (c >> 1) << (i & 63);
+  }
+}
+
+static void poly_S3_frombits(poly *r, const poly3 *a)
+{
+  int i;
+
+  for(i=0; i<NTRU_N; i++)
+    r->coeffs[i] = ((a->nz[i>>6] >> (i & 63)) & 1) + ((a->sg[i>>6] >> (i & 63)) & 1);
+}
+
+/* r = r + c*a where the scalar c is given as the masks (cnz, csg) */
+static inline void poly3_fmadd(poly3 *r, const poly3 *a, uint64_t cnz, uint64_t csg)
+{
+  int i;
+  uint64_t bnz, bsg, s, both;
+
+  for(i=0; i<NTRU_WORDS; i++)
+  {
+    bnz = a->nz[i] & cnz;
+    bsg = (a->sg[i] ^ csg) & bnz;
+
+    s = r->sg[i] ^ bsg;
+    both = r->nz[i] & bnz;
+    bnz = (r->nz[i] ^ bnz) | (both & ~s);
+    r->sg[i] = (s | (both & ~r->sg[i])) & bnz;
+    r->nz[i] = bnz;
+  }
+}
+
+static inline void poly3_cswap(poly3 *a, poly3 *b, uint64_t swap)
+{
+  int i;
+  uint64_t t;
+
+  for(i=0; i<NTRU_WORDS; i++)
+  {
+    t = (a->nz[i] ^ b->nz[i]) & swap;
+    a->nz[i] ^= t;
+    b->nz[i] ^= t;
+    t = (a->sg[i] ^ b->sg[i]) & swap;
+    a->sg[i] ^= t;
+    b->sg[i] ^= t;
+  }
+}
+
+/* Reduce modulo Phi_n by subtracting a_{n-1} * Phi_n */
+static void poly3_mod_phi(poly3 *a)
+{
+  int i;
+  poly3 ones;
+  uint64_t cnz, csg;
+
+  for(i=0; i<NTRU_WORDS; i++)
+  {
+    ones.nz[i] = ~0ULL;
+    ones.sg[i] = 0;
+  }
+  ones.nz[NTRU_WORDS-1] = TOPMASK;
+
+  cnz = -((a->nz[NTRU_WORDS-1] >> ((NTRU_N-1) & 63)) & 1);
+  csg = -((a->sg[NTRU_WORDS-1] >> ((NTRU_N-1) & 63)) & 1);
+  poly3_fmadd(a, &ones, cnz, ~csg & cnz);
+}
+
+void poly_S3_mul(poly *r, const poly *a, const poly *b)
+{
+  int i;
+  poly3 x, t, c;
+  uint64_t cnz, csg;
+
+  poly_S3_tobits(&x, a);
+  poly_S3_tobits(&t, b);
+
+  for(i=0; i<NTRU_WORDS; i++)
+  {
+    c.nz[i] = 0;
+    c.sg[i] = 0;
+  }
+
+  /* c = sum_i a_i * x^i * b mod (3, x^n - 1) */
+  for(i=0; i<NTRU_N; i++)
+  {
+    cnz = -((x.nz[i>>6] >> (i & 63)) & 1);
+    csg = -((x.sg[i>>6] >> (i & 63)) & 1);
+    poly3_fmadd(&c, &t, cnz, csg);
+    words_rotx(t.nz);
+    words_rotx(t.sg);
+  }
+
+  poly3_mod_phi(&c);
+  poly_S3_frombits(r, &c);
+}
+
+void poly_S3_inv(poly *r, const poly *a)
+{
+  /* Bernstein--Yang constant-time divstep inversion */
+  /* ("Fast constant-time gcd computation and modular inversion") */
+  int i, j;
+  int16_t delta = 1, t;
+  uint64_t swap, snz, ssg, f0nz, f0sg, g0nz, g0sg;
+  poly3 f, g, v, w;
+
+  /* g(X) := reverse of a(X) mod Phi_n */
+  poly_S3_tobits(&f, a);
+  poly3_mod_phi(&f);
+  words_reverse(g.nz, f.nz);
+  words_reverse(g.sg, f.sg);
+
+  /* f(X) := 1 + X + X^2 + ... + X^{N-1} */
+  for(i=0; i<NTRU_WORDS; i++)
+  {
+    f.nz[i] = ~0ULL;
+    f.sg[i] = 0;
+    v.nz[i] = 0;
+    v.sg[i] = 0;
+    w.nz[i] = 0;
+    w.sg[i] = 0;
+  }
+  f.nz[NTRU_WORDS-1] = TOPMASK;
+  w.nz[0] = 1;
+
+  for(j=0; j<2*(NTRU_N-1)-1; j++)
+  {
+    words_mulx(v.nz);
+    words_mulx(v.sg);
+
+    f0nz = f.nz[0] & 1;
+    f0sg = f.sg[0] & 1;
+    g0nz = g.nz[0] & 1;
+    g0sg = g.sg[0] & 1;
+
+    /* sign = -g0/f0 = -g0*f0 */
+    snz = -(f0nz & g0nz);
+    ssg = -(f0sg ^ g0sg ^ 1) & snz;
+
+    /* swap if delta > 0 and g0 != 0 */
+    swap = -(((uint16_t)-delta >> 15) & g0nz);
+    t = (delta ^ -delta) & (int16_t)swap;
+    delta ^= t;
+    delta += 1;
+
+    poly3_cswap(&f, &g, swap);
+    poly3_cswap(&v, &w, swap);
+
+    poly3_fmadd(&g, &f, snz, ssg);
+    poly3_fmadd(&w, &v, snz, ssg);
+
+    words_divx(g.nz);
+    words_divx(g.sg);
+  }
+
+  /* r(X) := f0 * reverse of v(X) */
+  words_reverse(g.nz, v.nz);
+  words_reverse(g.sg, v.sg);
+  for(i=0; i<NTRU_WORDS; i++)
+    g.sg[i] ^= -(f.sg[0] & 1) & g.nz[i];
+  poly_S3_frombits(r, &g);
+}
@@ -0,0 +1,72 @@
+#ifndef POLY_WORDS_H
+#define POLY_WORDS_H
+
+/* Helpers for polynomials packed one coefficient bit per bit of  */
+/* NTRU_WORDS 64-bit words. Bits at positions >= NTRU_N stay zero. */
+
+#include <stdint.h>
+#include "params.h"
+#include "poly.h"
+
+#if NTRU_N % 64
+#define TOPMASK ((1ULL << (NTRU_N % 64)) - 1)
+#else
+#define TOPMASK (~0ULL)
+#endif
+
+/* Shift used to map bit n-2-i to bit i after a full word reversal */
+#define REVSHIFT (64*NTRU_WORDS + 1 - NTRU_N)
+#if REVSHIFT <= 0 || REVSHIFT >= 64
+#error "poly_words.h assumes 0 < 64*NTRU_WORDS + 1 - NTRU_N < 64"
+#endif
+
+static inline void words_mulx(uint64_t *a)
+{
+  int i;
+  for(i=NTRU_WORDS-1; i>0; i--)
+    a[i] = (a[i] << 1) | (a[i-1] >> 63);
+  a[0] <<= 1;
+  a[NTRU_WORDS-1] &= TOPMASK;
+}
+
+static inline void words_divx(uint64_t *a)
+{
+  int i;
+  for(i=0; i<NTRU_WORDS-1; i++)
+    a[i] = (a[i] >> 1) | (a[i+1] << 63);
+  a[NTRU_WORDS-1] >>= 1;
+}
+
+/* Multiplication by x modulo x^n - 1 */
+static inline void words_rotx(uint64_t *a)
+{
+  uint64_t top = (a[NTRU_WORDS-1] >> ((NTRU_N-1) & 63)) & 1;
+  words_mulx(a);
+  a[0] |= top;
+}
+
+static inline uint64_t rev64(uint64_t x)
+{
+  x = ((x >>  1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) <<  1);
+  x = ((x >>  2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) <<  2);
+  x = ((x >>  4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) <<  4);
+  x = ((x >>  8) & 0x00FF00FF00FF00FFULL) | ((x & 0x00FF00FF00FF00FFULL) <<  8);
+  x = ((x >> 16) & 0x0000FFFF0000FFFFULL) | ((x & 0x0000FFFF0000FFFFULL) << 16);
+  return (x >> 32) | (x << 32);
+}
+
+/* r_i = a_{n-2-i} for i < n-1, r_{n-1} = 0 */
+static inline void words_reverse(uint64_t *r, const uint64_t *a)
+{
+  int i;
+  uint64_t t[NTRU_WORDS];
+
+  for(i=0; i<NTRU_WORDS; i++)
+    t[i] = rev64(a[NTRU_WORDS-1-i]);
+  for(i=0; i<NTRU_WORDS-1; i++)
+    r[i] = (t[i] >> REVSHIFT) | (t[i+1] << (64 - REVSHIFT));
+  r[NTRU_WORDS-1] = t[NTRU_WORDS-1] >> REVSHIFT;
+  r[NTRU_WORDS-1] &= TOPMASK >> 1;
+}
+
+#endif
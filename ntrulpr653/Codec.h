@@ -0,0 +1,58 @@
+#ifndef Codec_H
+#define Codec_H
+
+/*
+Level structure of Encode/Decode for p entries sharing one modulus MOD.
+
+Level 0 is the input. Level l+1 merges the pairs of level l into
+single entries, so level l holds N_l entries. All of them have
+modulus M_l except the last, which has T_l. A full pair at level l
+emits CODEC_BYTES(M_l*M_l) bytes. The last pair (when N_l is even)
+emits CODEC_BYTES(M_l*T_l). Level l's bytes start at offset O_l of the
+encoding, and level CODEC_LEVELS is a single entry of modulus T.
+
+CODEC(X,MOD) defines all of these as enum constants X##N##l, X##M##l,
+X##T##l and X##O##l, plus the total length X##Len, so the callers'
+divisors are compile-time constants.
+*/
+
+#if p <= 512 || p > 1024
+#error "Codec.h expects 512 < p <= 1024"
+#endif
+
+#define CODEC_LEVELS 10
+
+#define CODEC_BYTES(m) ((m) > 256*16383 ? 2 : (m) >= 16384 ? 1 : 0)
+#define CODEC_SHRINK(m) (CODEC_BYTES(m) == 2 ? ((((m)+255)>>8)+255)>>8 : CODEC_BYTES(m) == 1 ? ((m)+255)>>8 : (m))
+
+/* bytes emitted by level l */
+#define CODEC_LEVELBYTES(X,l) \
+  (((X##N##l-1)/2)*CODEC_BYTES(X##M##l*X##M##l) \
+  + ((X##N##l&1) ? 0 : CODEC_BYTES(X##M##l*X##T##l)))
+
+#define CODEC_LEVEL(X,l,k) \
+  X##N##l = (X##N##k+1)/2, \
+  X##M##l = CODEC_SHRINK(X##M##k*X##M##k), \
+  X##T##l = (X##N##k&1) ? X##T##k : CODEC_SHRINK(X##M##k*X##T##k), \
+  X##O##l = X##O##k + CODEC_LEVELBYTES(X,k)
+
+#define CODEC(X,MOD) \
+  enum { \
+    X##N0 = p, X##M0 = (MOD), X##T0 = (MOD), X##O0 = 0, \
+    CODEC_LEVEL(X,1,0), CODEC_LEVEL(X,2,1), CODEC_LEVEL(X,3,2), \
+    CODEC_LEVEL(X,4,3), CODEC_LEVEL(X,5,4), CODEC_LEVEL(X,6,5), \
+    CODEC_LEVEL(X,7,6), CODEC_LEVEL(X,8,7), CODEC_LEVEL(X,9,8), \
+    CODEC_LEVEL(X,10,9), \
+    X##Len = X##O10 + (X##T10 == 1 ? 0 : X##T10 <= 256 ? 1 : 2) \
+  }; \
+  typedef char X##levels_check[X##N10 == 1 ? 1 : -1]
+
+/* the two moduli used by kem.c */
+CODEC(Rounded_,(q+2)/3);
+typedef char Rounded_len_check[Rounded_Len == Rounded_bytes ? 1 : -1];
+#ifndef LPR
+CODEC(Rq_,q);
+typedef char Rq_len_check[Rq_Len == Rq_bytes ? 1 : -1];
+#endif
+
+#endif
@@ -1,55 +1,110 @@
+#include "params.h"
 #include "uint16.h"
 #include "uint32.h"
+#include "Codec.h"
 #include "Decode.h"
+#include "reduce.h"
 
-extern void Decode(uint16 *out,const unsigned char *S,const uint16 *M,long long len)
+/*
+Non-recursive Decode for p entries of one modulus (see Codec.h).
+Levels are undone from the top down, in place in the output array.
+Each level's bytes are read at their compile-time offset. Divisions
+use the constant-divisor routines of reduce.h. On AVX2, eight pairs
+are split at once.
+*/
+
+/* undo level n (moduli m, last t): R[0...n/2] holds level n+1, S the level's bytes */
+static inline __attribute__((always_inline))
+void decode_level(uint16 *R,const unsigned char *S,int n,uint32 m,uint32 t)
 {
-  if (len == 1) {
-    if (M[0] == 1)
-      *out = 0;
-    else if (M[0] <= 256)
-      *out = uint32_mod_uint14(S[0],M[0]);
-    else
-      *out = uint32_mod_uint14(S[0]+(((uint16)S[1])<<8),M[0]);
-  }
-  if (len > 1) {
-    uint16 R2[(len+1)/2];
-    uint16 M2[(len+1)/2];
-    uint16 bottomr[len/2];
-    uint32 bottomt[len/2];
-    long long i;
-    for (i = 0;i < len-1;i += 2) {
-      uint32 m = M[i]*(uint32) M[i+1];
-      if (m > 256*16383) {
-        bottomt[i/2] = 256*256;
-        bottomr[i/2] = S[0]+256*S[1];
-        S += 2;
-        M2[i/2] = (((m+255)>>8)+255)>>8;
-      } else if (m >= 16384) {
-        bottomt[i/2] = 256;
-        bottomr[i/2] = S[0];
-        S += 1;
-        M2[i/2] = (m+255)>>8;
-      } else {
-        bottomt[i/2] = 1;
-        bottomr[i/2] = 0;
-        M2[i/2] = m;
-      }
-    }
-    if (i < len)
-      M2[i/2] = M[i];
-    Decode(R2,S,M2,(len+1)/2);
-    for (i = 0;i < len-1;i += 2) {
-      uint32 r = bottomr[i/2];
-      uint32 r1;
-      uint16 r0;
-      r += bottomt[i/2]*R2[i/2];
-      uint32_divmod_uint14(&r1,&r0,r,M[i]);
-      r1 = uint32_mod_uint14(r1,M[i+1]); /* only needed for invalid inputs */
-      *out++ = r0;
-      *out++ = r1;
+  const int b = CODEC_BYTES(m*m);
+  const int pairs = (n-1)/2;
+  int j;
+  uint32 r,r0,r1,junk;
+
+  if (n&1)
+    R[n-1] = R[pairs];
+  else {
+    const unsigned char *s = S+pairs*b;
+    uint32 mm = m*t;
+    r = R[pairs];
+    if (mm > 256*16383) {
+      r = s[0]+256*s[1]+(r<<16);
+    } else if (mm >= 16384) {
+      r = s[0]+(r<<8);
     }
-    if (i < len)
-      *out++ = R2[i/2];
+    uint32_divmod_const(&r1,&r0,r,m);
+    uint32_divmod_const(&junk,&r1,r1,t); /* only needed for invalid inputs */
+    R[n-2] = r0;
+    R[n-1] = r1;
+  }
+
+  j = pairs;
+#ifdef __AVX2__
+  /* in place from the top: a block reads R[j-8...j-1] before writing R[2j-16...2j-1] */
+  for (;j >= 8;j -= 8) {
+    __m256i x = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) (R+j-8)));
+    __m256i hi,junk;
+    if (b == 1)
+      x = _mm256_add_epi32(_mm256_slli_epi32(x,8),_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) (S+j-8))));
+    if (b == 2)
+      x = _mm256_add_epi32(_mm256_slli_epi32(x,16),_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) (S+2*(j-8)))));
+    x = uint32_divmod_const_x8(&hi,x,m);
+    hi = uint32_divmod_const_x8(&junk,hi,m); /* only needed for invalid inputs */
+    _mm256_storeu_si256((__m256i *) (R+2*(j-8)),_mm256_or_si256(x,_mm256_slli_epi32(hi,16)));
+  }
+#endif
+  while (j > 0) {
+    --j;
+    r = R[j];
+    if (b == 1) r = S[j]+(r<<8);
+    if (b == 2) r = S[2*j]+256*S[2*j+1]+(r<<16);
+    uint32_divmod_const(&r1,&r0,r,m);
+    uint32_divmod_const(&junk,&r1,r1,m); /* only needed for invalid inputs */
+    R[2*j] = r0;
+    R[2*j+1] = r1;
   }
 }
+
+static inline void decode_top(uint16 *R,const unsigned char *S,uint32 m)
+{
+  uint32 r,r1;
+
+  if (m == 1) {
+    R[0] = 0;
+    return;
+  }
+  r = S[0];
+  if (m > 256) r += ((uint32)S[1])<<8;
+  uint32_divmod_const(&r1,&r,r,m);
+  R[0] = r;
+}
+
+#define DECODE(X,R,S) \
+  do { \
+    decode_top(R,S+X##O10,X##T10); \
+    decode_level(R,S+X##O9,X##N9,X##M9,X##T9); \
+    decode_level(R,S+X##O8,X##N8,X##M8,X##T8); \
+    decode_level(R,S+X##O7,X##N7,X##M7,X##T7); \
+    decode_level(R,S+X##O6,X##N6,X##M6,X##T6); \
+    decode_level(R,S+X##O5,X##N5,X##M5,X##T5); \
+    decode_level(R,S+X##O4,X##N4,X##M4,X##T4); \
+    decode_level(R,S+X##O3,X##N3,X##M3,X##T3); \
+    decode_level(R,S+X##O2,X##N2,X##M2,X##T2); \
+    decode_level(R,S+X##O1,X##N1,X##M1,X##T1); \
+    decode_level(R,S+X##O0,X##N0,X##M0,X##T0); \
+  } while (0)
+
+void Decode_Rounded(uint16 *R,const unsigned char *S)
+{
+  DECODE(Rounded_,R,S);
+}
+
+#ifndef LPR
+
+void Decode_Rq(uint16 *R,const unsigned char *S)
+{
+  DECODE(Rq_,R,S);
+}
+
+#endif
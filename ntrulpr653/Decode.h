@@ -1,9 +1,16 @@
 #ifndef Decode_H
 #define Decode_H
 
-/* Decode(R,s,M,len) */
-/* assumes 0 < M[i] < 16384 */
-/* produces 0 <= R[i] < M[i] */
-extern void Decode(uint16 *,const unsigned char *,const uint16 *,long long);
+#include "uint16.h"
+
+/* Decode_Rounded(R,s) */
+/* produces 0 <= R[i] < (q+2)/3, 0 <= i < p */
+extern void Decode_Rounded(uint16 *,const unsigned char *);
+
+#ifndef LPR
+/* Decode_Rq(R,s) */
+/* produces 0 <= R[i] < q, 0 <= i < p */
+extern void Decode_Rq(uint16 *,const unsigned char *);
+#endif
 
 #endif
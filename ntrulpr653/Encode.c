@@ -1,39 +1,114 @@
+#include "params.h"
 #include "uint16.h"
 #include "uint32.h"
+#include "Codec.h"
 #include "Encode.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
-/* 0 <= R[i] < M[i] < 16384 */
-void Encode(unsigned char *out,const uint16 *R,const uint16 *M,long long len)
+/*
+Non-recursive Encode for p entries of one modulus (see Codec.h).
+Each level merges pairs in place into R2. The moduli are enum
+constants, so every level is specialized at compile time. On AVX2,
+eight full pairs are merged at once.
+*/
+
+#ifdef __AVX2__
+
+/* low 16 bits of each 32-bit lane, packed */
+static inline __m128i pack32to16(__m256i x)
 {
-  if (len == 1) {
-    uint16 r = R[0];
-    uint16 m = M[0];
-    while (m > 1) {
-      *out++ = r;
-      r >>= 8;
-      m = (m+255)>>8;
+  x = _mm256_packus_epi32(x,x);
+  x = _mm256_permute4x64_epi64(x,0x08);
+  return _mm256_castsi256_si128(x);
+}
+
+#endif
+
+/* merge level n (moduli m, last t) of R into R2, appending bytes to *out */
+static inline __attribute__((always_inline))
+void encode_level(unsigned char **out,uint16 *R2,const uint16 *R,int n,uint32 m,uint32 t)
+{
+  const int b = CODEC_BYTES(m*m);
+  const int pairs = (n-1)/2;
+  unsigned char *s = *out;
+  int j = 0;
+  uint32 r,mm;
+
+#ifdef __AVX2__
+  const __m256i mult = _mm256_set1_epi32((m<<16)|1);
+  const __m256i mask = _mm256_set1_epi32(b == 1 ? 0xff : 0xffff);
+  for (;j < (pairs&~7);j += 8) {
+    __m256i x = _mm256_loadu_si256((const __m256i *) (R+2*j));
+    x = _mm256_madd_epi16(x,mult); /* R[2j]+R[2j+1]*m */
+    if (b == 1) {
+      __m128i y = pack32to16(_mm256_and_si256(x,mask));
+      _mm_storel_epi64((__m128i *) s,_mm_packus_epi16(y,y));
     }
+    if (b == 2)
+      _mm_storeu_si128((__m128i *) s,pack32to16(_mm256_and_si256(x,mask)));
+    s += 8*b;
+    _mm_storeu_si128((__m128i *) (R2+j),pack32to16(_mm256_srli_epi32(x,8*b)));
   }
-  if (len > 1) {
-    uint16 R2[(len+1)/2];
-    uint16 M2[(len+1)/2];
-    long long i;
-    for (i = 0;i < len-1;i += 2) {
-      uint32 m0 = M[i];
-      uint32 r = R[i]+R[i+1]*m0;
-      uint32 m = M[i+1]*m0;
-      while (m >= 16384) {
-        *out++ = r;
-        r >>= 8;
-        m = (m+255)>>8;
-      }
-      R2[i/2] = r;
-      M2[i/2] = m;
-    }
-    if (i < len) {
-      R2[i/2] = R[i];
-      M2[i/2] = M[i];
+#endif
+  for (;j < pairs;++j) {
+    r = R[2*j]+R[2*j+1]*m;
+    if (b >= 1) { *s++ = r; r >>= 8; }
+    if (b >= 2) { *s++ = r; r >>= 8; }
+    R2[j] = r;
+  }
+
+  if (n&1)
+    R2[j] = R[2*j];
+  else {
+    r = R[2*j]+R[2*j+1]*m;
+    mm = t*m;
+    while (mm >= 16384) {
+      *s++ = r;
+      r >>= 8;
+      mm = (mm+255)>>8;
     }
-    Encode(out,R2,M2,(len+1)/2);
+    R2[j] = r;
   }
+  *out = s;
 }
+
+static inline void encode_top(unsigned char *s,uint16 r,uint16 m)
+{
+  while (m > 1) {
+    *s++ = r;
+    r >>= 8;
+    m = (m+255)>>8;
+  }
+}
+
+#define ENCODE(X,s,R) \
+  do { \
+    uint16 R2[(p+1)/2]; \
+    encode_level(&s,R2,R,X##N0,X##M0,X##T0); \
+    encode_level(&s,R2,R2,X##N1,X##M1,X##T1); \
+    encode_level(&s,R2,R2,X##N2,X##M2,X##T2); \
+    encode_level(&s,R2,R2,X##N3,X##M3,X##T3); \
+    encode_level(&s,R2,R2,X##N4,X##M4,X##T4); \
+    encode_level(&s,R2,R2,X##N5,X##M5,X##T5); \
+    encode_level(&s,R2,R2,X##N6,X##M6,X##T6); \
+    encode_level(&s,R2,R2,X##N7,X##M7,X##T7); \
+    encode_level(&s,R2,R2,X##N8,X##M8,X##T8); \
+    encode_level(&s,R2,R2,X##N9,X##M9,X##T9); \
+    encode_top(s,R2[0],X##T10); \
+  } while (0)
+
+void Encode_Rounded(unsigned char *s,const uint16 *R)
+{
+  ENCODE(Rounded_,s,R);
+}
+
+#ifndef LPR
+
+void Encode_Rq(unsigned char *s,const uint16 *R)
+{
+  ENCODE(Rq_,s,R);
+}
+
+#endif
@@ -1,8 +1,16 @@
 #ifndef Encode_H
 #define Encode_H
 
-/* Encode(s,R,M,len) */
-/* assumes 0 <= R[i] < M[i] < 16384 */
-extern void Encode(unsigned char *,const uint16 *,const uint16 *,long long);
+#include "uint16.h"
+
+/* Encode_Rounded(s,R) */
+/* assumes 0 <= R[i] < (q+2)/3, 0 <= i < p */
+extern void Encode_Rounded(unsigned char *,const uint16 *);
+
+#ifndef LPR
+/* Encode_Rq(s,R) */
+/* assumes 0 <= R[i] < q, 0 <= i < p */
+extern void Encode_Rq(unsigned char *,const uint16 *);
+#endif
 
 #endif
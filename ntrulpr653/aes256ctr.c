@@ -1,31 +1,8 @@
-#include <string.h>
-#include <openssl/evp.h>
+#include "aes.h"
 #include "aes256ctr.h"
 
-static int aes256ctr_xor(
-  unsigned char *out,
-  const unsigned char *in,
-  unsigned long long inlen,
-  const unsigned char *n,
-  const unsigned char *k
-)
-{
-  EVP_CIPHER_CTX *x;
-  int ok;
-  int outl = 0;
-
-  x = EVP_CIPHER_CTX_new();
-  if (!x) return -111;
-
-  ok = EVP_EncryptInit_ex(x,EVP_aes_256_ctr(),0,k,n);
-  if (ok == 1) ok = EVP_CIPHER_CTX_set_padding(x, 0);
-  if (ok == 1) ok = EVP_EncryptUpdate(x, out, &outl, in, inlen);
-  if (ok == 1) ok = EVP_EncryptFinal_ex(x, out, &outl);
-
-  EVP_CIPHER_CTX_free(x);
-  return ok == 1 ? 0 : -111;
-}
-
+/* out = AES-256-CTR keystream under key k starting at counter block n */
+/* (big-endian 128-bit counter, as OpenSSL's EVP_aes_256_ctr)           */
 int aes256ctr(
   unsigned char *out,
   unsigned long long outlen,
@@ -33,7 +10,10 @@ int aes256ctr(
   const unsigned char *k
 )
 {
-  unsigned char temp[outlen];
-  memset(temp, 0, outlen);
-  return aes256ctr_xor(out, temp, outlen, n, k);
+  aes_ctx ctx;
+
+  aes256_keyexp(&ctx,k);
+  aes_ctr(out,outlen,n,&ctx);
+  aes_ctx_clear(&ctx); /* k may derive from secret input (HashShort) */
+  return 0;
 }
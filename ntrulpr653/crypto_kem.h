@@ -1,11 +1,47 @@
 #ifndef crypto_kem_H
 #define crypto_kem_H
 
+#ifdef KEM_VARIANT
+
+/* namespaced build, e.g. -DKEM_VARIANT=sntrup761 (see Makefile) */
+
+#include "crypto_kem_variants.h"
+
+#define crypto_kem_name3(a,b,c) a##b##c
+#define crypto_kem_name(v,f) crypto_kem_name3(crypto_kem_,v,f)
+
+#define crypto_kem_keypair crypto_kem_name(KEM_VARIANT,_keypair)
+#define crypto_kem_enc crypto_kem_name(KEM_VARIANT,_enc)
+#define crypto_kem_dec crypto_kem_name(KEM_VARIANT,_dec)
+#define crypto_kem_scratch_bytes crypto_kem_name(KEM_VARIANT,_scratch_bytes)
+#define crypto_kem_keypair_with_scratch crypto_kem_name(KEM_VARIANT,_keypair_with_scratch)
+#define crypto_kem_enc_with_scratch crypto_kem_name(KEM_VARIANT,_enc_with_scratch)
+#define crypto_kem_dec_with_scratch crypto_kem_name(KEM_VARIANT,_dec_with_scratch)
+#define crypto_kem_keypair_batch crypto_kem_name(KEM_VARIANT,_keypair_batch)
+#define crypto_kem_enc_batch crypto_kem_name(KEM_VARIANT,_enc_batch)
+#define crypto_kem_dec_batch crypto_kem_name(KEM_VARIANT,_dec_batch)
+#define crypto_kem_PUBLICKEYBYTES crypto_kem_name(KEM_VARIANT,_PUBLICKEYBYTES)
+#define crypto_kem_SECRETKEYBYTES crypto_kem_name(KEM_VARIANT,_SECRETKEYBYTES)
+#define crypto_kem_BYTES crypto_kem_name(KEM_VARIANT,_BYTES)
+#define crypto_kem_CIPHERTEXTBYTES crypto_kem_name(KEM_VARIANT,_CIPHERTEXTBYTES)
+#define crypto_kem_str2(v) #v
+#define crypto_kem_str(v) crypto_kem_str2(v)
+#define crypto_kem_PRIMITIVE crypto_kem_str(KEM_VARIANT)
+
+#else
+
 #include "crypto_kem_ntrulpr653.h"
 
 #define crypto_kem_keypair crypto_kem_ntrulpr653_keypair
 #define crypto_kem_enc crypto_kem_ntrulpr653_enc
 #define crypto_kem_dec crypto_kem_ntrulpr653_dec
+#define crypto_kem_scratch_bytes crypto_kem_ntrulpr653_scratch_bytes
+#define crypto_kem_keypair_with_scratch crypto_kem_ntrulpr653_keypair_with_scratch
+#define crypto_kem_enc_with_scratch crypto_kem_ntrulpr653_enc_with_scratch
+#define crypto_kem_dec_with_scratch crypto_kem_ntrulpr653_dec_with_scratch
+#define crypto_kem_keypair_batch crypto_kem_ntrulpr653_keypair_batch
+#define crypto_kem_enc_batch crypto_kem_ntrulpr653_enc_batch
+#define crypto_kem_dec_batch crypto_kem_ntrulpr653_dec_batch
 #define crypto_kem_PUBLICKEYBYTES crypto_kem_ntrulpr653_PUBLICKEYBYTES
 #define crypto_kem_SECRETKEYBYTES crypto_kem_ntrulpr653_SECRETKEYBYTES
 #define crypto_kem_BYTES crypto_kem_ntrulpr653_BYTES
@@ -13,3 +49,27 @@
 #define crypto_kem_PRIMITIVE "ntrulpr653"
 
 #endif
+
+/*
+The same operations with their large temporaries in a caller-owned
+arena of crypto_kem_scratch_bytes() bytes. Namespaced builds keep
+these local; they are reached through the qsiot_kem descriptor.
+*/
+
+#include <stddef.h>
+
+extern size_t crypto_kem_scratch_bytes(void);
+extern int crypto_kem_keypair_with_scratch(unsigned char *,unsigned char *,void *);
+extern int crypto_kem_enc_with_scratch(unsigned char *,unsigned char *,const unsigned char *,void *);
+extern int crypto_kem_dec_with_scratch(unsigned char *,const unsigned char *,const unsigned char *,void *);
+
+/*
+n instances stored back to back, with the hashes of four instances
+computed together (sha512x4); local in namespaced builds as well.
+*/
+
+extern int crypto_kem_keypair_batch(unsigned char *,unsigned char *,size_t);
+extern int crypto_kem_enc_batch(unsigned char *,unsigned char *,const unsigned char *,size_t);
+extern int crypto_kem_dec_batch(unsigned char *,const unsigned char *,const unsigned char *,size_t);
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef crypto_kem_variants_H
+#define crypto_kem_variants_H
+
+/*
+Namespaced builds of every parameter set of this tree
+(make variants, see Makefile): libsntrup653.a ... libntrulpr857.a.
+Each library exports only the three functions declared here.
+*/
+
+#define crypto_kem_sntrup653_PUBLICKEYBYTES 994
+#define crypto_kem_sntrup653_SECRETKEYBYTES 1518
+#define crypto_kem_sntrup653_CIPHERTEXTBYTES 897
+#define crypto_kem_sntrup653_BYTES 32
+
+#define crypto_kem_sntrup761_PUBLICKEYBYTES 1158
+#define crypto_kem_sntrup761_SECRETKEYBYTES 1763
+#define crypto_kem_sntrup761_CIPHERTEXTBYTES 1039
+#define crypto_kem_sntrup761_BYTES 32
+
+#define crypto_kem_sntrup857_PUBLICKEYBYTES 1322
+#define crypto_kem_sntrup857_SECRETKEYBYTES 1999
+#define crypto_kem_sntrup857_CIPHERTEXTBYTES 1184
+#define crypto_kem_sntrup857_BYTES 32
+
+#define crypto_kem_ntrulpr653_PUBLICKEYBYTES 897
+#define crypto_kem_ntrulpr653_SECRETKEYBYTES 1125
+#define crypto_kem_ntrulpr653_CIPHERTEXTBYTES 1025
+#define crypto_kem_ntrulpr653_BYTES 32
+
+#define crypto_kem_ntrulpr761_PUBLICKEYBYTES 1039
+#define crypto_kem_ntrulpr761_SECRETKEYBYTES 1294
+#define crypto_kem_ntrulpr761_CIPHERTEXTBYTES 1167
+#define crypto_kem_ntrulpr761_BYTES 32
+
+#define crypto_kem_ntrulpr857_PUBLICKEYBYTES 1184
+#define crypto_kem_ntrulpr857_SECRETKEYBYTES 1463
+#define crypto_kem_ntrulpr857_CIPHERTEXTBYTES 1312
+#define crypto_kem_ntrulpr857_BYTES 32
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#define crypto_kem_variant_declare(v) \
+  extern int crypto_kem_##v##_keypair(unsigned char *,unsigned char *); \
+  extern int crypto_kem_##v##_enc(unsigned char *,unsigned char *,const unsigned char *); \
+  extern int crypto_kem_##v##_dec(unsigned char *,const unsigned char *,const unsigned char *);
+crypto_kem_variant_declare(sntrup653)
+crypto_kem_variant_declare(sntrup761)
+crypto_kem_variant_declare(sntrup857)
+crypto_kem_variant_declare(ntrulpr653)
+crypto_kem_variant_declare(ntrulpr761)
+crypto_kem_variant_declare(ntrulpr857)
+#undef crypto_kem_variant_declare
+#ifdef __cplusplus
+}
+#endif
+
+#endif
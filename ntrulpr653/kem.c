@@ -6,6 +6,7 @@
 
 #include "randombytes.h"
 #include "sha512.h"
+#include "sha512x4.h"
 #ifdef LPR
 #include "aes256ctr.h"
 #endif
@@ -15,8 +16,28 @@
 #include "int32.h"
 #include "uint16.h"
 #include "uint32.h"
+#include "crypto_sort.h"
 #include "Encode.h"
 #include "Decode.h"
+#include "mult.h"
+#include "reduce.h"
+#include "recip.h"
+
+/* ----- workspace */
+
+/*
+The large temporaries of one operation, kept in a caller-owned arena
+by crypto_kem_*_with_scratch and on the stack by crypto_kem_*.
+*/
+
+typedef struct {
+  int32 mult[mult_small_SCRATCH]; /* mult_small_scratch */
+  int32 fg[p]; /* Rq_mult_small, R3_mult */
+  uint32 L[p]; /* Short_random, Small_random, Generator, HashShort */
+#ifndef LPR
+  int32 recip[Rq_recip3_SCRATCH]; /* Rq_recip3_scratch */
+#endif
+} Scratch;
 
 /* ----- masks */
 
@@ -32,7 +53,7 @@ static int int16_nonzero_mask(int16 x)
   return -v; /* 0, else -1 */
 }
 
-#endif
+#else
 
 /* return -1 if x<0; otherwise return 0 */
 static int int16_negative_mask(int16 x)
@@ -44,6 +65,8 @@ static int int16_negative_mask(int16 x)
   /* x>>15 compiles to CPU's arithmetic right shift */
 }
 
+#endif
+
 /* ----- arithmetic mod 3 */
 
 typedef int8 small;
@@ -51,12 +74,6 @@ typedef int8 small;
 /* F3 is always represented as -1,0,1 */
 /* so ZZ_fromF3 is a no-op */
 
-/* x must not be close to top int16 */
-static small F3_freeze(int16 x)
-{
-  return int32_mod_uint14(x+1,3)-1;
-}
-
 /* ----- arithmetic mod q */
 
 #define q12 ((q-1)/2)
@@ -64,26 +81,14 @@ typedef int16 Fq;
 /* always represented as -q12...q12 */
 /* so ZZ_fromFq is a no-op */
 
+#ifdef LPR
+
 /* x must not be close to top int32 */
 static Fq Fq_freeze(int32 x)
 {
-  return int32_mod_uint14(x+q12,q)-q12;
+  return int32_mod_const(x+q12,q)-q12;
 }
 
-#ifndef LPR
-
-static Fq Fq_recip(Fq a1)
-{ 
-  int i = 1;
-  Fq ai = a1;
-
-  while (i < q-2) {
-    ai = Fq_freeze(a1*(int32)ai);
-    i += 1;
-  }
-  return ai;
-} 
-
 #endif
 
 /* ----- Top and Right */
@@ -119,108 +124,31 @@ static int Weightw_mask(small *r)
 /* R3_fromR(R_fromRq(r)) */
 static void R3_fromRq(small *out,const Fq *r)
 {
-  int i;
-  for (i = 0;i < p;++i) out[i] = F3_freeze(r[i]);
+  F3_freeze_int16_list(out,r,p);
 }
 
 /* h = f*g in the ring R3 */
-static void R3_mult(small *h,const small *f,const small *g)
+static void R3_mult(small *h,const small *f,const small *g,Scratch *ws)
 {
-  small fg[p+p-1];
-  small result;
-  int i,j;
-
-  for (i = 0;i < p;++i) {
-    result = 0;
-    for (j = 0;j <= i;++j) result = F3_freeze(result+f[j]*g[i-j]);
-    fg[i] = result;
-  }
-  for (i = p;i < p+p-1;++i) {
-    result = 0;
-    for (j = i-p+1;j < p;++j) result = F3_freeze(result+f[j]*g[i-j]);
-    fg[i] = result;
-  }
-
-  for (i = p+p-2;i >= p;--i) {
-    fg[i-p] = F3_freeze(fg[i-p]+fg[i]);
-    fg[i-p+1] = F3_freeze(fg[i-p+1]+fg[i]);
-  }
+  int16 f16[p],fg16[p];
+  int32 *fg = ws->fg;
+  int i;
 
-  for (i = 0;i < p;++i) h[i] = fg[i];
+  for (i = 0;i < p;++i) f16[i] = f[i];
+  mult_small_scratch(fg,f16,g,ws->mult);
+  for (i = 0;i < p;++i) fg16[i] = fg[i]; /* |fg[i]| <= 3p */
+  F3_freeze_int16_list(h,fg16,p);
 }
 
-/* returns 0 if recip succeeded; else -1 */
-static int R3_recip(small *out,const small *in)
-{ 
-  small f[p+1],g[p+1],v[p+1],r[p+1];
-  int i,loop,delta;
-  int sign,swap,t;
-  
-  for (i = 0;i < p+1;++i) v[i] = 0;
-  for (i = 0;i < p+1;++i) r[i] = 0;
-  r[0] = 1;
-  for (i = 0;i < p;++i) f[i] = 0;
-  f[0] = 1; f[p-1] = f[p] = -1;
-  for (i = 0;i < p;++i) g[p-1-i] = in[i];
-  g[p] = 0;
-    
-  delta = 1; 
-
-  for (loop = 0;loop < 2*p-1;++loop) {
-    for (i = p;i > 0;--i) v[i] = v[i-1];
-    v[0] = 0;
-    
-    sign = -g[0]*f[0];
-    swap = int16_negative_mask(-delta) & int16_nonzero_mask(g[0]);
-    delta ^= swap&(delta^-delta);
-    delta += 1;
-    
-    for (i = 0;i < p+1;++i) {
-      t = swap&(f[i]^g[i]); f[i] ^= t; g[i] ^= t;
-      t = swap&(v[i]^r[i]); v[i] ^= t; r[i] ^= t;
-    }
-  
-    for (i = 0;i < p+1;++i) g[i] = F3_freeze(g[i]+sign*f[i]);
-    for (i = 0;i < p+1;++i) r[i] = F3_freeze(r[i]+sign*v[i]);
-
-    for (i = 0;i < p;++i) g[i] = g[i+1];
-    g[p] = 0;
-  }
-  
-  sign = f[0];
-  for (i = 0;i < p;++i) out[i] = sign*v[p-1-i];
-  
-  return int16_nonzero_mask(delta);
-} 
-
 #endif
 
 /* ----- polynomials mod q */
 
 /* h = f*g in the ring Rq */
-static void Rq_mult_small(Fq *h,const Fq *f,const small *g)
+static void Rq_mult_small(Fq *h,const Fq *f,const small *g,Scratch *ws)
 {
-  Fq fg[p+p-1];
-  Fq result;
-  int i,j;
-
-  for (i = 0;i < p;++i) {
-    result = 0;
-    for (j = 0;j <= i;++j) result = Fq_freeze(result+f[j]*(int32)g[i-j]);
-    fg[i] = result;
-  }
-  for (i = p;i < p+p-1;++i) {
-    result = 0;
-    for (j = i-p+1;j < p;++j) result = Fq_freeze(result+f[j]*(int32)g[i-j]);
-    fg[i] = result;
-  }
-
-  for (i = p+p-2;i >= p;--i) {
-    fg[i-p] = Fq_freeze(fg[i-p]+fg[i]);
-    fg[i-p+1] = Fq_freeze(fg[i-p+1]+fg[i]);
-  }
-
-  for (i = 0;i < p;++i) h[i] = fg[i];
+  mult_small_scratch(ws->fg,f,g,ws->mult);
+  Fq_freeze_int32_list(h,ws->fg,p);
 }
 
 #ifndef LPR
@@ -230,55 +158,8 @@ static void Rq_mult3(Fq *h,const Fq *f)
 {
   int i;
   
-  for (i = 0;i < p;++i) h[i] = Fq_freeze(3*f[i]);
-}
-
-/* out = 1/(3*in) in Rq */
-/* returns 0 if recip succeeded; else -1 */
-static int Rq_recip3(Fq *out,const small *in)
-{ 
-  Fq f[p+1],g[p+1],v[p+1],r[p+1];
-  int i,loop,delta;
-  int swap,t;
-  int32 f0,g0;
-  Fq scale;
-
-  for (i = 0;i < p+1;++i) v[i] = 0;
-  for (i = 0;i < p+1;++i) r[i] = 0;
-  r[0] = Fq_recip(3);
-  for (i = 0;i < p;++i) f[i] = 0;
-  f[0] = 1; f[p-1] = f[p] = -1;
-  for (i = 0;i < p;++i) g[p-1-i] = in[i];
-  g[p] = 0;
-
-  delta = 1;
-
-  for (loop = 0;loop < 2*p-1;++loop) {
-    for (i = p;i > 0;--i) v[i] = v[i-1];
-    v[0] = 0;
-
-    swap = int16_negative_mask(-delta) & int16_nonzero_mask(g[0]);
-    delta ^= swap&(delta^-delta);
-    delta += 1;
-
-    for (i = 0;i < p+1;++i) {
-      t = swap&(f[i]^g[i]); f[i] ^= t; g[i] ^= t;
-      t = swap&(v[i]^r[i]); v[i] ^= t; r[i] ^= t;
-    }
-
-    f0 = f[0];
-    g0 = g[0];
-    for (i = 0;i < p+1;++i) g[i] = Fq_freeze(f0*g[i]-g0*f[i]);
-    for (i = 0;i < p+1;++i) r[i] = Fq_freeze(f0*r[i]-g0*v[i]);
-
-    for (i = 0;i < p;++i) g[i] = g[i+1];
-    g[p] = 0;
-  }
-
-  scale = Fq_recip(f[0]);
-  for (i = 0;i < p;++i) out[i] = Fq_freeze(scale*(int32)v[p-1-i]);
-
-  return int16_nonzero_mask(delta);
+  for (i = 0;i < p;++i) h[i] = 3*f[i];
+  Fq_freeze_int16_list(h,h,p);
 }
 
 #endif
@@ -287,20 +168,19 @@ static int Rq_recip3(Fq *out,const small *in)
 
 static void Round(Fq *out,const Fq *a)
 {
-  int i;
-  for (i = 0;i < p;++i) out[i] = a[i]-F3_freeze(a[i]);
+  Fq_round3_list(out,a,p);
 }
 
 /* ----- sorting to generate short polynomial */
 
-static void Short_fromlist(small *out,const uint32 *in)
+/* sorts L in place */
+static void Short_fromlist(small *out,uint32 *L)
 {
-  uint32 L[p];
   int i;
 
-  for (i = 0;i < w;++i) L[i] = in[i]&(uint32)-2;
-  for (i = w;i < p;++i) L[i] = (in[i]&(uint32)-3)|1;
-  uint32_sort(L,p);
+  for (i = 0;i < w;++i) L[i] = L[i]&(uint32)-2;
+  for (i = w;i < p;++i) L[i] = (L[i]&(uint32)-3)|1;
+  crypto_sort_uint32(L,p);
   for (i = 0;i < p;++i) out[i] = (L[i]&3)-1;
 }
 
@@ -311,47 +191,70 @@ static void Short_fromlist(small *out,const uint32 *in)
 /* e.g., b = 0 means out = Hash0(in) */
 static void Hash(unsigned char *out,int b,const unsigned char *in,int inlen)
 {
-  unsigned char x[inlen+1];
+  sha512_incctx ctx;
+  unsigned char x = b;
   unsigned char h[64];
   int i;
 
-  x[0] = b;
-  for (i = 0;i < inlen;++i) x[i+1] = in[i];
-  sha512(h,x,inlen+1);
+  sha512_inc_init(&ctx);
+  sha512_inc_absorb(&ctx,&x,1);
+  sha512_inc_absorb(&ctx,in,inlen);
+  sha512_inc_finalize(h,&ctx);
+  for (i = 0;i < 32;++i) out[i] = h[i];
+}
+
+/* out = Hash_b(in0||in1) without concatenating the pieces */
+static void Hash2(unsigned char *out,int b,const unsigned char *in0,int in0len,const unsigned char *in1,int in1len)
+{
+  sha512_incctx ctx;
+  unsigned char x = b;
+  unsigned char h[64];
+  int i;
+
+  sha512_inc_init(&ctx);
+  sha512_inc_absorb(&ctx,&x,1);
+  sha512_inc_absorb(&ctx,in0,in0len);
+  sha512_inc_absorb(&ctx,in1,in1len);
+  sha512_inc_finalize(h,&ctx);
   for (i = 0;i < 32;++i) out[i] = h[i];
 }
 
 /* ----- higher-level randomness */
 
-static uint32 urandom32(void)
+/* L[0...n-1] = random uint32s, drawn with a single randombytes call */
+static void urandom32_list(uint32 *L,int n)
 {
-  unsigned char c[4];
+  unsigned char *c = (unsigned char *) L;
   uint32 out[4];
+  int i;
 
-  randombytes(c,4);
-  out[0] = (uint32)c[0];
-  out[1] = ((uint32)c[1])<<8;
-  out[2] = ((uint32)c[2])<<16;
-  out[3] = ((uint32)c[3])<<24;
-  return out[0]+out[1]+out[2]+out[3];
+  randombytes(c,4*n);
+  for (i = 0;i < n;++i) {
+    out[0] = (uint32)c[4*i];
+    out[1] = ((uint32)c[4*i+1])<<8;
+    out[2] = ((uint32)c[4*i+2])<<16;
+    out[3] = ((uint32)c[4*i+3])<<24;
+    L[i] = out[0]+out[1]+out[2]+out[3];
+  }
 }
 
-static void Short_random(small *out)
+static void Short_random(small *out,Scratch *ws)
 {
-  uint32 L[p];
-  int i;
+  uint32 *L = ws->L;
 
-  for (i = 0;i < p;++i) L[i] = urandom32();
+  urandom32_list(L,p);
   Short_fromlist(out,L);
 }
 
 #ifndef LPR
 
-static void Small_random(small *out)
+static void Small_random(small *out,Scratch *ws)
 {
+  uint32 *L = ws->L;
   int i;
 
-  for (i = 0;i < p;++i) out[i] = (((urandom32()&0x3fffffff)*3)>>30)-1;
+  urandom32_list(L,p);
+  for (i = 0;i < p;++i) out[i] = (((L[i]&0x3fffffff)*3)>>30)-1;
 }
 
 #endif
@@ -361,31 +264,31 @@ static void Small_random(small *out)
 #ifndef LPR
 
 /* h,(f,ginv) = KeyGen() */
-static void KeyGen(Fq *h,small *f,small *ginv)
+static void KeyGen(Fq *h,small *f,small *ginv,Scratch *ws)
 {
   small g[p];
   Fq finv[p];
   
   for (;;) {
-    Small_random(g);
+    Small_random(g,ws);
     if (R3_recip(ginv,g) == 0) break;
   }
-  Short_random(f);
-  Rq_recip3(finv,f); /* always works */
-  Rq_mult_small(h,finv,g);
+  Short_random(f,ws);
+  Rq_recip3_scratch(finv,f,ws->recip); /* always works */
+  Rq_mult_small(h,finv,g,ws);
 }
 
 /* c = Encrypt(r,h) */
-static void Encrypt(Fq *c,const small *r,const Fq *h)
+static void Encrypt(Fq *c,const small *r,const Fq *h,Scratch *ws)
 {
   Fq hr[p];
 
-  Rq_mult_small(hr,h,r);
+  Rq_mult_small(hr,h,r,ws);
   Round(c,hr);
 }
 
 /* r = Decrypt(c,(f,ginv)) */
-static void Decrypt(small *r,const Fq *c,const small *f,const small *ginv)
+static void Decrypt(small *r,const Fq *c,const small *f,const small *ginv,Scratch *ws)
 {
   Fq cf[p];
   Fq cf3[p];
@@ -394,10 +297,10 @@ static void Decrypt(small *r,const Fq *c,const small *f,const small *ginv)
   int mask;
   int i;
 
-  Rq_mult_small(cf,c,f);
+  Rq_mult_small(cf,c,f,ws);
   Rq_mult3(cf3,cf);
   R3_fromRq(e,cf3);
-  R3_mult(ev,e,ginv);
+  R3_mult(ev,e,ginv,ws);
 
   mask = Weightw_mask(ev); /* 0 if weight w, else -1 */
   for (i = 0;i < w;++i) r[i] = ((ev[i]^1)&~mask)^1;
@@ -411,37 +314,40 @@ static void Decrypt(small *r,const Fq *c,const small *f,const small *ginv)
 #ifdef LPR
 
 /* (G,A),a = KeyGen(G); leaves G unchanged */
-static void KeyGen(Fq *A,small *a,const Fq *G)
+static void KeyGen(Fq *A,small *a,const Fq *G,Scratch *ws)
 {
   Fq aG[p];
 
-  Short_random(a);
-  Rq_mult_small(aG,G,a);
+  Short_random(a,ws);
+  Rq_mult_small(aG,G,a,ws);
   Round(A,aG);
 }
 
 /* B,T = Encrypt(r,(G,A),b) */
-static void Encrypt(Fq *B,int8 *T,const int8 *r,const Fq *G,const Fq *A,const small *b)
+static void Encrypt(Fq *B,int8 *T,const int8 *r,const Fq *G,const Fq *A,const small *b,Scratch *ws)
 {
   Fq bG[p];
   Fq bA[p];
   int i;
 
-  Rq_mult_small(bG,G,b);
+  Rq_mult_small(bG,G,b,ws);
   Round(B,bG);
-  Rq_mult_small(bA,A,b);
-  for (i = 0;i < I;++i) T[i] = Top(Fq_freeze(bA[i]+r[i]*q12));
+  Rq_mult_small(bA,A,b,ws);
+  for (i = 0;i < I;++i) bA[i] += r[i]*q12;
+  Fq_freeze_int16_list(bA,bA,I);
+  for (i = 0;i < I;++i) T[i] = Top(bA[i]);
 }
 
 /* r = Decrypt((B,T),a) */
-static void Decrypt(int8 *r,const Fq *B,const int8 *T,const small *a)
+static void Decrypt(int8 *r,const Fq *B,const int8 *T,const small *a,Scratch *ws)
 {
   Fq aB[p];
   int i;
 
-  Rq_mult_small(aB,B,a);
-  for (i = 0;i < I;++i)
-    r[i] = -int16_negative_mask(Fq_freeze(Right(T[i])-aB[i]+4*w+1));
+  Rq_mult_small(aB,B,a,ws);
+  for (i = 0;i < I;++i) aB[i] = Right(T[i])-aB[i]+4*w+1;
+  Fq_freeze_int16_list(aB,aB,I);
+  for (i = 0;i < I;++i) r[i] = -int16_negative_mask(aB[i]);
 }
     
 #endif
@@ -493,21 +399,20 @@ static void Seeds_random(unsigned char *s)
 #ifdef LPR
 
 /* G = Generator(k) */
-static void Generator(Fq *G,const unsigned char *k)
+static void Generator(Fq *G,const unsigned char *k,Scratch *ws)
 {
-  uint32 L[p];
-  int i;
+  uint32 *L = ws->L;
 
   Expand(L,k);
-  for (i = 0;i < p;++i) G[i] = uint32_mod_uint14(L[i],q)-q12;
+  Fq_fromuint32_list(G,L,p);
 }
 
 /* out = HashShort(r) */
-static void HashShort(small *out,const Inputs r)
+static void HashShort(small *out,const Inputs r,Scratch *ws)
 {
   unsigned char s[Inputs_bytes];
   unsigned char h[Hash_bytes];
-  uint32 L[p];
+  uint32 *L = ws->L;
 
   Inputs_encode(s,r);
   Hash(h,5,s,sizeof s);
@@ -522,24 +427,24 @@ static void HashShort(small *out,const Inputs r)
 #ifdef LPR
 
 /* (S,A),a = XKeyGen() */
-static void XKeyGen(unsigned char *S,Fq *A,small *a)
+static void XKeyGen(unsigned char *S,Fq *A,small *a,Scratch *ws)
 {
   Fq G[p];
 
   Seeds_random(S);
-  Generator(G,S);
-  KeyGen(A,a,G);
+  Generator(G,S,ws);
+  KeyGen(A,a,G,ws);
 }
 
 /* B,T = XEncrypt(r,(S,A)) */
-static void XEncrypt(Fq *B,int8 *T,const int8 *r,const unsigned char *S,const Fq *A)
+static void XEncrypt(Fq *B,int8 *T,const int8 *r,const unsigned char *S,const Fq *A,Scratch *ws)
 {
   Fq G[p];
   small b[p];
 
-  Generator(G,S);
-  HashShort(b,r);
-  Encrypt(B,T,r,G,A,b);
+  Generator(G,S,ws);
+  HashShort(b,r,ws);
+  Encrypt(B,T,r,G,A,b,ws);
 }
 
 #define XDecrypt Decrypt
@@ -590,21 +495,19 @@ static void Small_decode(small *f,const unsigned char *s)
 
 static void Rq_encode(unsigned char *s,const Fq *r)
 {
-  uint16 R[p],M[p];
+  uint16 R[p];
   int i;
   
   for (i = 0;i < p;++i) R[i] = r[i]+q12;
-  for (i = 0;i < p;++i) M[i] = q;
-  Encode(s,R,M,p);
+  Encode_Rq(s,R);
 }
 
 static void Rq_decode(Fq *r,const unsigned char *s)
 {
-  uint16 R[p],M[p];
+  uint16 R[p];
   int i;
 
-  for (i = 0;i < p;++i) M[i] = q;
-  Decode(R,s,M,p);
+  Decode_Rq(R,s);
   for (i = 0;i < p;++i) r[i] = ((Fq)R[i])-q12;
 }
   
@@ -614,21 +517,19 @@ static void Rq_decode(Fq *r,const unsigned char *s)
 
 static void Rounded_encode(unsigned char *s,const Fq *r)
 {
-  uint16 R[p],M[p];
+  uint16 R[p];
   int i;
 
   for (i = 0;i < p;++i) R[i] = ((r[i]+q12)*10923)>>15;
-  for (i = 0;i < p;++i) M[i] = (q+2)/3;
-  Encode(s,R,M,p);
+  Encode_Rounded(s,R);
 }
 
 static void Rounded_decode(Fq *r,const unsigned char *s)
 {
-  uint16 R[p],M[p];
+  uint16 R[p];
   int i;
 
-  for (i = 0;i < p;++i) M[i] = (q+2)/3;
-  Decode(R,s,M,p);
+  Decode_Rounded(R,s);
   for (i = 0;i < p;++i) r[i] = R[i]*3-q12;
 }
 
@@ -670,29 +571,29 @@ typedef small Inputs[p]; /* passed by reference */
 #define PublicKeys_bytes Rq_bytes
 
 /* pk,sk = ZKeyGen() */
-static void ZKeyGen(unsigned char *pk,unsigned char *sk)
+static void ZKeyGen(unsigned char *pk,unsigned char *sk,Scratch *ws)
 {
   Fq h[p];
   small f[p],v[p];
 
-  KeyGen(h,f,v);
+  KeyGen(h,f,v,ws);
   Rq_encode(pk,h);
   Small_encode(sk,f); sk += Small_bytes;
   Small_encode(sk,v);
 }
 
 /* C = ZEncrypt(r,pk) */
-static void ZEncrypt(unsigned char *C,const Inputs r,const unsigned char *pk)
+static void ZEncrypt(unsigned char *C,const Inputs r,const unsigned char *pk,Scratch *ws)
 {
   Fq h[p];
   Fq c[p];
   Rq_decode(h,pk);
-  Encrypt(c,r,h);
+  Encrypt(c,r,h,ws);
   Rounded_encode(C,c);
 }
 
 /* r = ZDecrypt(C,sk) */
-static void ZDecrypt(Inputs r,const unsigned char *C,const unsigned char *sk)
+static void ZDecrypt(Inputs r,const unsigned char *C,const unsigned char *sk,Scratch *ws)
 {
   small f[p],v[p];
   Fq c[p];
@@ -700,7 +601,7 @@ static void ZDecrypt(Inputs r,const unsigned char *C,const unsigned char *sk)
   Small_decode(f,sk); sk += Small_bytes;
   Small_decode(v,sk);
   Rounded_decode(c,C);
-  Decrypt(r,c,f,v);
+  Decrypt(r,c,f,v,ws);
 }
 
 #endif
@@ -713,41 +614,44 @@ static void ZDecrypt(Inputs r,const unsigned char *C,const unsigned char *sk)
 #define SecretKeys_bytes Small_bytes
 #define PublicKeys_bytes (Seeds_bytes+Rounded_bytes)
 
-static void Inputs_random(Inputs r)
+/* ws is unused; sntrup's Inputs_random is Short_random, which needs it */
+static void Inputs_random(Inputs r,Scratch *ws)
 {
   unsigned char s[Inputs_bytes];
   int i;
 
+  (void) ws;
+
   randombytes(s,sizeof s);
   for (i = 0;i < I;++i) r[i] = 1&(s[i>>3]>>(i&7));
 }
 
 /* pk,sk = ZKeyGen() */
-static void ZKeyGen(unsigned char *pk,unsigned char *sk)
+static void ZKeyGen(unsigned char *pk,unsigned char *sk,Scratch *ws)
 {
   Fq A[p];
   small a[p];
 
-  XKeyGen(pk,A,a); pk += Seeds_bytes;
+  XKeyGen(pk,A,a,ws); pk += Seeds_bytes;
   Rounded_encode(pk,A);
   Small_encode(sk,a);
 }
 
 /* c = ZEncrypt(r,pk) */
-static void ZEncrypt(unsigned char *c,const Inputs r,const unsigned char *pk)
+static void ZEncrypt(unsigned char *c,const Inputs r,const unsigned char *pk,Scratch *ws)
 {
   Fq A[p];
   Fq B[p];
   int8 T[I];
 
   Rounded_decode(A,pk+Seeds_bytes);
-  XEncrypt(B,T,r,pk,A);
+  XEncrypt(B,T,r,pk,A,ws);
   Rounded_encode(c,B); c += Rounded_bytes;
   Top_encode(c,T);
 }
 
 /* r = ZDecrypt(C,sk) */
-static void ZDecrypt(Inputs r,const unsigned char *c,const unsigned char *sk)
+static void ZDecrypt(Inputs r,const unsigned char *c,const unsigned char *sk,Scratch *ws)
 {
   small a[p];
   Fq B[p];
@@ -756,7 +660,7 @@ static void ZDecrypt(Inputs r,const unsigned char *c,const unsigned char *sk)
   Small_decode(a,sk);
   Rounded_decode(B,c);
   Top_decode(T,c+Rounded_bytes);
-  XDecrypt(r,B,T,a);
+  XDecrypt(r,B,T,a,ws);
 }
 
 #endif
@@ -769,19 +673,13 @@ static void ZDecrypt(Inputs r,const unsigned char *c,const unsigned char *sk)
 static void HashConfirm(unsigned char *h,const unsigned char *r,const unsigned char *pk,const unsigned char *cache)
 {
 #ifndef LPR
-  unsigned char x[Hash_bytes*2];
-  int i;
+  unsigned char x[Hash_bytes];
 
   Hash(x,3,r,Inputs_bytes);
-  for (i = 0;i < Hash_bytes;++i) x[Hash_bytes+i] = cache[i];
+  Hash2(h,2,x,Hash_bytes,cache,Hash_bytes);
 #else
-  unsigned char x[Inputs_bytes+Hash_bytes];
-  int i;
-
-  for (i = 0;i < Inputs_bytes;++i) x[i] = r[i];
-  for (i = 0;i < Hash_bytes;++i) x[Inputs_bytes+i] = cache[i];
+  Hash2(h,2,r,Inputs_bytes,cache,Hash_bytes);
 #endif
-  Hash(h,2,x,sizeof x);
 }
 
 /* ----- session-key hash */
@@ -790,36 +688,30 @@ static void HashConfirm(unsigned char *h,const unsigned char *r,const unsigned c
 static void HashSession(unsigned char *k,int b,const unsigned char *y,const unsigned char *z)
 {
 #ifndef LPR
-  unsigned char x[Hash_bytes+Ciphertexts_bytes+Confirm_bytes];
-  int i;
+  unsigned char x[Hash_bytes];
 
   Hash(x,3,y,Inputs_bytes);
-  for (i = 0;i < Ciphertexts_bytes+Confirm_bytes;++i) x[Hash_bytes+i] = z[i];
+  Hash2(k,b,x,Hash_bytes,z,Ciphertexts_bytes+Confirm_bytes);
 #else
-  unsigned char x[Inputs_bytes+Ciphertexts_bytes+Confirm_bytes];
-  int i;
-
-  for (i = 0;i < Inputs_bytes;++i) x[i] = y[i];
-  for (i = 0;i < Ciphertexts_bytes+Confirm_bytes;++i) x[Inputs_bytes+i] = z[i];
+  Hash2(k,b,y,Inputs_bytes,z,Ciphertexts_bytes+Confirm_bytes);
 #endif
-  Hash(k,b,x,sizeof x);
 }
 
 /* ----- Streamlined NTRU Prime and NTRU LPRime */
 
 /* pk,sk = KEM_KeyGen() */
-static void KEM_KeyGen(unsigned char *pk,unsigned char *sk)
+static void KEM_KeyGen(unsigned char *pk,unsigned char *sk,Scratch *ws)
 {
   int i;
 
-  ZKeyGen(pk,sk); sk += SecretKeys_bytes;
+  ZKeyGen(pk,sk,ws); sk += SecretKeys_bytes;
   for (i = 0;i < PublicKeys_bytes;++i) *sk++ = pk[i];
   randombytes(sk,Inputs_bytes); sk += Inputs_bytes;
   Hash(sk,4,pk,PublicKeys_bytes);
 }
 
 /* c,r_enc = Hide(r,pk,cache); cache is Hash4(pk) */
-static void Hide(unsigned char *c,unsigned char *r_enc,const Inputs r,const unsigned char *pk,const unsigned char *cache)
+static void Hide(unsigned char *c,unsigned char *r_enc,const Inputs r,const unsigned char *pk,const unsigned char *cache,Scratch *ws)
 {
   Inputs_encode(r_enc,r);
 #ifdef KAT
@@ -830,20 +722,20 @@ static void Hide(unsigned char *c,unsigned char *r_enc,const Inputs r,const unsi
     printf("\n");
   }
 #endif
-  ZEncrypt(c,r,pk); c += Ciphertexts_bytes;
+  ZEncrypt(c,r,pk,ws); c += Ciphertexts_bytes;
   HashConfirm(c,r_enc,pk,cache);
 }
 
 /* c,k = Encap(pk) */
-static void Encap(unsigned char *c,unsigned char *k,const unsigned char *pk)
+static void Encap(unsigned char *c,unsigned char *k,const unsigned char *pk,Scratch *ws)
 {
   Inputs r;
   unsigned char r_enc[Inputs_bytes];
   unsigned char cache[Hash_bytes];
 
   Hash(cache,4,pk,PublicKeys_bytes);
-  Inputs_random(r);
-  Hide(c,r_enc,r,pk,cache);
+  Inputs_random(r,ws);
+  Hide(c,r_enc,r,pk,cache,ws);
   HashSession(k,1,r_enc,c);
 }
 
@@ -858,7 +750,7 @@ static int Ciphertexts_diff_mask(const unsigned char *c,const unsigned char *c2)
 }
 
 /* k = Decap(c,sk) */
-static void Decap(unsigned char *k,const unsigned char *c,const unsigned char *sk)
+static void Decap(unsigned char *k,const unsigned char *c,const unsigned char *sk,Scratch *ws)
 {
   const unsigned char *pk = sk + SecretKeys_bytes;
   const unsigned char *rho = pk + PublicKeys_bytes;
@@ -869,31 +761,246 @@ static void Decap(unsigned char *k,const unsigned char *c,const unsigned char *s
   int mask;
   int i;
 
-  ZDecrypt(r,c,sk);
-  Hide(cnew,r_enc,r,pk,cache);
+  ZDecrypt(r,c,sk,ws);
+  Hide(cnew,r_enc,r,pk,cache,ws);
   mask = Ciphertexts_diff_mask(c,cnew);
   for (i = 0;i < Inputs_bytes;++i) r_enc[i] ^= mask&(r_enc[i]^rho[i]);
   HashSession(k,1+mask,r_enc,c);
 }
 
+/* ----- four instances at once, each hash of the four in one sha512x4 */
+
+#define KEM_SecretKeys_bytes (SecretKeys_bytes+PublicKeys_bytes+Inputs_bytes+Hash_bytes)
+#define KEM_Ciphertexts_bytes (Ciphertexts_bytes+Confirm_bytes)
+
+/* longest hash input: prefix byte and the two largest pieces */
+#define Hashx4_inbytes (1+PublicKeys_bytes+Inputs_bytes+Ciphertexts_bytes+Confirm_bytes)
+
+/* out[j] = Hash_b[j](in0[j]||in1[j]) for j = 0...3; in1 is unused if in1len is 0 */
+static void Hashx4(unsigned char *out[4],const int b[4],const unsigned char *in0[4],int in0len,const unsigned char *in1[4],int in1len)
+{
+  unsigned char x[4][Hashx4_inbytes];
+  unsigned char h[4][64];
+  int i,j;
+
+  for (j = 0;j < 4;++j) {
+    x[j][0] = b[j];
+    for (i = 0;i < in0len;++i) x[j][1+i] = in0[j][i];
+    for (i = 0;i < in1len;++i) x[j][1+in0len+i] = in1[j][i];
+  }
+  sha512x4(h[0],h[1],h[2],h[3],x[0],x[1],x[2],x[3],1+in0len+in1len);
+  for (j = 0;j < 4;++j)
+    for (i = 0;i < Hash_bytes;++i) out[j][i] = h[j][i];
+}
+
+static const int Hashx4_b1[4] = {1,1,1,1};
+static const int Hashx4_b2[4] = {2,2,2,2};
+static const int Hashx4_b4[4] = {4,4,4,4};
+
+/* h[j] = HashConfirm(r[j],pk[j],cache[j]) */
+static void HashConfirmx4(unsigned char *h[4],const unsigned char *r[4],const unsigned char *cache[4])
+{
+#ifndef LPR
+  static const int b3[4] = {3,3,3,3};
+  unsigned char x[4][Hash_bytes];
+  unsigned char *xout[4] = {x[0],x[1],x[2],x[3]};
+  const unsigned char *xin[4] = {x[0],x[1],x[2],x[3]};
+
+  Hashx4(xout,b3,r,Inputs_bytes,0,0);
+  Hashx4(h,Hashx4_b2,xin,Hash_bytes,cache,Hash_bytes);
+#else
+  Hashx4(h,Hashx4_b2,r,Inputs_bytes,cache,Hash_bytes);
+#endif
+}
+
+/* k[j] = HashSession(b[j],y[j],z[j]) */
+static void HashSessionx4(unsigned char *k[4],const int b[4],const unsigned char *y[4],const unsigned char *z[4])
+{
+#ifndef LPR
+  static const int b3[4] = {3,3,3,3};
+  unsigned char x[4][Hash_bytes];
+  unsigned char *xout[4] = {x[0],x[1],x[2],x[3]};
+  const unsigned char *xin[4] = {x[0],x[1],x[2],x[3]};
+
+  Hashx4(xout,b3,y,Inputs_bytes,0,0);
+  Hashx4(k,b,xin,Hash_bytes,z,KEM_Ciphertexts_bytes);
+#else
+  Hashx4(k,b,y,Inputs_bytes,z,KEM_Ciphertexts_bytes);
+#endif
+}
+
+/* KEM_KeyGen of four instances, stored back to back */
+static void KEM_KeyGenx4(unsigned char *pk,unsigned char *sk,Scratch *ws)
+{
+  const unsigned char *pkj[4];
+  unsigned char *cache[4];
+  unsigned char *skj;
+  int i,j;
+
+  for (j = 0;j < 4;++j) {
+    pkj[j] = pk+j*PublicKeys_bytes;
+    skj = sk+j*KEM_SecretKeys_bytes;
+    ZKeyGen(pk+j*PublicKeys_bytes,skj,ws); skj += SecretKeys_bytes;
+    for (i = 0;i < PublicKeys_bytes;++i) *skj++ = pkj[j][i];
+    randombytes(skj,Inputs_bytes); skj += Inputs_bytes;
+    cache[j] = skj;
+  }
+  Hashx4(cache,Hashx4_b4,pkj,PublicKeys_bytes,0,0);
+}
+
+/* Encap of four instances */
+static void Encapx4(unsigned char *c,unsigned char *k,const unsigned char *pk,Scratch *ws)
+{
+  Inputs r[4];
+  unsigned char r_enc[4][Inputs_bytes];
+  unsigned char cache[4][Hash_bytes];
+  unsigned char *cacheout[4],*confirm[4],*kj[4];
+  const unsigned char *pkj[4],*cachein[4],*r_encj[4],*cj[4];
+  int j;
+
+  for (j = 0;j < 4;++j) {
+    pkj[j] = pk+j*PublicKeys_bytes;
+    cj[j] = c+j*KEM_Ciphertexts_bytes;
+    confirm[j] = c+j*KEM_Ciphertexts_bytes+Ciphertexts_bytes;
+    kj[j] = k+j*Hash_bytes;
+    cacheout[j] = cache[j];
+    cachein[j] = cache[j];
+    r_encj[j] = r_enc[j];
+  }
+
+  Hashx4(cacheout,Hashx4_b4,pkj,PublicKeys_bytes,0,0);
+  for (j = 0;j < 4;++j) {
+    Inputs_random(r[j],ws);
+    Inputs_encode(r_enc[j],r[j]);
+    ZEncrypt(c+j*KEM_Ciphertexts_bytes,r[j],pkj[j],ws);
+  }
+  HashConfirmx4(confirm,r_encj,cachein);
+  HashSessionx4(kj,Hashx4_b1,r_encj,cj);
+}
+
+/* Decap of four instances */
+static void Decapx4(unsigned char *k,const unsigned char *c,const unsigned char *sk,Scratch *ws)
+{
+  Inputs r[4];
+  unsigned char r_enc[4][Inputs_bytes];
+  unsigned char cnew[4][KEM_Ciphertexts_bytes];
+  unsigned char *confirm[4],*kj[4];
+  const unsigned char *skj,*pk,*rho;
+  const unsigned char *cache[4],*r_encj[4],*cj[4];
+  int b[4];
+  int mask;
+  int i,j;
+
+  for (j = 0;j < 4;++j) {
+    skj = sk+j*KEM_SecretKeys_bytes;
+    pk = skj+SecretKeys_bytes;
+    cache[j] = pk+PublicKeys_bytes+Inputs_bytes;
+    cj[j] = c+j*KEM_Ciphertexts_bytes;
+    confirm[j] = cnew[j]+Ciphertexts_bytes;
+    kj[j] = k+j*Hash_bytes;
+    r_encj[j] = r_enc[j];
+
+    ZDecrypt(r[j],cj[j],skj,ws);
+    Inputs_encode(r_enc[j],r[j]);
+    ZEncrypt(cnew[j],r[j],pk,ws);
+  }
+  HashConfirmx4(confirm,r_encj,cache);
+  for (j = 0;j < 4;++j) {
+    rho = sk+j*KEM_SecretKeys_bytes+SecretKeys_bytes+PublicKeys_bytes;
+    mask = Ciphertexts_diff_mask(cj[j],cnew[j]);
+    for (i = 0;i < Inputs_bytes;++i) r_enc[j][i] ^= mask&(r_enc[j][i]^rho[i]);
+    b[j] = 1+mask;
+  }
+  HashSessionx4(kj,b,r_encj,cj);
+}
+
 /* ----- crypto_kem API */
 
 #include "crypto_kem.h"
 
+#ifdef KEM_VARIANT
+typedef char crypto_kem_sizes_check[
+  crypto_kem_PUBLICKEYBYTES == PublicKeys_bytes
+  && crypto_kem_SECRETKEYBYTES == SecretKeys_bytes+PublicKeys_bytes+Inputs_bytes+Hash_bytes
+  && crypto_kem_CIPHERTEXTBYTES == Ciphertexts_bytes+Confirm_bytes ? 1 : -1];
+#endif
+
 int crypto_kem_keypair(unsigned char *pk,unsigned char *sk)
 {
-  KEM_KeyGen(pk,sk);
+  Scratch ws;
+  KEM_KeyGen(pk,sk,&ws);
   return 0;
 }
 
 int crypto_kem_enc(unsigned char *c,unsigned char *k,const unsigned char *pk)
 {
-  Encap(c,k,pk);
+  Scratch ws;
+  Encap(c,k,pk,&ws);
   return 0;
 }
 
 int crypto_kem_dec(unsigned char *k,const unsigned char *c,const unsigned char *sk)
 {
-  Decap(k,c,sk);
+  Scratch ws;
+  Decap(k,c,sk,&ws);
+  return 0;
+}
+
+/* one arena serves the three operations; aligned as by malloc */
+size_t crypto_kem_scratch_bytes(void)
+{
+  return sizeof(Scratch);
+}
+
+int crypto_kem_keypair_with_scratch(unsigned char *pk,unsigned char *sk,void *scratch)
+{
+  KEM_KeyGen(pk,sk,(Scratch *) scratch);
+  return 0;
+}
+
+int crypto_kem_enc_with_scratch(unsigned char *c,unsigned char *k,const unsigned char *pk,void *scratch)
+{
+  Encap(c,k,pk,(Scratch *) scratch);
+  return 0;
+}
+
+int crypto_kem_dec_with_scratch(unsigned char *k,const unsigned char *c,const unsigned char *sk,void *scratch)
+{
+  Decap(k,c,sk,(Scratch *) scratch);
+  return 0;
+}
+
+/*
+n instances back to back, the same as n calls of crypto_kem_* with the
+randomness drawn in the same order; four at a time hash together.
+*/
+
+int crypto_kem_keypair_batch(unsigned char *pk,unsigned char *sk,size_t n)
+{
+  Scratch ws;
+  size_t i = 0;
+
+  for (;i+4 <= n;i += 4) KEM_KeyGenx4(pk+i*PublicKeys_bytes,sk+i*KEM_SecretKeys_bytes,&ws);
+  for (;i < n;++i) KEM_KeyGen(pk+i*PublicKeys_bytes,sk+i*KEM_SecretKeys_bytes,&ws);
+  return 0;
+}
+
+int crypto_kem_enc_batch(unsigned char *c,unsigned char *k,const unsigned char *pk,size_t n)
+{
+  Scratch ws;
+  size_t i = 0;
+
+  for (;i+4 <= n;i += 4) Encapx4(c+i*KEM_Ciphertexts_bytes,k+i*Hash_bytes,pk+i*PublicKeys_bytes,&ws);
+  for (;i < n;++i) Encap(c+i*KEM_Ciphertexts_bytes,k+i*Hash_bytes,pk+i*PublicKeys_bytes,&ws);
+  return 0;
+}
+
+int crypto_kem_dec_batch(unsigned char *k,const unsigned char *c,const unsigned char *sk,size_t n)
+{
+  Scratch ws;
+  size_t i = 0;
+
+  for (;i+4 <= n;i += 4) Decapx4(k+i*Hash_bytes,c+i*KEM_Ciphertexts_bytes,sk+i*KEM_SecretKeys_bytes,&ws);
+  for (;i < n;++i) Decap(k+i*Hash_bytes,c+i*KEM_Ciphertexts_bytes,sk+i*KEM_SecretKeys_bytes,&ws);
   return 0;
 }
@@ -0,0 +1,101 @@
+#include "params.h"
+#include "mult.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/*
+Karatsuba multiplication with lazy reduction.
+Inputs are zero-padded to n = KARA_N coefficients and split
+KARA_LEVELS times; the remaining KARA_N >> KARA_LEVELS products
+(a multiple of 8 coefficients) are computed by schoolbook,
+eight int32 lanes at a time on AVX2.
+Coefficients only grow to |f| < 2^15 and |g| <= 8 after the
+splits, so every intermediate fits easily in an int32.
+*/
+
+#define KARA_LEVELS 3
+#define KARA_N (((p+63)/64)*64)
+#define KARA_BASE (KARA_N>>KARA_LEVELS)
+
+/* scratch needed below a level of size n: 3n int32 */
+#define KARA_SCRATCH (3*KARA_N)
+
+/* r[0...2n-1] = a*b */
+static void schoolbook(int32 *r,const int16 *a,const int16 *b,int n)
+{
+  int i,j;
+
+  for (i = 0;i < 2*n;++i) r[i] = 0;
+#ifdef __AVX2__
+  for (i = 0;i < n;++i) {
+    __m256i ai = _mm256_set1_epi32(a[i]);
+    for (j = 0;j < n;j += 8) {
+      __m256i bj = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) (b+j)));
+      __m256i rij = _mm256_loadu_si256((__m256i *) (r+i+j));
+      rij = _mm256_add_epi32(rij,_mm256_mullo_epi32(ai,bj));
+      _mm256_storeu_si256((__m256i *) (r+i+j),rij);
+    }
+  }
+#else
+  for (i = 0;i < n;++i)
+    for (j = 0;j < n;++j)
+      r[i+j] += a[i]*(int32)b[j];
+#endif
+}
+
+/* r[0...2n-1] = a*b; scratch holds 3n int32 */
+static void karatsuba(int32 *r,const int16 *a,const int16 *b,int n,int32 *scratch)
+{
+  int16 *as = (int16 *) scratch;
+  int16 *bs = as+n/2;
+  int32 *m = scratch+n/2;
+  int h = n/2;
+  int i;
+
+  if (n <= KARA_BASE) {
+    schoolbook(r,a,b,n);
+    return;
+  }
+
+  for (i = 0;i < h;++i) as[i] = a[i]+a[i+h];
+  for (i = 0;i < h;++i) bs[i] = b[i]+b[i+h];
+
+  karatsuba(r,a,b,h,scratch+3*h);
+  karatsuba(r+n,a+h,b+h,h,scratch+3*h);
+  karatsuba(m,as,bs,h,scratch+3*h);
+
+  for (i = 0;i < n;++i) m[i] -= r[i]+r[n+i];
+  for (i = 0;i < n;++i) r[h+i] += m[i];
+}
+
+typedef char mult_small_SCRATCH_check[mult_small_SCRATCH == KARA_N+2*KARA_N+KARA_SCRATCH ? 1 : -1];
+
+void mult_small(int32 *h,const int16 *f,const int8 *g)
+{
+  int32 scratch[mult_small_SCRATCH];
+
+  mult_small_scratch(h,f,g,scratch);
+}
+
+/* scratch: a and b (KARA_N int16 each), r (2*KARA_N), then karatsuba's */
+void mult_small_scratch(int32 *h,const int16 *f,const int8 *g,int32 *scratch)
+{
+  int16 *a = (int16 *) scratch;
+  int16 *b = a+KARA_N;
+  int32 *r = scratch+KARA_N;
+  int i;
+
+  for (i = 0;i < p;++i) a[i] = f[i];
+  for (i = 0;i < p;++i) b[i] = g[i];
+  for (i = p;i < KARA_N;++i) a[i] = b[i] = 0;
+
+  karatsuba(r,a,b,KARA_N,r+2*KARA_N);
+
+  for (i = p+p-2;i >= p;--i) {
+    r[i-p] += r[i];
+    r[i-p+1] += r[i];
+  }
+
+  for (i = 0;i < p;++i) h[i] = r[i];
+}
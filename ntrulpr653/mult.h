@@ -0,0 +1,18 @@
+#ifndef mult_H
+#define mult_H
+
+#include "int8.h"
+#include "int16.h"
+#include "int32.h"
+
+/* h = f*g in Z[x]/(x^p-x-1); coefficients are not reduced mod q */
+/* assumes |f[i]| < 2^12 and g[i] in {-1,0,1} */
+extern void mult_small(int32 *,const int16 *,const int8 *);
+
+/* int32 words of workspace taken by mult_small_scratch; uses p (params.h) */
+#define mult_small_SCRATCH (6*(((p+63)/64)*64))
+
+/* mult_small with every temporary in scratch[0...mult_small_SCRATCH-1] */
+extern void mult_small_scratch(int32 *,const int16 *,const int8 *,int32 *);
+
+#endif
@@ -8,7 +8,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include "rng.h"
+#include "randombytes.h"
 #include "crypto_kem.h"
 
 #define KAT_SUCCESS          0
@@ -1,8 +1,14 @@
 /* pick one of these three: */
+/* (or pass -DSIZE653, -DSIZE761 or -DSIZE857 on the command line) */
+#if !defined(SIZE653) && !defined(SIZE761) && !defined(SIZE857)
 #undef SIZE761
 #define SIZE653
 #undef SIZE857
+#endif
 
 /* pick one of these two: */
+/* (or pass -DSNTRUP or -DLPR on the command line) */
+#if !defined(SNTRUP) && !defined(LPR)
 #undef SNTRUP /* Streamlined NTRU Prime */
 #define LPR /* NTRU LPRime */
+#endif
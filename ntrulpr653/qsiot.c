@@ -0,0 +1,30 @@
+#include "crypto_kem.h"
+#include "qsiot_kem.h"
+
+#ifdef KEM_VARIANT
+#define qsiot_name3(a,b) a##b
+#define qsiot_name(v) qsiot_name3(qsiot_kem_,v)
+#define qsiot_kem_descriptor qsiot_name(KEM_VARIANT)
+#else
+#define qsiot_kem_descriptor qsiot_kem_ntrulpr653
+#endif
+
+/* registry descriptor (../common/qsiot_kem.h) */
+const qsiot_kem qsiot_kem_descriptor = {
+  .name = crypto_kem_PRIMITIVE,
+  .family = crypto_kem_PRIMITIVE,
+  .publickeybytes = crypto_kem_PUBLICKEYBYTES,
+  .secretkeybytes = crypto_kem_SECRETKEYBYTES,
+  .ciphertextbytes = crypto_kem_CIPHERTEXTBYTES,
+  .bytes = crypto_kem_BYTES,
+  .keypair = crypto_kem_keypair,
+  .enc = crypto_kem_enc,
+  .dec = crypto_kem_dec,
+  .keypair_batch = crypto_kem_keypair_batch,
+  .enc_batch = crypto_kem_enc_batch,
+  .dec_batch = crypto_kem_dec_batch,
+  .scratch_bytes = crypto_kem_scratch_bytes,
+  .keypair_with_scratch = crypto_kem_keypair_with_scratch,
+  .enc_with_scratch = crypto_kem_enc_with_scratch,
+  .dec_with_scratch = crypto_kem_dec_with_scratch,
+};
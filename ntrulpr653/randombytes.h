@@ -1 +0,0 @@
-#include "nist/rng.h"
@@ -0,0 +1,341 @@
+#include "params.h"
+#include "uint16.h"
+#include "uint64.h"
+#include "reduce.h"
+#include "recip.h"
+
+#ifndef LPR
+
+/*
+Constant-time inversion by divsteps (Bernstein--Yang, "Fast
+constant-time gcd computation and modular inversion"), taking the
+same 2p-1 steps and the same decisions as the reference code.
+
+Two bounds that depend only on the step number n limit the work:
+only the bottom 2p-n coefficients of f and g can still affect a
+later decision or the final f[0], and v and r have no coefficient
+above x^(n+1). Each step touches only those, a quarter less than
+the full 2(p+1) on average.
+
+R3 works on bitsliced polynomials, 64 coefficients per word. Rq
+works on sixteen int16 lanes; the swap, the shift and the update of
+each step are one pass over f,g and one over v,r, and f[0]*g-g[0]*f
+takes one shared quotient estimate instead of a full reduction.
+*/
+
+#define q12 ((q-1)/2)
+
+/* return -1 if x!=0; else return 0 */
+static int int16_nonzero_mask(int16 x)
+{
+  uint16 u = x;
+  uint32 v = u;
+  v = -v;
+  v >>= 31;
+  return -v;
+}
+
+/* return -1 if x<0; otherwise return 0 */
+static int int16_negative_mask(int16 x)
+{
+  uint16 u = x;
+  u >>= 15;
+  return -(int) u;
+}
+
+/* coefficients of f,g (fg_len) and v,r (vr_len) used by step n */
+static inline int fg_len(int n) { return 2*p-n < p+1 ? 2*p-n : p+1; }
+static inline int vr_len(int n) { return n+2 < p+1 ? n+2 : p+1; }
+
+/* ----- R3 */
+
+/*
+Coefficient i of a bitsliced polynomial is bit i of nz (nonzero)
+and of sg (equal to -1); sg is always a subset of nz.
+*/
+
+#define WORDS3 ((p+64)/64)
+
+/* a[i] = a[i-1] on len words */
+static inline void bits_mulx(uint64 *a,int len)
+{
+  int i;
+
+  for (i = len-1;i > 0;--i) a[i] = (a[i]<<1)|(a[i-1]>>63);
+  a[0] <<= 1;
+}
+
+/* a[i] = a[i+1] on len words; reads a[len] */
+static inline void bits_divx(uint64 *a,int len)
+{
+  int i;
+
+  for (i = 0;i < len;++i) a[i] = (a[i]>>1)|(a[i+1]<<63);
+}
+
+static inline void bits_cswap(uint64 *a,uint64 *b,uint64 mask,int len)
+{
+  int i;
+  uint64 t;
+
+  for (i = 0;i < len;++i) {
+    t = mask&(a[i]^b[i]); a[i] ^= t; b[i] ^= t;
+  }
+}
+
+/* r += c*a where the scalar c is given as the masks cnz, csg */
+static inline void bits_fmadd(uint64 *rnz,uint64 *rsg,const uint64 *anz,const uint64 *asg,uint64 cnz,uint64 csg,int len)
+{
+  int i;
+  uint64 bnz,bsg,s,both;
+
+  for (i = 0;i < len;++i) {
+    bnz = anz[i]&cnz;
+    bsg = (asg[i]^csg)&bnz;
+    s = rsg[i]^bsg;
+    both = rnz[i]&bnz;
+    bnz = (rnz[i]^bnz)|(both&~s);
+    rsg[i] = (s|(both&~rsg[i]))&bnz;
+    rnz[i] = bnz;
+  }
+}
+
+static inline void bits_set(uint64 *nz,uint64 *sg,int i,int8 c)
+{
+  nz[i>>6] |= (uint64) (c&1)<<(i&63);
+  sg[i>>6] |= (uint64) ((c>>1)&1)<<(i&63);
+}
+
+int R3_recip(int8 *out,const int8 *in)
+{
+  uint64 fnz[WORDS3+1],fsg[WORDS3+1],gnz[WORDS3+1],gsg[WORDS3+1];
+  uint64 vnz[WORDS3],vsg[WORDS3],rnz[WORDS3],rsg[WORDS3];
+  uint64 mask,cnz,csg,f0sg,g0sg;
+  int i,n,delta,swap,lfg,lvr;
+
+  for (i = 0;i < WORDS3+1;++i) fnz[i] = fsg[i] = gnz[i] = gsg[i] = 0;
+  for (i = 0;i < WORDS3;++i) vnz[i] = vsg[i] = rnz[i] = rsg[i] = 0;
+  rnz[0] = 1;
+  bits_set(fnz,fsg,0,1);
+  bits_set(fnz,fsg,p-1,-1);
+  bits_set(fnz,fsg,p,-1);
+  for (i = 0;i < p;++i) bits_set(gnz,gsg,p-1-i,in[i]);
+
+  delta = 1;
+
+  for (n = 0;n < 2*p-1;++n) {
+    lfg = (fg_len(n)+63)/64;
+    lvr = (vr_len(n)+63)/64;
+
+    bits_mulx(vnz,lvr);
+    bits_mulx(vsg,lvr);
+
+    swap = int16_negative_mask(-delta)&-(int) (gnz[0]&1);
+    delta ^= swap&(delta^-delta);
+    delta += 1;
+
+    mask = (int64_t) swap;
+    bits_cswap(fnz,gnz,mask,lfg);
+    bits_cswap(fsg,gsg,mask,lfg);
+    bits_cswap(vnz,rnz,mask,lvr);
+    bits_cswap(vsg,rsg,mask,lvr);
+
+    /* c = -g[0]*f[0]; f[0] is never 0 */
+    f0sg = fsg[0]&1;
+    g0sg = gsg[0]&1;
+    cnz = -(gnz[0]&1);
+    csg = cnz&-(1^f0sg^g0sg);
+    bits_fmadd(gnz,gsg,fnz,fsg,cnz,csg,lfg);
+    bits_fmadd(rnz,rsg,vnz,vsg,cnz,csg,lvr);
+
+    bits_divx(gnz,lfg);
+    bits_divx(gsg,lfg);
+  }
+
+  f0sg = fsg[0]&1;
+  for (i = 0;i < p;++i) {
+    int j = p-1-i;
+    int nz = (vnz[j>>6]>>(j&63))&1;
+    int sg = nz&(((vsg[j>>6]>>(j&63))&1)^f0sg);
+    out[i] = nz-2*sg;
+  }
+
+  return int16_nonzero_mask(delta);
+}
+
+/* ----- Rq */
+
+/* x must not be close to top int32 */
+static int16 Fq_freeze(int32 x)
+{
+  return int32_mod_const(x+q12,q)-q12;
+}
+
+static int16 Fq_recip(int16 a1)
+{
+  int i = 1;
+  int16 ai = a1;
+
+  while (i < q-2) {
+    ai = Fq_freeze(a1*(int32)ai);
+    i += 1;
+  }
+  return ai;
+}
+
+#ifdef __AVX2__
+
+/* round(b*2^15/q), for the multiply-high in Fq_mulsub_x16 */
+static int16 Fq_mulconst(int16 b)
+{
+  uint32 quot,rem;
+
+  uint32_divmod_const(&quot,&rem,(uint32) (b+q)*32768+q/2,q);
+  return quot-32768;
+}
+
+/*
+Fq_freeze(y*f0-x*g0) with f0q = Fq_mulconst(f0), g0q = Fq_mulconst(g0),
+for x, y, f0, g0 in -q12...q12. The quotient estimate is off by at
+most 1.08, so two conditional corrections finish the reduction.
+*/
+static inline __m256i Fq_mulsub_x16(__m256i y,__m256i x,__m256i f0,__m256i f0q,__m256i g0,__m256i g0q)
+{
+  const __m256i qv = _mm256_set1_epi16(q);
+  const __m256i h = _mm256_set1_epi16(q12);
+  __m256i t,r;
+
+  t = _mm256_sub_epi16(_mm256_mulhrs_epi16(y,f0q),_mm256_mulhrs_epi16(x,g0q));
+  r = _mm256_sub_epi16(_mm256_mullo_epi16(y,f0),_mm256_mullo_epi16(x,g0));
+  r = _mm256_sub_epi16(r,_mm256_mullo_epi16(t,qv));
+  r = _mm256_sub_epi16(r,_mm256_and_si256(_mm256_cmpgt_epi16(r,h),qv));
+  r = _mm256_add_epi16(r,_mm256_and_si256(_mm256_cmpgt_epi16(_mm256_sub_epi16(_mm256_setzero_si256(),h),r),qv));
+  return r;
+}
+
+#endif
+
+/* one divstep on f and g: swap, then g = (f0*g-g0*f)/x; len coefficients */
+static inline void Fq_divstep_fg(int16 *f,int16 *g,int swap,int16 f0,int16 g0,int len)
+{
+  int i = 0;
+  int16 a,b,c,d,t;
+
+#ifdef __AVX2__
+  const __m256i m = _mm256_set1_epi16(swap);
+  const __m256i f0x = _mm256_set1_epi16(f0);
+  const __m256i f0q = _mm256_set1_epi16(Fq_mulconst(f0));
+  const __m256i g0x = _mm256_set1_epi16(g0);
+  const __m256i g0q = _mm256_set1_epi16(Fq_mulconst(g0));
+  for (;i+16 <= len;i += 16) {
+    __m256i x = _mm256_loadu_si256((const __m256i *) (f+i));
+    __m256i y = _mm256_loadu_si256((const __m256i *) (g+i));
+    __m256i x1 = _mm256_loadu_si256((const __m256i *) (f+i+1));
+    __m256i y1 = _mm256_loadu_si256((const __m256i *) (g+i+1));
+    __m256i e = _mm256_and_si256(m,_mm256_xor_si256(x,y));
+    __m256i e1 = _mm256_and_si256(m,_mm256_xor_si256(x1,y1));
+    x = _mm256_xor_si256(x,e);
+    x1 = _mm256_xor_si256(x1,e1);
+    y1 = _mm256_xor_si256(y1,e1);
+    _mm256_storeu_si256((__m256i *) (f+i),x);
+    _mm256_storeu_si256((__m256i *) (g+i),Fq_mulsub_x16(y1,x1,f0x,f0q,g0x,g0q));
+  }
+#endif
+  for (;i < len;++i) {
+    a = f[i]; b = g[i]; c = f[i+1]; d = g[i+1];
+    t = swap&(a^b); a ^= t;
+    t = swap&(c^d); c ^= t; d ^= t;
+    f[i] = a;
+    g[i] = Fq_freeze(f0*(int32)d-g0*(int32)c);
+  }
+}
+
+/* one divstep on v and r: v = x*v, swap, then r = f0*r-g0*v; v[-1] must be 0 */
+static inline void Fq_divstep_vr(int16 *v,int16 *r,int swap,int16 f0,int16 g0,int len)
+{
+  int i;
+  int16 a,b,t;
+
+  /* descending, so v[i-1] is read before it is written */
+  for (i = len-1;i >= (len&~15);--i) {
+    a = v[i-1]; b = r[i];
+    t = swap&(a^b); a ^= t; b ^= t;
+    v[i] = a;
+    r[i] = Fq_freeze(f0*(int32)b-g0*(int32)a);
+  }
+#ifdef __AVX2__
+  {
+    const __m256i m = _mm256_set1_epi16(swap);
+    const __m256i f0x = _mm256_set1_epi16(f0);
+    const __m256i f0q = _mm256_set1_epi16(Fq_mulconst(f0));
+    const __m256i g0x = _mm256_set1_epi16(g0);
+    const __m256i g0q = _mm256_set1_epi16(Fq_mulconst(g0));
+    for (i = (len&~15)-16;i >= 0;i -= 16) {
+      __m256i x = _mm256_loadu_si256((const __m256i *) (v+i-1));
+      __m256i y = _mm256_loadu_si256((const __m256i *) (r+i));
+      __m256i e = _mm256_and_si256(m,_mm256_xor_si256(x,y));
+      x = _mm256_xor_si256(x,e);
+      y = _mm256_xor_si256(y,e);
+      _mm256_storeu_si256((__m256i *) (v+i),x);
+      _mm256_storeu_si256((__m256i *) (r+i),Fq_mulsub_x16(y,x,f0x,f0q,g0x,g0q));
+    }
+  }
+#else
+  for (;i >= 0;--i) {
+    a = v[i-1]; b = r[i];
+    t = swap&(a^b); a ^= t; b ^= t;
+    v[i] = a;
+    r[i] = Fq_freeze(f0*(int32)b-g0*(int32)a);
+  }
+#endif
+}
+
+int Rq_recip3(int16 *out,const int8 *in)
+{
+  int32 scratch[Rq_recip3_SCRATCH];
+
+  return Rq_recip3_scratch(out,in,scratch);
+}
+
+/* scratch: t32 (p int32), then f,g,vbuf (p+2 int16 each) and r (p+1) */
+int Rq_recip3_scratch(int16 *out,const int8 *in,int32 *scratch)
+{
+  int32 *t32 = scratch;
+  int16 *f = (int16 *) (scratch+p);
+  int16 *g = f+p+2;
+  int16 *vbuf = g+p+2;
+  int16 *r = vbuf+p+2;
+  int16 *v = vbuf+1;
+  int i,n,delta,swap,lfg,lvr;
+  int16 f0,g0,scale;
+
+  for (i = 0;i < p+2;++i) f[i] = g[i] = vbuf[i] = 0;
+  for (i = 0;i < p+1;++i) r[i] = 0;
+  r[0] = Fq_recip(3);
+  f[0] = 1; f[p-1] = f[p] = -1;
+  for (i = 0;i < p;++i) g[p-1-i] = in[i];
+
+  delta = 1;
+
+  for (n = 0;n < 2*p-1;++n) {
+    lfg = fg_len(n);
+    lvr = vr_len(n);
+
+    swap = int16_negative_mask(-delta)&int16_nonzero_mask(g[0]);
+    delta ^= swap&(delta^-delta);
+    delta += 1;
+
+    f0 = f[0]^(swap&(f[0]^g[0]));
+    g0 = g[0]^(swap&(f[0]^g[0]));
+    Fq_divstep_fg(f,g,swap,f0,g0,lfg);
+    Fq_divstep_vr(v,r,swap,f0,g0,lvr);
+  }
+
+  scale = Fq_recip(f[0]);
+  for (i = 0;i < p;++i) t32[i] = scale*(int32)v[p-1-i];
+  Fq_freeze_int32_list(out,t32,p);
+
+  return int16_nonzero_mask(delta);
+}
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef recip_H
+#define recip_H
+
+#include "int8.h"
+#include "int16.h"
+#include "int32.h"
+
+/* inversions for Streamlined NTRU Prime key generation (recip.c) */
+
+/* out = 1/in in R3 = F3[x]/(x^p-x-1) */
+/* returns 0 if recip succeeded; else -1 */
+extern int R3_recip(int8 *out,const int8 *in);
+
+/* out = 1/(3*in) in Rq = Fq[x]/(x^p-x-1) */
+/* returns 0 if recip succeeded; else -1 */
+extern int Rq_recip3(int16 *out,const int8 *in);
+
+/* int32 words of workspace taken by Rq_recip3_scratch; uses p (params.h) */
+#define Rq_recip3_SCRATCH (3*p+4)
+
+/* Rq_recip3 with its temporaries in scratch[0...Rq_recip3_SCRATCH-1] */
+extern int Rq_recip3_scratch(int16 *out,const int8 *in,int32 *scratch);
+
+#endif
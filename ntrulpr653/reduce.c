@@ -0,0 +1,85 @@
+#include "reduce.h"
+
+/* Array reductions mod q and mod 3; AVX2 blocks of 8 or 16 with a scalar tail */
+
+#define q12 ((q-1)/2)
+
+void Fq_freeze_int32_list(int16 *out,const int32 *in,int len)
+{
+  int i = 0;
+
+#ifdef __AVX2__
+  for (;i+8 <= len;i += 8) {
+    __m256i x = _mm256_loadu_si256((const __m256i *) (in+i));
+    x = int32_mod_const_x8(_mm256_add_epi32(x,_mm256_set1_epi32(q12)),q);
+    x = _mm256_sub_epi32(x,_mm256_set1_epi32(q12));
+    x = _mm256_packs_epi32(x,x);
+    x = _mm256_permute4x64_epi64(x,0x08);
+    _mm_storeu_si128((__m128i *) (out+i),_mm256_castsi256_si128(x));
+  }
+#endif
+  for (;i < len;++i)
+    out[i] = int32_mod_const(in[i]+q12,q)-q12;
+}
+
+void Fq_freeze_int16_list(int16 *out,const int16 *in,int len)
+{
+  int i = 0;
+
+#ifdef __AVX2__
+  for (;i+16 <= len;i += 16) {
+    __m256i x = _mm256_loadu_si256((const __m256i *) (in+i));
+    _mm256_storeu_si256((__m256i *) (out+i),Fq_freeze_x16(x));
+  }
+#endif
+  for (;i < len;++i)
+    out[i] = int32_mod_const(in[i]+q12,q)-q12;
+}
+
+void Fq_fromuint32_list(int16 *out,const uint32 *in,int len)
+{
+  int i = 0;
+
+#ifdef __AVX2__
+  for (;i+8 <= len;i += 8) {
+    __m256i x = _mm256_loadu_si256((const __m256i *) (in+i));
+    x = _mm256_sub_epi32(uint32_mod_const_x8(x,q),_mm256_set1_epi32(q12));
+    x = _mm256_packs_epi32(x,x);
+    x = _mm256_permute4x64_epi64(x,0x08);
+    _mm_storeu_si128((__m128i *) (out+i),_mm256_castsi256_si128(x));
+  }
+#endif
+  for (;i < len;++i)
+    out[i] = uint32_mod_const(in[i],q)-q12;
+}
+
+void F3_freeze_int16_list(int8 *out,const int16 *in,int len)
+{
+  int i = 0;
+
+#ifdef __AVX2__
+  for (;i+16 <= len;i += 16) {
+    __m256i x = F3_freeze_x16(_mm256_loadu_si256((const __m256i *) (in+i)));
+    x = _mm256_packs_epi16(x,x);
+    x = _mm256_permute4x64_epi64(x,0x08);
+    _mm_storeu_si128((__m128i *) (out+i),_mm256_castsi256_si128(x));
+  }
+#endif
+  for (;i < len;++i)
+    out[i] = int32_mod_const(in[i]+1,3)-1;
+}
+
+void Fq_round3_list(int16 *out,const int16 *in,int len)
+{
+  int i = 0;
+
+#ifdef __AVX2__
+  for (;i+16 <= len;i += 16) {
+    __m256i x = _mm256_loadu_si256((const __m256i *) (in+i));
+    x = _mm256_sub_epi16(x,F3_freeze_x16(x));
+    _mm256_storeu_si256((__m256i *) (out+i),x);
+  }
+#endif
+  for (;i < len;++i)
+    out[i] = in[i]-(int32_mod_const(in[i]+1,3)-1);
+}
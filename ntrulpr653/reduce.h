@@ -0,0 +1,143 @@
+#ifndef reduce_H
+#define reduce_H
+
+#include "params.h"
+#include "int8.h"
+#include "int16.h"
+#include "int32.h"
+#include "uint32.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/*
+Reduction by a divisor 0 < m < 16384 known at compile time.
+The 32-bit routines use the method of uint32_divmod_uint14 with the
+reciprocal 0x80000000/m folded to a constant. They are exact for
+every uint32 (and int32) input. Everything here must be inlined with
+a constant m.
+*/
+
+#define reduce_inline static inline __attribute__((always_inline))
+
+/* *quot = x/m, *rem = x%m */
+reduce_inline void uint32_divmod_const(uint32 *quot,uint32 *rem,uint32 x,uint32 m)
+{
+  const uint32 v = 0x80000000/m;
+  uint32 qpart,mask;
+
+  qpart = (x*(uint64_t)v)>>31;
+  x -= qpart*m; *quot = qpart;
+  qpart = (x*(uint64_t)v)>>31;
+  x -= qpart*m; *quot += qpart;
+  x -= m; *quot += 1;
+  mask = -(x>>31);
+  x += mask&m; *quot += mask;
+  *rem = x;
+}
+
+reduce_inline uint32 uint32_mod_const(uint32 x,uint32 m)
+{
+  uint32 quot,rem;
+  uint32_divmod_const(&quot,&rem,x,m);
+  return rem;
+}
+
+/* x mod m in 0...m-1, as int32_mod_uint14 */
+reduce_inline uint32 int32_mod_const(int32 x,uint32 m)
+{
+  uint32 r = uint32_mod_const(0x80000000+(uint32)x,m)-0x80000000%m;
+  return r+(m&-(r>>31));
+}
+
+#ifdef __AVX2__
+
+/* (x*v)>>31 in each unsigned 32-bit lane, for v <= 2^31 */
+reduce_inline __m256i uint32_mulhi31_x8(__m256i x,__m256i v)
+{
+  __m256i e = _mm256_srli_epi64(_mm256_mul_epu32(x,v),31);
+  __m256i o = _mm256_slli_epi64(_mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(x,32),v),31),32);
+  return _mm256_blend_epi32(e,o,0xaa);
+}
+
+/* uint32_divmod_const on eight lanes; returns x%m, sets *quot = x/m */
+reduce_inline __m256i uint32_divmod_const_x8(__m256i *quot,__m256i x,uint32 m)
+{
+  const __m256i v = _mm256_set1_epi32(0x80000000/m);
+  const __m256i mv = _mm256_set1_epi32(m);
+  __m256i qpart,mask;
+
+  qpart = uint32_mulhi31_x8(x,v);
+  x = _mm256_sub_epi32(x,_mm256_mullo_epi32(qpart,mv)); *quot = qpart;
+  qpart = uint32_mulhi31_x8(x,v);
+  x = _mm256_sub_epi32(x,_mm256_mullo_epi32(qpart,mv)); *quot = _mm256_add_epi32(*quot,qpart);
+  x = _mm256_sub_epi32(x,mv);
+  mask = _mm256_srai_epi32(x,31);
+  x = _mm256_add_epi32(x,_mm256_and_si256(mask,mv));
+  *quot = _mm256_add_epi32(*quot,_mm256_add_epi32(mask,_mm256_set1_epi32(1)));
+  return x;
+}
+
+reduce_inline __m256i uint32_mod_const_x8(__m256i x,uint32 m)
+{
+  __m256i quot;
+  return uint32_divmod_const_x8(&quot,x,m);
+}
+
+/* int32_mod_const on eight lanes */
+reduce_inline __m256i int32_mod_const_x8(__m256i x,uint32 m)
+{
+  const __m256i mv = _mm256_set1_epi32(m);
+  __m256i r;
+
+  r = uint32_mod_const_x8(_mm256_add_epi32(x,_mm256_set1_epi32(0x80000000)),m);
+  r = _mm256_sub_epi32(r,_mm256_set1_epi32(0x80000000%m));
+  return _mm256_add_epi32(r,_mm256_and_si256(_mm256_srai_epi32(r,31),mv));
+}
+
+/*
+Centered reduction of sixteen int16 lanes (any int16 input) by
+Barrett: t = round(x*2^s/m) from one multiply-high, r = x-t*m, then
+one conditional correction towards -(m-1)/2...(m-1)/2. The constants
+were checked exhaustively over all int16 for q = 4591, 4621, 5167
+(s = 11) and for m = 3 (s = 0).
+*/
+reduce_inline __m256i int16_freeze_x16(__m256i x,int16 m,int s)
+{
+  const __m256i v = _mm256_set1_epi16(((1<<(16+s))+m/2)/m);
+  const __m256i mv = _mm256_set1_epi16(m);
+  const __m256i h = _mm256_set1_epi16((m-1)/2);
+  __m256i t;
+
+  t = _mm256_mulhi_epi16(x,v);
+  if (s > 0)
+    t = _mm256_srai_epi16(_mm256_add_epi16(t,_mm256_set1_epi16(1<<(s-1))),s);
+  x = _mm256_sub_epi16(x,_mm256_mullo_epi16(t,mv));
+  x = _mm256_sub_epi16(x,_mm256_and_si256(_mm256_cmpgt_epi16(x,h),mv));
+  x = _mm256_add_epi16(x,_mm256_and_si256(_mm256_cmpgt_epi16(_mm256_sub_epi16(_mm256_setzero_si256(),h),x),mv));
+  return x;
+}
+
+#if q < 4096 || q >= 8192
+#error "Fq_freeze_x16 assumes 4096 <= q < 8192"
+#endif
+
+#define Fq_freeze_x16(x) int16_freeze_x16(x,q,11)
+#define F3_freeze_x16(x) int16_freeze_x16(x,3,0)
+
+#endif
+
+/* array kernels, q fixed at compile time (reduce.c) */
+
+/* out[i] = Fq_freeze(in[i]) */
+extern void Fq_freeze_int32_list(int16 *out,const int32 *in,int len);
+/* out[i] = Fq_freeze(in[i]); out may alias in */
+extern void Fq_freeze_int16_list(int16 *out,const int16 *in,int len);
+/* out[i] = (in[i] mod q)-(q-1)/2 */
+extern void Fq_fromuint32_list(int16 *out,const uint32 *in,int len);
+/* out[i] = F3_freeze(in[i]) */
+extern void F3_freeze_int16_list(int8 *out,const int16 *in,int len);
+/* out[i] = in[i]-F3_freeze(in[i]) */
+extern void Fq_round3_list(int16 *out,const int16 *in,int len);
+
+#endif
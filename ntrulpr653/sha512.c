@@ -1,9 +1,27 @@
 #include <stddef.h>
+#define OPENSSL_SUPPRESS_DEPRECATED
 #include <openssl/sha.h>
 #include "sha512.h"
 
+typedef char sha512_incctx_fits[sizeof(sha512_incctx) >= sizeof(SHA512_CTX) ? 1 : -1];
+
 int sha512(unsigned char *out,const unsigned char *in,unsigned long long inlen)
 {
   SHA512(in,inlen,out);
   return 0;
 }
+
+void sha512_inc_init(sha512_incctx *ctx)
+{
+  SHA512_Init((SHA512_CTX *) ctx);
+}
+
+void sha512_inc_absorb(sha512_incctx *ctx,const unsigned char *in,unsigned long long inlen)
+{
+  SHA512_Update((SHA512_CTX *) ctx,in,inlen);
+}
+
+void sha512_inc_finalize(unsigned char *out,sha512_incctx *ctx)
+{
+  SHA512_Final(out,(SHA512_CTX *) ctx);
+}
@@ -3,4 +3,13 @@
 
 extern int sha512(unsigned char *,const unsigned char *,unsigned long long);
 
+/* incremental: init, absorb pieces in order, finalize to the 64-byte digest */
+/* storage for OpenSSL's SHA512_CTX; kept opaque so <openssl/sha.h> never */
+/* meets the single-letter parameter macros of params.h */
+typedef struct { unsigned long long opaque[32]; } sha512_incctx;
+
+extern void sha512_inc_init(sha512_incctx *);
+extern void sha512_inc_absorb(sha512_incctx *,const unsigned char *,unsigned long long);
+extern void sha512_inc_finalize(unsigned char *,sha512_incctx *);
+
 #endif
@@ -16,6 +16,4 @@ extern uint32 uint32_div_uint14(uint32,uint16);
 extern uint16 uint32_mod_uint14(uint32,uint16);
 extern void uint32_divmod_uint14(uint32 *,uint16 *,uint32,uint16);
 
-extern void uint32_sort(uint32 *,int);
-
 #endif
@@ -1,6 +1,7 @@
 #include "performance.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/types.h>
 
 #ifdef RPI
@@ -26,11 +27,89 @@ FUNC rdtsc()
 #endif
 }
 
+#ifdef RNGCOST
+/*
+*   RNG cost isolation. The program is linked with -Wl,--wrap=randombytes, so every
+*   randombytes() call made by the scheme lands in __wrap_randombytes, which adds the cycles
+*   it takes to a counter read after each operation. With RNGSTREAM the scheme's generator
+*   is not called at all: the bytes come from a stream filled once before the first
+*   operation, so the remaining cost is a copy.
+*/
+static double rngCycles = 0;
+
+#ifdef RNGSTREAM
+#define RNG_STREAM_BYTES (1 << 20)
+static unsigned char rngStream[RNG_STREAM_BYTES];
+static size_t rngStreamPos = RNG_STREAM_BYTES + 1;
+
+static void fillRandomnessStream()
+{
+    uint64_t s = 0x9e3779b97f4a7c15ULL;
+    size_t i;
+
+    for (i = 0; i < RNG_STREAM_BYTES; i++)
+    {
+        s ^= s << 13;
+        s ^= s >> 7;
+        s ^= s << 17;
+        rngStream[i] = (unsigned char)(s >> 24);
+    }
+    rngStreamPos = 0;
+}
+#else
+int __real_randombytes(unsigned char *x, unsigned long long xlen);
+#endif
+
+int __wrap_randombytes(unsigned char *x, unsigned long long xlen)
+{
+    double low, high;
+
+#ifdef RNGSTREAM
+    size_t n;
+
+    if (rngStreamPos > RNG_STREAM_BYTES)
+        fillRandomnessStream();
+    low = (double) rdtsc();
+    while (xlen > 0)
+    {
+        if (rngStreamPos == RNG_STREAM_BYTES)
+            rngStreamPos = 0;
+        n = RNG_STREAM_BYTES - rngStreamPos;
+        if (n > xlen)
+            n = xlen;
+        memcpy(x, rngStream + rngStreamPos, n);
+        rngStreamPos += n;
+        x += n;
+        xlen -= n;
+    }
+#else
+    low = (double) rdtsc();
+    __real_randombytes(x, xlen);
+#endif
+    high = (double) rdtsc();
+    rngCycles += high - low;
+    return 0;
+}
+
+/*
+*   Cycles spent in randombytes() since the previous call.
+*/
+double takeRandomnessCycles()
+{
+    double c = rngCycles;
+    rngCycles = 0;
+    return c;
+}
+#endif
+
 void testKeyGen(int (*keygen)(unsigned char *, unsigned char*), unsigned char *pk, unsigned char *sk, struct values *keygenA)
 {
 #ifdef TIME
     double low, high;
     struct timeval start, end;
+#ifdef RNGCOST
+    takeRandomnessCycles();
+#endif
     gettimeofday(&start, NULL);
     low = (double) rdtsc();
 #endif
@@ -38,6 +117,9 @@ void testKeyGen(int (*keygen)(unsigned char *, unsigned char*), unsigned char *p
 #ifdef TIME
     high = (double) rdtsc();
     gettimeofday(&end, NULL);
+#ifdef RNGCOST
+    keygenA -> rng_cycles = takeRandomnessCycles();
+#endif
     keygenA -> cycles = high - low;
     keygenA -> time = (double) (end.tv_sec * 1000000 + end.tv_usec) - (start.tv_sec * 1000000 + start.tv_usec);
 #endif
@@ -48,6 +130,9 @@ void testEnc(int (*enc)(unsigned char*, unsigned char*, const unsigned char*), u
 #ifdef TIME
     double low, high;
     struct timeval start, end;
+#ifdef RNGCOST
+    takeRandomnessCycles();
+#endif
     gettimeofday(&start, NULL);
     low = (double) rdtsc();
 #endif
@@ -55,6 +140,9 @@ void testEnc(int (*enc)(unsigned char*, unsigned char*, const unsigned char*), u
 #ifdef TIME
     high = (double) rdtsc();
     gettimeofday(&end, NULL);
+#ifdef RNGCOST
+    encA -> rng_cycles = takeRandomnessCycles();
+#endif
     encA -> cycles = high - low;
     encA -> time = (double) (end.tv_sec * 1000000 + end.tv_usec) - (start.tv_sec * 1000000 + start.tv_usec);
 #endif
@@ -65,6 +153,9 @@ void testDec(int (*dec)(unsigned char*, const unsigned char *, const unsigned ch
 #ifdef TIME
     double low, high;
     struct timeval start, end;
+#ifdef RNGCOST
+    takeRandomnessCycles();
+#endif
     gettimeofday(&start, NULL);
     low = (double) rdtsc();
 #endif
@@ -72,6 +163,9 @@ void testDec(int (*dec)(unsigned char*, const unsigned char *, const unsigned ch
 #ifdef TIME
     high = (double) rdtsc();
     gettimeofday(&end, NULL);
+#ifdef RNGCOST
+    decA -> rng_cycles = takeRandomnessCycles();
+#endif
     decA -> cycles = high - low;
     decA -> time = (double) (end.tv_sec * 1000000 + end.tv_usec) - (start.tv_sec * 1000000 + start.tv_usec);
 #endif
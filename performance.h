@@ -22,10 +22,14 @@
 
 struct values {
     double time, cycles;
+    double rng_cycles;      // part of cycles spent in randombytes() (RNGCOST=1 only)
 };
 
 FUNC rdtsc();
 void testKeyGen(int (*keygen)(unsigned char *, unsigned char*), unsigned char *pk, unsigned char *sk, struct values *keygenA);
 void testEnc(int (*enc)(unsigned char*, unsigned char*, const unsigned char*), unsigned char *ct, unsigned char *ss, unsigned char *pk, struct values *encA);
 void testDec(int (*dec)(unsigned char*, const unsigned char *, const unsigned char*), unsigned char *ss, unsigned char *ct, unsigned char *sk, struct values *decA);
+#ifdef RNGCOST
+double takeRandomnessCycles();
+#endif
 #endif //PERFORMANCE_H
\ No newline at end of file